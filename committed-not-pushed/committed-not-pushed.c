@@ -5,7 +5,9 @@
 #include <regex.h>
 #include <time.h>
 #include "../json-utils/json-utils.h"
+#include "committed-not-pushed.h"
 
+#ifndef COMMITTED_NOT_PUSHED_LIBRARY_ONLY
 // View mode enumeration
 typedef enum {
     VIEW_FLAT,
@@ -120,26 +122,6 @@ const char* get_display_repo_name(const char* repo_name, const char* repo_path)
     return repo_name;
 }
 
-// Structure for committed-not-pushed information
-typedef struct {
-    char* repo_path;
-    char* repo_name;
-    char** unpushed_commits;
-    size_t commit_count;
-    size_t commit_capacity;
-    char*** commit_files;  // Array of file arrays for each commit
-    size_t* commit_file_counts;  // Number of files for each commit
-} unpushed_repo_t;
-
-// Collection of repositories with unpushed commits
-typedef struct {
-    unpushed_repo_t* repos;
-    size_t count;
-    size_t capacity;
-    char** submodule_paths;  // List of submodule paths to filter out
-    size_t submodule_count;
-} unpushed_collection_t;
-
 // Display results in flat format (current behavior)
 void display_flat_view(unpushed_collection_t* collection, committed_not_pushed_config_t* config) {
     size_t total_unpushed_repos = 0;
@@ -287,9 +269,10 @@ void display_tree_view(unpushed_collection_t* collection, committed_not_pushed_c
         }
     }
 }
+#endif // COMMITTED_NOT_PUSHED_LIBRARY_ONLY
 
 // Initialize unpushed collection
-unpushed_collection_t* unpushed_collection_init() {
+unpushed_collection_t* unpushed_collection_init(void) {
     unpushed_collection_t* collection = calloc(1, sizeof(unpushed_collection_t));
     if (!collection) return NULL;
 
@@ -306,8 +289,9 @@ unpushed_collection_t* unpushed_collection_init() {
     return collection;
 }
 
+#ifndef COMMITTED_NOT_PUSHED_LIBRARY_ONLY
 // Check if a path is a submodule
-int is_submodule_path(unpushed_collection_t* collection, const char* path) {
+static int is_submodule_path(unpushed_collection_t* collection, const char* path) {
     for (size_t i = 0; i < collection->submodule_count; i++) {
         if (strcmp(collection->submodule_paths[i], path) == 0) {
             return 1;
@@ -317,15 +301,16 @@ int is_submodule_path(unpushed_collection_t* collection, const char* path) {
 }
 
 // Add submodule path to filter list
-void add_submodule_path(unpushed_collection_t* collection, const char* path) {
+static void add_submodule_path(unpushed_collection_t* collection, const char* path) {
     collection->submodule_paths = realloc(collection->submodule_paths,
                                          (collection->submodule_count + 1) * sizeof(char*));
     collection->submodule_paths[collection->submodule_count] = strdup(path);
     collection->submodule_count++;
 }
+#endif // COMMITTED_NOT_PUSHED_LIBRARY_ONLY
 
 // Add repository to collection
-void add_repo(unpushed_collection_t* collection, const char* repo_path, const char* repo_name) {
+void add_unpushed_repo(unpushed_collection_t* collection, const char* repo_path, const char* repo_name) {
     if (collection->count >= collection->capacity) {
         collection->capacity *= 2;
         collection->repos = realloc(collection->repos,
@@ -346,7 +331,7 @@ void add_repo(unpushed_collection_t* collection, const char* repo_path, const ch
 }
 
 // Add unpushed commit to repository
-void add_unpushed_commit(unpushed_repo_t* repo, const char* commit_info) {
+static void add_unpushed_commit(unpushed_repo_t* repo, const char* commit_info) {
     if (repo->commit_count >= repo->commit_capacity) {
         repo->commit_capacity *= 2;
         repo->unpushed_commits = realloc(repo->unpushed_commits,
@@ -363,14 +348,16 @@ void add_unpushed_commit(unpushed_repo_t* repo, const char* commit_info) {
     repo->commit_count++;
 }
 
+#ifndef COMMITTED_NOT_PUSHED_LIBRARY_ONLY
 // Don't truncate filenames - let the UI layer handle truncation
 char* truncate_filename(const char* filename, int is_file) {
     // Return filename as-is - UI will handle truncation with glyph-aware logic
     return strdup(filename);
 }
+#endif // COMMITTED_NOT_PUSHED_LIBRARY_ONLY
 
 // Get files changed in a specific commit
-void get_commit_files(unpushed_repo_t* repo, size_t commit_index) {
+static void get_commit_files(unpushed_repo_t* repo, size_t commit_index) {
     char commit_hash[9]; // First 8 chars of commit hash + null
     const char* commit_line = repo->unpushed_commits[commit_index];
 
@@ -385,11 +372,12 @@ void get_commit_files(unpushed_repo_t* repo, size_t commit_index) {
     // Run git show --name-only <commit> to get files changed
     char cmd[2048];
     FILE* fp;
+    pid_t pid;
 
-    snprintf(cmd, sizeof(cmd), "cd '%s' && git show --name-only --pretty=format: %s 2>/dev/null",
+    snprintf(cmd, sizeof(cmd), "cd '%s' && git -c core.quotepath=off show --name-only --pretty=format: %s 2>/dev/null",
              repo->repo_path, commit_hash);
 
-    fp = popen(cmd, "r");
+    fp = command_open(cmd, &pid);
     if (!fp) return;
 
     char buffer[1024];
@@ -419,7 +407,7 @@ void get_commit_files(unpushed_repo_t* repo, size_t commit_index) {
         file_count++;
     }
 
-    pclose(fp);
+    command_close(fp, pid);
 
     // Store files for this commit
     repo->commit_files[commit_index] = files;
@@ -427,14 +415,15 @@ void get_commit_files(unpushed_repo_t* repo, size_t commit_index) {
 }
 
 // Get unpushed commits for a specific repository
-void get_unpushed_commits(unpushed_collection_t* collection, unpushed_repo_t* repo) {
+static void get_unpushed_commits(unpushed_repo_t* repo) {
     char cmd[2048];
     FILE* fp;
+    pid_t pid;
     char buffer[1024];
 
     // First, check if repository has a remote
     snprintf(cmd, sizeof(cmd), "cd '%s' && git remote 2>/dev/null", repo->repo_path);
-    fp = popen(cmd, "r");
+    fp = command_open(cmd, &pid);
     if (!fp) return;
 
     char remote_name[256] = "";
@@ -442,7 +431,7 @@ void get_unpushed_commits(unpushed_collection_t* collection, unpushed_repo_t* re
         // Remove newline
         remote_name[strcspn(remote_name, "\n")] = 0;
     }
-    pclose(fp);
+    command_close(fp, pid);
 
     if (strlen(remote_name) == 0) {
         // No remote configured, skip this repo
@@ -451,14 +440,14 @@ void get_unpushed_commits(unpushed_collection_t* collection, unpushed_repo_t* re
 
     // Get current branch
     snprintf(cmd, sizeof(cmd), "cd '%s' && git branch --show-current 2>/dev/null", repo->repo_path);
-    fp = popen(cmd, "r");
+    fp = command_open(cmd, &pid);
     if (!fp) return;
 
     char branch_name[256] = "";
     if (fgets(branch_name, sizeof(branch_name), fp) != NULL) {
         branch_name[strcspn(branch_name, "\n")] = 0;
     }
-    pclose(fp);
+    command_close(fp, pid);
 
     if (strlen(branch_name) == 0) {
         // Not on any branch, skip
@@ -469,7 +458,7 @@ void get_unpushed_commits(unpushed_collection_t* collection, unpushed_repo_t* re
     snprintf(cmd, sizeof(cmd), "cd '%s' && git log --oneline %s/%s..HEAD 2>/dev/null",
              repo->repo_path, remote_name, branch_name);
 
-    fp = popen(cmd, "r");
+    fp = command_open(cmd, &pid);
     if (!fp) return;
 
     // Parse each line of git log output
@@ -489,12 +478,20 @@ void get_unpushed_commits(unpushed_collection_t* collection, unpushed_repo_t* re
         commit_index++;
     }
 
-    pclose(fp);
+    command_close(fp, pid);
 }
 
+// Look up the unpushed commits, and the files they touch, of every repository
+void committed_not_pushed_collect(unpushed_collection_t* collection) {
+    for (size_t i = 0; i < collection->count; i++) {
+        get_unpushed_commits(&collection->repos[i]);
+    }
+}
+
+#ifndef COMMITTED_NOT_PUSHED_LIBRARY_ONLY
 // Parse git-submodules report to find repositories to check
 // Now reads from centralized state.json
-void parse_git_submodules_report(unpushed_collection_t* collection, const char* report_path) {
+static void parse_git_submodules_report(unpushed_collection_t* collection, const char* report_path) {
     (void)report_path; // Unused parameter, kept for compatibility
     
     printf("Reading git-submodules data from state.json\n");
@@ -544,7 +541,7 @@ void parse_git_submodules_report(unpushed_collection_t* collection, const char*
             }
 
             // Add repository to check
-            add_repo(collection, path->value.str_val, name->value.str_val);
+            add_unpushed_repo(collection, path->value.str_val, name->value.str_val);
 
             // Get submodule paths for filtering
             json_value_t* submodules = get_nested_value(repo_obj, "submodules");
@@ -631,6 +628,7 @@ void generate_report(unpushed_collection_t* collection) {
     // Note: state_update_section takes ownership of report, don't free it here
     printf("Committed-not-pushed analysis report generated\n");
 }
+#endif // COMMITTED_NOT_PUSHED_LIBRARY_ONLY
 
 // Cleanup collection
 void unpushed_collection_cleanup(unpushed_collection_t* collection) {
@@ -662,6 +660,7 @@ void unpushed_collection_cleanup(unpushed_collection_t* collection) {
     }
 }
 
+#ifndef COMMITTED_NOT_PUSHED_LIBRARY_ONLY
 int main(int argc, char* argv[]) {
     printf("Committed Not Pushed Analyzer starting...\n");
 
@@ -721,7 +720,7 @@ int main(int argc, char* argv[]) {
     for (size_t i = 0; i < collection->count; i++) {
         unpushed_repo_t* repo = &collection->repos[i];
         printf("Analyzing unpushed commits in: %s\n", repo->repo_name);
-        get_unpushed_commits(collection, repo);
+        get_unpushed_commits(repo);
         printf("  Found %zu unpushed commits\n", repo->commit_count);
     }
 
@@ -747,4 +746,5 @@ int main(int argc, char* argv[]) {
     free(config);
 
     return 0;
-}
\ No newline at end of file
+}
+#endif // COMMITTED_NOT_PUSHED_LIBRARY_ONLY
@@ -0,0 +1,34 @@
+#ifndef COMMITTED_NOT_PUSHED_H
+#define COMMITTED_NOT_PUSHED_H
+
+#include <stddef.h>
+
+// Collector entry points shared by the committed-not-pushed CLI and the
+// three-pane TUI, which links committed-not-pushed-lib.o and calls them in-process.
+
+// Structure for committed-not-pushed information
+typedef struct {
+    char* repo_path;
+    char* repo_name;
+    char** unpushed_commits;
+    size_t commit_count;
+    size_t commit_capacity;
+    char*** commit_files;  // Array of file arrays for each commit
+    size_t* commit_file_counts;  // Number of files for each commit
+} unpushed_repo_t;
+
+// Collection of repositories with unpushed commits
+typedef struct {
+    unpushed_repo_t* repos;
+    size_t count;
+    size_t capacity;
+    char** submodule_paths;  // List of submodule paths to filter out
+    size_t submodule_count;
+} unpushed_collection_t;
+
+unpushed_collection_t* unpushed_collection_init(void);
+void add_unpushed_repo(unpushed_collection_t* collection, const char* repo_path, const char* repo_name);
+void committed_not_pushed_collect(unpushed_collection_t* collection);
+void unpushed_collection_cleanup(unpushed_collection_t* collection);
+
+#endif // COMMITTED_NOT_PUSHED_H
@@ -5,27 +5,10 @@
 #include <regex.h>
 #include <time.h>
 #include "../json-utils/json-utils.h"
-
-// Structure for dirty file information
-typedef struct {
-    char* repo_path;
-    char* repo_name;
-    char** dirty_files;
-    size_t file_count;
-    size_t file_capacity;
-} dirty_repo_t;
-
-// Collection of dirty repositories
-typedef struct {
-    dirty_repo_t* repos;
-    size_t count;
-    size_t capacity;
-    char** submodule_paths;  // List of submodule paths to filter out
-    size_t submodule_count;
-} dirty_collection_t;
+#include "dirty-files.h"
 
 // Initialize dirty collection
-dirty_collection_t* dirty_collection_init() {
+dirty_collection_t* dirty_collection_init(void) {
     dirty_collection_t* collection = calloc(1, sizeof(dirty_collection_t));
     if (!collection) return NULL;
 
@@ -42,8 +25,9 @@ dirty_collection_t* dirty_collection_init() {
     return collection;
 }
 
+#ifndef DIRTY_FILES_LIBRARY_ONLY
 // Check if a path is a submodule
-int is_submodule_path(dirty_collection_t* collection, const char* path) {
+static int is_submodule_path(dirty_collection_t* collection, const char* path) {
     for (size_t i = 0; i < collection->submodule_count; i++) {
         if (strcmp(collection->submodule_paths[i], path) == 0) {
             return 1;
@@ -53,7 +37,7 @@ int is_submodule_path(dirty_collection_t* collection, const char* path) {
 }
 
 // Add submodule path to collection
-void add_submodule_path(dirty_collection_t* collection, const char* path) {
+static void add_submodule_path(dirty_collection_t* collection, const char* path) {
     // Check if already exists
     if (is_submodule_path(collection, path)) return;
 
@@ -68,7 +52,7 @@ void add_submodule_path(dirty_collection_t* collection, const char* path) {
 }
 
 // Collect all submodule paths by reading .gitmodules file
-void collect_submodule_paths(dirty_collection_t* collection, const char* repo_path) {
+static void collect_submodule_paths(dirty_collection_t* collection, const char* repo_path) {
     char gitmodules_path[2048];
     snprintf(gitmodules_path, sizeof(gitmodules_path), "%s/.gitmodules", repo_path);
 
@@ -104,6 +88,7 @@ void collect_submodule_paths(dirty_collection_t* collection, const char* repo_pa
 
     fclose(fp);
 }
+#endif // DIRTY_FILES_LIBRARY_ONLY
 
 // Add dirty repository to collection
 void add_dirty_repo(dirty_collection_t* collection, const char* path, const char* name) {
@@ -125,7 +110,7 @@ void add_dirty_repo(dirty_collection_t* collection, const char* path, const char
 }
 
 // Add dirty file to repository
-void add_dirty_file(dirty_repo_t* repo, const char* filename) {
+static void add_dirty_file(dirty_repo_t* repo, const char* filename) {
     if (repo->file_count >= repo->file_capacity) {
         repo->file_capacity *= 2;
         char** new_files = realloc(repo->dirty_files, repo->file_capacity * sizeof(char*));
@@ -138,15 +123,16 @@ void add_dirty_file(dirty_repo_t* repo, const char* filename) {
 }
 
 // Get git status for dirty files in a specific repository
-void get_dirty_files(dirty_collection_t* collection, dirty_repo_t* repo) {
+static void get_dirty_files(dirty_repo_t* repo) {
     char cmd[2048];
     FILE* fp;
+    pid_t pid;
     char buffer[1024];
 
     // Run git status --porcelain to get dirty files
-    snprintf(cmd, sizeof(cmd), "cd '%s' && git status --porcelain 2>/dev/null", repo->repo_path);
+    snprintf(cmd, sizeof(cmd), "cd '%s' && git -c core.quotepath=off status --porcelain 2>/dev/null", repo->repo_path);
 
-    fp = popen(cmd, "r");
+    fp = command_open(cmd, &pid);
     if (!fp) return;
 
     // Parse each line of git status output
@@ -172,12 +158,40 @@ void get_dirty_files(dirty_collection_t* collection, dirty_repo_t* repo) {
         }
     }
 
-    pclose(fp);
+    command_close(fp, pid);
+}
+
+// Filter out repositories with no dirty files
+static void drop_clean_repos(dirty_collection_t* collection) {
+    size_t write_idx = 0;
+    for (size_t i = 0; i < collection->count; i++) {
+        if (collection->repos[i].file_count > 0) {
+            if (write_idx != i) {
+                collection->repos[write_idx] = collection->repos[i];
+            }
+            write_idx++;
+        } else {
+            // Free the repository that has no dirty files
+            free(collection->repos[i].repo_path);
+            free(collection->repos[i].repo_name);
+            free(collection->repos[i].dirty_files);
+        }
+    }
+    collection->count = write_idx;
+}
+
+// Run git status in every repository of the collection and drop the clean ones
+void dirty_files_collect(dirty_collection_t* collection) {
+    for (size_t i = 0; i < collection->count; i++) {
+        get_dirty_files(&collection->repos[i]);
+    }
+    drop_clean_repos(collection);
 }
 
+#ifndef DIRTY_FILES_LIBRARY_ONLY
 // Parse git-submodules report to find dirty repositories
 // Now reads from centralized state.json
-void parse_git_submodules_report(dirty_collection_t* collection, const char* report_path) {
+static void parse_git_submodules_report(dirty_collection_t* collection, const char* report_path) {
     (void)report_path; // Unused parameter, kept for compatibility
     
     printf("Reading git-submodules data from state.json\n");
@@ -372,6 +386,7 @@ void generate_json_report(dirty_collection_t* collection) {
     }
     // Note: state_update_section takes ownership of root, don't free it here
 }
+#endif // DIRTY_FILES_LIBRARY_ONLY
 
 // Cleanup dirty collection
 void dirty_collection_cleanup(dirty_collection_t* collection) {
@@ -398,6 +413,7 @@ void dirty_collection_cleanup(dirty_collection_t* collection) {
     }
 }
 
+#ifndef DIRTY_FILES_LIBRARY_ONLY
 int main(int argc, char* argv[]) {
     printf("Dirty Files Analyzer starting...\n");
 
@@ -421,29 +437,10 @@ int main(int argc, char* argv[]) {
     for (size_t i = 0; i < collection->count; i++) {
         dirty_repo_t* repo = &collection->repos[i];
         printf("Analyzing dirty files in: %s\n", repo->repo_name);
-        get_dirty_files(collection, repo);
+        get_dirty_files(repo);
         printf("  Found %zu dirty files\n", repo->file_count);
     }
-
-    // Filter out repositories with no dirty files
-    size_t write_idx = 0;
-    for (size_t i = 0; i < collection->count; i++) {
-        if (collection->repos[i].file_count > 0) {
-            if (write_idx != i) {
-                collection->repos[write_idx] = collection->repos[i];
-            }
-            write_idx++;
-        } else {
-            // Free the repository that has no dirty files
-            free(collection->repos[i].repo_path);
-            free(collection->repos[i].repo_name);
-            for (size_t j = 0; j < collection->repos[i].file_count; j++) {
-                free(collection->repos[i].dirty_files[j]);
-            }
-            free(collection->repos[i].dirty_files);
-        }
-    }
-    collection->count = write_idx;
+    drop_clean_repos(collection);
 
     // Generate JSON report
     generate_json_report(collection);
@@ -484,3 +481,4 @@ int main(int argc, char* argv[]) {
     printf("Dirty Files Analyzer completed\n");
     return 0;
 }
+#endif // DIRTY_FILES_LIBRARY_ONLY
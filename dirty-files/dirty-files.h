@@ -0,0 +1,32 @@
+#ifndef DIRTY_FILES_H
+#define DIRTY_FILES_H
+
+#include <stddef.h>
+
+// Collector entry points shared by the dirty-files CLI and the three-pane TUI,
+// which links dirty-files-lib.o and calls them in-process.
+
+// Structure for dirty file information
+typedef struct {
+    char* repo_path;
+    char* repo_name;
+    char** dirty_files;
+    size_t file_count;
+    size_t file_capacity;
+} dirty_repo_t;
+
+// Collection of dirty repositories
+typedef struct {
+    dirty_repo_t* repos;
+    size_t count;
+    size_t capacity;
+    char** submodule_paths;  // List of submodule paths to filter out
+    size_t submodule_count;
+} dirty_collection_t;
+
+dirty_collection_t* dirty_collection_init(void);
+void add_dirty_repo(dirty_collection_t* collection, const char* path, const char* name);
+void dirty_files_collect(dirty_collection_t* collection);
+void dirty_collection_cleanup(dirty_collection_t* collection);
+
+#endif // DIRTY_FILES_H
@@ -6,6 +6,8 @@
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <sys/select.h>
+#include <sys/file.h>
+#include <sys/eventfd.h>
 #include <dirent.h>
 #include <signal.h>
 #include <errno.h>
@@ -13,6 +15,7 @@
 #include <fcntl.h>
 #include <limits.h>
 #include "inotify-daemon.h"
+#include "inotify-protocol.h"
 #include "../json-utils/json-utils.h"
 
 // Global daemon state
@@ -54,9 +57,92 @@ int should_exclude_path(const char* path) {
     return 0;
 }
 
+// Record a watch entry; needs the shard lock
+// Returns: 0 on success, -1 if the table cannot grow
+static int append_watch(event_shard_t* shard, int wd, path_id_t path_id, uint16_t repository,
+                        const struct stat* st) {
+    if (shard->watch_count >= shard->watch_capacity) {
+        size_t new_capacity = shard->watch_capacity == 0 ? 16 : shard->watch_capacity * 2;
+        watch_entry_t* new_watches = realloc(shard->watches, new_capacity * sizeof(watch_entry_t));
+        if (!new_watches) return -1;
+        shard->watches = new_watches;
+        shard->watch_capacity = new_capacity;
+    }
+    
+    watch_entry_t* entry = &shard->watches[shard->watch_count];
+    entry->wd = wd;
+    entry->path = path_id;
+    entry->repository = repository;
+    entry->dev = st->st_dev;
+    entry->ino = st->st_ino;
+    entry->mtime = st->st_mtim;
+    entry->entries_changed = 0;
+    shard->watch_count++;
+    return 0;
+}
+
+// Replay mode: hand out a synthetic watch descriptor, the same one again for a
+// directory that is already watched, like inotify_add_watch() does
+static int add_replay_watch(event_shard_t* shard, const char* path, uint16_t repository,
+                            const struct stat* st) {
+    pthread_mutex_lock(&shard->lock);
+    path_id_t path_id = path_intern(&shard->paths, path);
+    for (size_t i = 0; path_id != PATH_ID_NONE && i < shard->watch_count; i++) {
+        if (shard->watches[i].path == path_id) {
+            pthread_mutex_unlock(&shard->lock);
+            return 0;
+        }
+    }
+    int wd = __atomic_add_fetch(&g_daemon_state->next_replay_wd, 1, __ATOMIC_RELAXED);
+    int result = path_id == PATH_ID_NONE ? -1 : append_watch(shard, wd, path_id, repository, st);
+    pthread_mutex_unlock(&shard->lock);
+    
+    if (result == 0) shard_route_wd(wd, shard->index);
+    return result;
+}
+
+// Add a watch for a single directory and record it in its shard's watch table
+int add_watch_single(const char* path, uint16_t repository, const struct stat* st) {
+    event_shard_t* shard = repository_shard(repository);
+    if (!path || !st || !shard) return -1;
+    
+    if (g_daemon_state->replay) {
+        return add_replay_watch(shard, path, repository, st);
+    }
+    
+    // The watch can report events as soon as it exists; the reader waits on
+    // the route lock for those until the descriptor is routed below
+    shard_route_lock();
+    int wd = inotify_add_watch(g_daemon_state->inotify_fd, path,
+                               IN_MODIFY | IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO);
+    if (wd < 0) {
+        if (errno == ENOSPC) {
+            fprintf(stderr, "ERROR: inotify watch limit reached. Cannot add more watches.\n");
+        }
+        shard_route_unlock();
+        return -1;
+    }
+    
+    // Add to watch mapping
+    pthread_mutex_lock(&shard->lock);
+    path_id_t path_id = path_intern(&shard->paths, path);
+    if (path_id == PATH_ID_NONE || append_watch(shard, wd, path_id, repository, st) != 0) {
+        pthread_mutex_unlock(&shard->lock);
+        inotify_rm_watch(g_daemon_state->inotify_fd, wd);
+        shard_route_unlock();
+        return -1;
+    }
+    pthread_mutex_unlock(&shard->lock);
+    
+    // Events for this directory go to the shard's worker from now on
+    shard_route_wd(wd, shard->index);
+    shard_route_unlock();
+    return 0;
+}
+
 // Recursively add inotify watch to directory
-int add_watch_recursive(const char* path, const char* repository) {
-    if (!path || !repository || !g_daemon_state) return -1;
+int add_watch_recursive(const char* path, uint16_t repository) {
+    if (!path || !g_daemon_state) return -1;
     
     // Check if should exclude
     if (should_exclude_path(path)) {
@@ -74,33 +160,10 @@ int add_watch_recursive(const char* path, const char* repository) {
     }
     
     // Add watch to this directory
-    int wd = inotify_add_watch(g_daemon_state->inotify_fd, path,
-                               IN_MODIFY | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO);
-    if (wd < 0) {
-        if (errno == ENOSPC) {
-            fprintf(stderr, "ERROR: inotify watch limit reached. Cannot add more watches.\n");
-        }
+    if (add_watch_single(path, repository, &st) != 0) {
         return -1;
     }
     
-    // Add to watch mapping
-    if (g_daemon_state->watch_count >= g_daemon_state->watch_capacity) {
-        g_daemon_state->watch_capacity = g_daemon_state->watch_capacity == 0 ? 16 : g_daemon_state->watch_capacity * 2;
-        watch_entry_t* new_watches = realloc(g_daemon_state->watches,
-                                            g_daemon_state->watch_capacity * sizeof(watch_entry_t));
-        if (!new_watches) {
-            inotify_rm_watch(g_daemon_state->inotify_fd, wd);
-            return -1;
-        }
-        g_daemon_state->watches = new_watches;
-    }
-    
-    watch_entry_t* entry = &g_daemon_state->watches[g_daemon_state->watch_count];
-    entry->wd = wd;
-    entry->path = strdup(path);
-    entry->repository = strdup(repository);
-    g_daemon_state->watch_count++;
-    
     // Recursively add watches to subdirectories
     DIR* dir = opendir(path);
     if (dir) {
@@ -128,6 +191,109 @@ int add_watch_recursive(const char* path, const char* repository) {
     return 0;
 }
 
+// Remember a repository root so event paths can be reported relative to it
+static void register_repository(const char* name, const char* root) {
+    if (!g_daemon_state || !name || !root) return;
+    if (g_daemon_state->repository_count >= UINT16_MAX) return; // Referenced by 16-bit index
+
+    repository_t* new_repos = realloc(g_daemon_state->repositories,
+                                      (g_daemon_state->repository_count + 1) * sizeof(repository_t));
+    if (!new_repos) return;
+    g_daemon_state->repositories = new_repos;
+
+    repository_t* repo = &g_daemon_state->repositories[g_daemon_state->repository_count];
+    repo->name = strdup(name);
+    repo->root = strdup(root);
+    repo->root_path = PATH_ID_NONE;
+    repo->shard = 0;
+    g_daemon_state->repository_count++;
+}
+
+// Spread repositories round-robin over the shards
+static void assign_repository_shards(void) {
+    for (size_t i = 0; i < g_daemon_state->repository_count; i++) {
+        repository_t* repo = &g_daemon_state->repositories[i];
+        event_shard_t* shard = &g_daemon_state->shards[i % g_daemon_state->shard_count];
+        repo->shard = shard->index;
+        repo->root_path = path_intern(&shard->paths, repo->root);
+        shard->repository_count++;
+    }
+}
+
+// Shard owning a repository's watches and events
+event_shard_t* repository_shard(uint16_t repository) {
+    if (!g_daemon_state || repository >= g_daemon_state->repository_count || !g_daemon_state->shards) {
+        return NULL;
+    }
+    return &g_daemon_state->shards[g_daemon_state->repositories[repository].shard];
+}
+
+// Name of a repository by table index
+const char* repository_name(uint16_t repository) {
+    if (!g_daemon_state || repository >= g_daemon_state->repository_count) return "unknown";
+    return g_daemon_state->repositories[repository].name;
+}
+
+// Materialize an event path relative to its repository root; needs the shard lock
+// unless called by the shard's worker
+// Returns: length written, 0 if it does not fit
+size_t event_relative_path(const file_event_t* event, char* buffer, size_t size) {
+    event_shard_t* shard = event ? repository_shard(event->repository) : NULL;
+    if (!shard) return 0;
+
+    path_id_t base = g_daemon_state->repositories[event->repository].root_path;
+    return path_build(&shard->paths, event->path, base, buffer, size);
+}
+
+// Watches across all shards
+size_t watch_total_count(void) {
+    size_t total = 0;
+    for (size_t s = 0; s < g_daemon_state->shard_count; s++) {
+        event_shard_t* shard = &g_daemon_state->shards[s];
+        pthread_mutex_lock(&shard->lock);
+        total += shard->watch_count;
+        pthread_mutex_unlock(&shard->lock);
+    }
+    return total;
+}
+
+// Events across all shards
+size_t event_total_count(void) {
+    size_t total = 0;
+    for (size_t s = 0; s < g_daemon_state->shard_count; s++) {
+        event_shard_t* shard = &g_daemon_state->shards[s];
+        pthread_mutex_lock(&shard->lock);
+        total += shard->event_count;
+        pthread_mutex_unlock(&shard->lock);
+    }
+    return total;
+}
+
+// First existing event at or after ref, in shard order
+// Returns: event reference, EVENT_REF_NONE past the last event
+size_t event_ref_next(size_t ref) {
+    for (size_t s = EVENT_REF_SHARD(ref); s < g_daemon_state->shard_count; s++) {
+        event_shard_t* shard = &g_daemon_state->shards[s];
+        pthread_mutex_lock(&shard->lock);
+        size_t count = shard->event_count;
+        pthread_mutex_unlock(&shard->lock);
+
+        size_t index = s == EVENT_REF_SHARD(ref) ? EVENT_REF_INDEX(ref) : 0;
+        if (index < count) return EVENT_REF(s, index);
+    }
+    return EVENT_REF_NONE;
+}
+
+// Convert an inotify event mask to its report name
+const char* event_type_name(int event_type) {
+    if (event_type & IN_MODIFY) return "IN_MODIFY";
+    if (event_type & IN_CREATE) return "IN_CREATE";
+    if (event_type & IN_DELETE) return "IN_DELETE";
+    if (event_type & IN_MOVED_FROM) return "IN_MOVED_FROM";
+    if (event_type & IN_MOVED_TO) return "IN_MOVED_TO";
+    return "UNKNOWN";
+}
+
 // Get repository name from path
 const char* get_repository_name(const char* repo_path) {
     // Extract repository name from path (last component)
@@ -138,8 +304,9 @@ const char* get_repository_name(const char* repo_path) {
     return repo_path;
 }
 
-// Initialize daemon with repository paths
-int daemon_init(const char* git_submodules_report_path, const char* report_file_path) {
+// Initialize daemon with repository paths; in replay mode stop short of the
+// kernel: the caller adds the watches and starts the shard workers
+int daemon_init(const char* git_submodules_report_path, const char* report_file_path, int replay) {
     if (!git_submodules_report_path || !report_file_path) {
         return -1;
     }
@@ -150,22 +317,17 @@ int daemon_init(const char* git_submodules_report_path, const char* report_file_
         return -1;
     }
     
+    metrics_init();
+    g_daemon_state->replay = replay;
+    g_daemon_state->inotify_fd = -1;
+    g_daemon_state->listen_fd = -1;
+    g_daemon_state->shm.fd = -1;
     g_daemon_state->report_file = strdup(report_file_path);
     g_daemon_state->git_submodules_report = strdup(git_submodules_report_path);
-    g_daemon_state->watch_capacity = 16;
-    g_daemon_state->event_capacity = 100;
-    g_daemon_state->watches = calloc(g_daemon_state->watch_capacity, sizeof(watch_entry_t));
-    g_daemon_state->events = calloc(g_daemon_state->event_capacity, sizeof(file_event_t));
-    
-    if (!g_daemon_state->watches || !g_daemon_state->events) {
-        daemon_cleanup();
-        return -1;
-    }
-    
-    // Initialize inotify
-    g_daemon_state->inotify_fd = inotify_init();
-    if (g_daemon_state->inotify_fd < 0) {
-        perror("inotify_init");
+    g_daemon_state->publish_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    g_daemon_state->stop_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (g_daemon_state->publish_fd < 0 || g_daemon_state->stop_fd < 0) {
+        perror("eventfd");
         daemon_cleanup();
         return -1;
     }
@@ -237,76 +399,228 @@ int daemon_init(const char* git_submodules_report_path, const char* report_file_
                 resolved_path[sizeof(resolved_path) - 1] = '\0';
             }
             
-            add_watch_recursive(resolved_path, name);
+            register_repository(name, resolved_path);
         }
     }
     
     json_free(report);
     
-    fprintf(stderr, "Daemon initialized with %zu watches\n", g_daemon_state->watch_count);
+    // One event shard per busy repository, up to the number of cores
+    if (shards_init(g_daemon_state->repository_count) != 0) {
+        fprintf(stderr, "Failed to allocate event shards\n");
+        daemon_cleanup();
+        return -1;
+    }
+    assign_repository_shards();
+    if (replay) {
+        return 0;
+    }
+    
+    // Initialize inotify
+    g_daemon_state->inotify_fd = inotify_init();
+    if (g_daemon_state->inotify_fd < 0) {
+        perror("inotify_init");
+        daemon_cleanup();
+        return -1;
+    }
+    
+    // Drain the kernel queue from the start; crawling below already generates events
+    if (inotify_reader_start(g_daemon_state->inotify_fd) != 0) {
+        daemon_cleanup();
+        return -1;
+    }
+    
+    // Re-add watches from the last snapshot where it is still valid, crawl the rest
+    add_repository_watches(WATCH_SNAPSHOT_FILE);
+    g_daemon_state->last_snapshot_save = time(NULL);
+    
+    // The shards belong to their workers from here on
+    if (shards_start() != 0) {
+        daemon_cleanup();
+        return -1;
+    }
+    
+    fprintf(stderr, "Daemon initialized with %zu watches in %zu shards\n",
+            watch_total_count(), g_daemon_state->shard_count);
     return 0;
 }
 
-// Find or create file event
-file_event_t* find_or_create_event(const char* path, const char* repository, int event_type) {
-    if (!g_daemon_state || !path || !repository) return NULL;
+// Find the event for a file in the repository's shard, same locking rules as below
+file_event_t* find_event(path_id_t path, uint16_t repository) {
+    event_shard_t* shard = repository_shard(repository);
+    if (!shard || path == PATH_ID_NONE) return NULL;
+    
+    for (size_t i = 0; i < shard->event_count; i++) {
+        if (shard->events[i].path == path &&
+            shard->events[i].repository == repository) {
+            return &shard->events[i];
+        }
+    }
+    return NULL;
+}
+
+// Find or create file event in the repository's shard; needs the shard lock
+// unless called by the shard's worker or before the workers start
+file_event_t* find_or_create_event(path_id_t path, uint16_t repository, int event_type) {
+    event_shard_t* shard = repository_shard(repository);
+    if (!shard || path == PATH_ID_NONE) return NULL;
     
     time_t now = time(NULL);
     
     // Look for existing event
-    for (size_t i = 0; i < g_daemon_state->event_count; i++) {
-        if (strcmp(g_daemon_state->events[i].path, path) == 0 &&
-            strcmp(g_daemon_state->events[i].repository, repository) == 0) {
-            // Update existing event
-            g_daemon_state->events[i].last_updated = now;
-            g_daemon_state->events[i].event_type = event_type;
-            return &g_daemon_state->events[i];
-        }
+    file_event_t* existing = find_event(path, repository);
+    if (existing) {
+        // Update existing event
+        existing->last_updated = now;
+        existing->event_type = event_type;
+        return existing;
     }
     
     // Create new event
-    if (g_daemon_state->event_count >= g_daemon_state->event_capacity) {
-        g_daemon_state->event_capacity *= 2;
-        file_event_t* new_events = realloc(g_daemon_state->events,
-                                          g_daemon_state->event_capacity * sizeof(file_event_t));
+    if (shard->event_count >= shard->event_capacity) {
+        size_t new_capacity = shard->event_capacity * 2;
+        file_event_t* new_events = realloc(shard->events, new_capacity * sizeof(file_event_t));
         if (!new_events) return NULL;
-        g_daemon_state->events = new_events;
+        shard->events = new_events;
+        shard->event_capacity = new_capacity;
     }
     
-    file_event_t* event = &g_daemon_state->events[g_daemon_state->event_count];
-    event->path = strdup(path);
-    event->repository = strdup(repository);
+    file_event_t* event = &shard->events[shard->event_count];
+    memset(event, 0, sizeof(*event));
+    event->path = path;
+    event->repository = repository;
     event->timestamp = now;
     event->event_type = event_type;
     event->first_detected = now;
     event->last_updated = now;
-    g_daemon_state->event_count++;
+    shard->event_count++;
     
     return event;
 }
 
-// Get path from watch descriptor
-const char* get_path_from_wd(int wd) {
-    if (!g_daemon_state) return NULL;
+// Get watch entry from watch descriptor within a shard
+watch_entry_t* get_watch_from_wd(event_shard_t* shard, int wd) {
+    if (!shard) return NULL;
     
-    for (size_t i = 0; i < g_daemon_state->watch_count; i++) {
-        if (g_daemon_state->watches[i].wd == wd) {
-            return g_daemon_state->watches[i].path;
+    for (size_t i = 0; i < shard->watch_count; i++) {
+        if (shard->watches[i].wd == wd) {
+            return &shard->watches[i];
         }
     }
     return NULL;
 }
 
-// Get repository from watch descriptor
-const char* get_repository_from_wd(int wd) {
-    if (!g_daemon_state) return NULL;
-    
-    for (size_t i = 0; i < g_daemon_state->watch_count; i++) {
-        if (g_daemon_state->watches[i].wd == wd) {
-            return g_daemon_state->watches[i].repository;
+// Reader thread, ring and shard counters
+static void add_reader_report(json_value_t* root) {
+    inotify_reader_stats_t stats;
+    inotify_reader_get_stats(&stats);
+    
+    json_value_t* shards = json_create_array();
+    if (!shards) return;
+    size_t occupancy = 0;
+    uint64_t high_water = 0;
+    for (size_t s = 0; s < g_daemon_state->shard_count; s++) {
+        event_shard_t* shard = &g_daemon_state->shards[s];
+        size_t shard_occupancy = inotify_ring_occupancy(&shard->ring);
+        uint64_t shard_high_water = __atomic_load_n(&shard->ring.high_water, __ATOMIC_RELAXED);
+        occupancy += shard_occupancy;
+        if (shard_high_water > high_water) high_water = shard_high_water;
+        
+        json_value_t* entry = json_create_object();
+        if (!entry) continue;
+        pthread_mutex_lock(&shard->lock);
+        json_object_set(entry, "repositories", json_create_number((double)shard->repository_count));
+        json_object_set(entry, "watches", json_create_number((double)shard->watch_count));
+        json_object_set(entry, "events", json_create_number((double)shard->event_count));
+        pthread_mutex_unlock(&shard->lock);
+        json_object_set(entry, "records", json_create_number(
+            (double)__atomic_load_n(&shard->records, __ATOMIC_RELAXED)));
+        json_object_set(entry, "ring_occupancy", json_create_number((double)shard_occupancy));
+        json_object_set(entry, "ring_high_water", json_create_number((double)shard_high_water));
+        json_object_set(entry, "hashed", json_create_number(
+            (double)__atomic_load_n(&shard->hashed, __ATOMIC_RELAXED)));
+        json_object_set(entry, "hashed_bytes", json_create_number(
+            (double)__atomic_load_n(&shard->hashed_bytes, __ATOMIC_RELAXED)));
+        json_object_set(entry, "suppressed", json_create_number(
+            (double)__atomic_load_n(&shard->suppressed, __ATOMIC_RELAXED)));
+        json_array_add(shards, entry);
+    }
+    
+    json_value_t* reader = json_create_object();
+    if (!reader) {
+        json_free(shards);
+        return;
+    }
+    json_object_set(reader, "ring_slots", json_create_number(INOTIFY_RING_SLOTS));
+    json_object_set(reader, "ring_occupancy", json_create_number((double)occupancy));
+    json_object_set(reader, "ring_high_water", json_create_number((double)high_water));
+    json_object_set(reader, "ring_full_waits", json_create_number((double)stats.ring_full_waits));
+    json_object_set(reader, "events", json_create_number((double)stats.events));
+    json_object_set(reader, "reads", json_create_number((double)stats.reads));
+    json_object_set(reader, "kernel_queue_max_bytes", json_create_number((double)stats.kernel_queue_max));
+    json_object_set(reader, "queue_overflows", json_create_number((double)stats.queue_overflows));
+    json_object_set(reader, "unrouted", json_create_number((double)stats.unrouted));
+    json_object_set(root, "reader", reader);
+    json_object_set(root, "shards", shards);
+}
+
+// Average bytes spent per entry on paths, trie vs. one strdup'd path and repository name each
+static void add_memory_report(json_value_t* root) {
+    const size_t malloc_overhead = 16; // Typical glibc chunk header + rounding per strdup
+    size_t trie_bytes = 0;
+    size_t live_bytes = 0;
+    size_t node_total = 0;
+    size_t watch_total = 0;
+    size_t event_total = 0;
+    double string_watch_bytes = 0;
+    double string_event_bytes = 0;
+    char path[PATH_MAX];
+    
+    for (size_t s = 0; s < g_daemon_state->shard_count; s++) {
+        event_shard_t* shard = &g_daemon_state->shards[s];
+        pthread_mutex_lock(&shard->lock);
+        const path_table_t* paths = &shard->paths;
+        trie_bytes += path_table_memory(paths);
+        // Live bytes: nodes, names and index slots at the 50% maximum load
+        live_bytes += paths->node_count * sizeof(path_node_t) + paths->names_len +
+                      2 * (paths->node_count + paths->name_count) * sizeof(uint32_t);
+        node_total += paths->node_count;
+        
+        for (size_t i = 0; i < shard->watch_count; i++) {
+            watch_entry_t* watch = &shard->watches[i];
+            size_t len = path_build(paths, watch->path, PATH_ID_NONE, path, sizeof(path));
+            string_watch_bytes += len + 1 + strlen(repository_name(watch->repository)) + 1 + 2 * malloc_overhead;
         }
-    }
-    return NULL;
+        for (size_t i = 0; i < shard->event_count; i++) {
+            file_event_t* event = &shard->events[i];
+            size_t len = path_build(paths, event->path, PATH_ID_NONE, path, sizeof(path));
+            string_event_bytes += len + 1 + strlen(repository_name(event->repository)) + 1 + 2 * malloc_overhead;
+        }
+        watch_total += shard->watch_count;
+        event_total += shard->event_count;
+        pthread_mutex_unlock(&shard->lock);
+    }
+    
+    double trie_share = (double)live_bytes / (double)(node_total ? node_total : 1);
+    size_t watch_count = watch_total ? watch_total : 1;
+    size_t event_count = event_total ? event_total : 1;
+    size_t string_refs = 2 * sizeof(char*);
+    size_t compact_refs = sizeof(path_id_t) + sizeof(uint16_t);
+    
+    json_value_t* memory = json_create_object();
+    if (!memory) return;
+    json_object_set(memory, "path_nodes", json_create_number((double)node_total));
+    json_object_set(memory, "path_table_bytes", json_create_number((double)trie_bytes));
+    json_object_set(memory, "path_table_live_bytes", json_create_number((double)live_bytes));
+    json_object_set(memory, "watch_entry_bytes", json_create_number((double)sizeof(watch_entry_t)));
+    json_object_set(memory, "event_entry_bytes", json_create_number((double)sizeof(file_event_t)));
+    json_object_set(memory, "path_bytes_per_watch", json_create_number(compact_refs + trie_share));
+    json_object_set(memory, "path_bytes_per_event", json_create_number(compact_refs + trie_share));
+    json_object_set(memory, "string_path_bytes_per_watch",
+                    json_create_number(string_refs + string_watch_bytes / (double)watch_count));
+    json_object_set(memory, "string_path_bytes_per_event",
+                    json_create_number(string_refs + string_event_bytes / (double)event_count));
+    json_object_set(root, "memory", memory);
 }
 
 // Write report to file
@@ -322,37 +636,45 @@ void write_report(void) {
     json_object_set(root, "timestamp", json_create_number((double)time(NULL)));
     
     json_value_t* files_array = json_create_array();
-    if (files_array) {
-        for (size_t i = 0; i < g_daemon_state->event_count; i++) {
-            file_event_t* event = &g_daemon_state->events[i];
+    for (size_t s = 0; files_array && s < g_daemon_state->shard_count; s++) {
+        event_shard_t* shard = &g_daemon_state->shards[s];
+        pthread_mutex_lock(&shard->lock);
+        for (size_t i = 0; i < shard->event_count; i++) {
+            file_event_t* event = &shard->events[i];
             
             json_value_t* file_obj = json_create_object();
             if (file_obj) {
-                json_object_set(file_obj, "path", json_create_string(event->path));
-                json_object_set(file_obj, "repository", json_create_string(event->repository));
+                char path[PATH_MAX];
+                path_build(&shard->paths, event->path, PATH_ID_NONE, path, sizeof(path));
+                json_object_set(file_obj, "path", json_create_string(path));
+                json_object_set(file_obj, "repository", json_create_string(repository_name(event->repository)));
                 json_object_set(file_obj, "first_detected", json_create_number((double)event->first_detected));
                 json_object_set(file_obj, "last_updated", json_create_number((double)event->last_updated));
                 
-                // Convert event type to string
-                const char* event_type_str = "UNKNOWN";
-                if (event->event_type & IN_MODIFY) event_type_str = "IN_MODIFY";
-                else if (event->event_type & IN_CREATE) event_type_str = "IN_CREATE";
-                else if (event->event_type & IN_DELETE) event_type_str = "IN_DELETE";
-                else if (event->event_type & IN_MOVED_FROM) event_type_str = "IN_MOVED_FROM";
-                else if (event->event_type & IN_MOVED_TO) event_type_str = "IN_MOVED_TO";
-                
-                json_object_set(file_obj, "event_type", json_create_string(event_type_str));
+                json_object_set(file_obj, "event_type", json_create_string(event_type_name(event->event_type)));
                 json_array_add(files_array, file_obj);
             }
         }
+        pthread_mutex_unlock(&shard->lock);
+    }
+    if (files_array) {
         json_object_set(root, "files", files_array);
     }
     
+    json_object_set(root, "watch_count", json_create_number((double)watch_total_count()));
+    add_memory_report(root);
+    add_reader_report(root);
+    
     // Write to temp file first, then rename (atomic write)
     char temp_file[PATH_MAX];
     snprintf(temp_file, sizeof(temp_file), "%s.tmp", g_daemon_state->report_file);
     
     if (json_write_file(temp_file, root) == 0) {
+        struct stat st;
+        if (stat(temp_file, &st) == 0) {
+            g_daemon_state->metrics.report_writes++;
+            g_daemon_state->metrics.report_bytes += (uint64_t)st.st_size;
+        }
         // Atomic rename
         rename(temp_file, g_daemon_state->report_file);
     } else {
@@ -362,67 +684,95 @@ void write_report(void) {
     json_free(root);
 }
 
+// Publish recently updated events to the shared-memory snapshot
+void publish_shm_snapshot(void) {
+    if (!g_daemon_state || !g_daemon_state->shm.base) return;
+    
+    time_t cutoff = time(NULL) - INOTIFY_SHM_ACTIVE_WINDOW;
+    
+    inotify_shm_begin_write(&g_daemon_state->shm);
+    int full = 0;
+    for (size_t s = 0; s < g_daemon_state->shard_count && !full; s++) {
+        event_shard_t* shard = &g_daemon_state->shards[s];
+        pthread_mutex_lock(&shard->lock);
+        for (size_t i = 0; i < shard->event_count; i++) {
+            file_event_t* event = &shard->events[i];
+            if (event->last_updated < cutoff) continue;
+            
+            char path[PATH_MAX];
+            if (!event_relative_path(event, path, sizeof(path))) continue;
+            if (inotify_shm_append(&g_daemon_state->shm, (uint32_t)event->event_type,
+                                   (int64_t)event->first_detected, (int64_t)event->last_updated,
+                                   repository_name(event->repository), path) != 0) {
+                full = 1;
+                break;
+            }
+        }
+        pthread_mutex_unlock(&shard->lock);
+    }
+    inotify_shm_end_write(&g_daemon_state->shm);
+    g_daemon_state->metrics.shm_publications++;
+}
+
+// Publish events the shard workers changed since the last pass
+static void publish_shard_changes(void) {
+    static size_t* refs = NULL;
+    static size_t capacity = 0;
+    
+    uint64_t count;
+    ssize_t got = read(g_daemon_state->publish_fd, &count, sizeof(count));
+    (void)got;
+    
+    size_t changed = shards_take_published(&refs, &capacity);
+    g_daemon_state->metrics.published += changed;
+    for (size_t i = 0; i < changed; i++) {
+        subscribers_publish(refs[i]);
+    }
+    
+    // One publication per pass
+    if (changed > 0) {
+        publish_shm_snapshot();
+    }
+}
+
 // Main daemon event loop
 void daemon_run(void) {
     if (!g_daemon_state) return;
     
-    char buffer[4096];
+    int publish_fd = g_daemon_state->publish_fd;
     
     while (!g_daemon_state->should_exit) {
         fd_set read_fds;
+        fd_set write_fds;
         FD_ZERO(&read_fds);
-        FD_SET(g_daemon_state->inotify_fd, &read_fds);
+        FD_ZERO(&write_fds);
+        FD_SET(publish_fd, &read_fds);
+        int max_fd = subscribers_fill_fd_sets(&read_fds, &write_fds, publish_fd);
         
         struct timeval timeout;
         timeout.tv_sec = 1;
         timeout.tv_usec = 0;
         
-        int ready = select(g_daemon_state->inotify_fd + 1, &read_fds, NULL, NULL, &timeout);
+        int ready = select(max_fd + 1, &read_fds, &write_fds, NULL, &timeout);
+        if (ready > 0) {
+            subscribers_handle_io(&read_fds, &write_fds);
+        }
         
-        if (ready > 0 && FD_ISSET(g_daemon_state->inotify_fd, &read_fds)) {
-            ssize_t length = read(g_daemon_state->inotify_fd, buffer, sizeof(buffer));
-            
-            if (length < 0) {
-                if (errno != EINTR) {
-                    perror("read");
-                }
-                continue;
-            }
-            
-            // Process inotify events
-            size_t i = 0;
-            while (i < (size_t)length) {
-                struct inotify_event* event = (struct inotify_event*)&buffer[i];
-                
-                if (event->len > 0) {
-                    const char* watch_path = get_path_from_wd(event->wd);
-                    const char* repository = get_repository_from_wd(event->wd);
-                    
-                    if (watch_path && repository) {
-                        // Build full file path
-                        char file_path[PATH_MAX];
-                        snprintf(file_path, sizeof(file_path), "%s/%s", watch_path, event->name);
-                        
-                        struct stat st;
-                        if (stat(file_path, &st) == 0) {
-                            if (S_ISREG(st.st_mode)) {
-                                // Regular file - track it
-                                char rel_path[PATH_MAX];
-                                // For now, use the full path - can be optimized later
-                                strncpy(rel_path, file_path, sizeof(rel_path) - 1);
-                                rel_path[sizeof(rel_path) - 1] = '\0';
-                                
-                                find_or_create_event(rel_path, repository, event->mask);
-                            } else if (S_ISDIR(st.st_mode) && (event->mask & IN_CREATE)) {
-                                // New directory created - add watch to it
-                                add_watch_recursive(file_path, repository);
-                            }
-                        }
-                    }
-                }
-                
-                i += sizeof(struct inotify_event) + event->len;
-            }
+        // An on-demand daemon goes away once every session has detached
+        if (g_daemon_state->exit_when_idle && g_daemon_state->session_count == 0 &&
+            time(NULL) - g_daemon_state->idle_since >= INOTIFY_IDLE_GRACE_SECONDS) {
+            g_daemon_state->should_exit = 1;
+            break;
+        }
+        
+        if (ready > 0 && FD_ISSET(publish_fd, &read_fds)) {
+            publish_shard_changes();
+        }
+        metrics_sample();
+        
+        // Keep the warm-start snapshot reasonably fresh in case we do not exit cleanly
+        if (time(NULL) - g_daemon_state->last_snapshot_save >= WATCH_SNAPSHOT_INTERVAL) {
+            watch_snapshot_save(WATCH_SNAPSHOT_FILE);
         }
         
         // Check if we should write report
@@ -437,34 +787,91 @@ void daemon_run(void) {
 void daemon_cleanup(void) {
     if (!g_daemon_state) return;
     
+    // The reader thread and the shard workers use the inotify descriptor until joined
+    inotify_reader_stop();
+    trace_record_stop();
+    shards_stop();
+    
     // Remove all watches
     if (g_daemon_state->inotify_fd >= 0) {
-        for (size_t i = 0; i < g_daemon_state->watch_count; i++) {
-            inotify_rm_watch(g_daemon_state->inotify_fd, g_daemon_state->watches[i].wd);
-            free(g_daemon_state->watches[i].path);
-            free(g_daemon_state->watches[i].repository);
+        for (size_t s = 0; s < g_daemon_state->shard_count; s++) {
+            event_shard_t* shard = &g_daemon_state->shards[s];
+            for (size_t i = 0; i < shard->watch_count; i++) {
+                inotify_rm_watch(g_daemon_state->inotify_fd, shard->watches[i].wd);
+            }
         }
         close(g_daemon_state->inotify_fd);
     }
     
-    // Free events
-    for (size_t i = 0; i < g_daemon_state->event_count; i++) {
-        free(g_daemon_state->events[i].path);
-        free(g_daemon_state->events[i].repository);
+    shards_free();
+    if (g_daemon_state->publish_fd >= 0) close(g_daemon_state->publish_fd);
+    if (g_daemon_state->stop_fd >= 0) close(g_daemon_state->stop_fd);
+    
+    for (size_t i = 0; i < g_daemon_state->repository_count; i++) {
+        free(g_daemon_state->repositories[i].name);
+        free(g_daemon_state->repositories[i].root);
     }
     
-    free(g_daemon_state->watches);
-    free(g_daemon_state->events);
+    free(g_daemon_state->repositories);
     free(g_daemon_state->report_file);
     free(g_daemon_state->git_submodules_report);
     free(g_daemon_state);
     g_daemon_state = NULL;
 }
 
+#ifndef INOTIFY_DAEMON_LIBRARY_ONLY
+// Take the per-user, per-workspace singleton lock
+// Returns: lock file descriptor (held until exit), -1 if another daemon owns the workspace
+static int acquire_workspace_lock(void) {
+    char lock_path[PATH_MAX];
+    if (inotify_lock_path(lock_path, sizeof(lock_path)) != 0) {
+        return -1;
+    }
+    
+    int fd = open(lock_path, O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    if (fd < 0) {
+        return -1;
+    }
+    
+    if (flock(fd, LOCK_EX | LOCK_NB) != 0) {
+        close(fd);
+        return -1;
+    }
+    
+    // Record the owner for anyone inspecting the lock
+    char pid_str[32];
+    int len = snprintf(pid_str, sizeof(pid_str), "%d\n", (int)getpid());
+    if (ftruncate(fd, 0) == 0 && len > 0) {
+        write(fd, pid_str, (size_t)len);
+    }
+    return fd;
+}
+
 // Main daemon entry point
 int main(int argc, char* argv[]) {
-    (void)argc;
-    (void)argv;
+    // --exit-when-idle: started on demand by a session, exit once none remain
+    // --record FILE: write every kernel event to a trace for inotify-replay
+    int exit_when_idle = 0;
+    char trace_path[PATH_MAX] = "";
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--exit-when-idle") == 0) {
+            exit_when_idle = 1;
+        } else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            // Resolve now; the daemon changes directory below
+            const char* path = argv[++i];
+            char cwd[PATH_MAX];
+            int len;
+            if (path[0] == '/' || getcwd(cwd, sizeof(cwd)) == NULL) {
+                len = snprintf(trace_path, sizeof(trace_path), "%s", path);
+            } else {
+                len = snprintf(trace_path, sizeof(trace_path), "%s/%s", cwd, path);
+            }
+            if (len < 0 || (size_t)len >= sizeof(trace_path)) {
+                fprintf(stderr, "Trace path too long: %s\n", path);
+                return 1;
+            }
+        }
+    }
     
     // Daemonize: fork and detach from terminal
     pid_t pid = fork();
@@ -512,19 +919,49 @@ int main(int argc, char* argv[]) {
     freopen("/dev/null", "w", stdout);
     freopen("/dev/null", "w", stderr);
     
+    // One daemon per user and workspace - bail out before crawling if it already runs
+    char socket_path[PATH_MAX];
+    int lock_fd = acquire_workspace_lock();
+    if (lock_fd < 0 || inotify_socket_path(socket_path, sizeof(socket_path)) != 0) {
+        return 0;
+    }
+    
     // Initialize daemon
-    if (daemon_init("git-submodules.report", "inotify-changes-report.json") != 0) {
+    if (daemon_init("git-submodules.report", "inotify-changes-report.json", 0) != 0) {
+        close(lock_fd);
         return 1;
     }
+    if (trace_path[0] && trace_record_start(trace_path) != 0) {
+        fprintf(stderr, "Cannot record a trace to %s\n", trace_path);
+    }
+    g_daemon_state->exit_when_idle = exit_when_idle;
+    g_daemon_state->idle_since = time(NULL);
+    
+    // Open the subscription socket; the report file keeps working without it
+    if (subscribers_init(socket_path) != 0) {
+        fprintf(stderr, "Subscription socket unavailable, report file only\n");
+    }
+    
+    // Publish the shared-memory snapshot for local readers
+    if (inotify_shm_create(&g_daemon_state->shm) == 0) {
+        publish_shm_snapshot();
+    } else {
+        fprintf(stderr, "Shared-memory snapshot unavailable\n");
+    }
     
     // Run daemon
     daemon_run();
     
-    // Write final report before exit
+    // Write final report and watch snapshot before exit
     write_report();
+    watch_snapshot_save(WATCH_SNAPSHOT_FILE);
     
     // Cleanup
+    subscribers_cleanup(socket_path);
+    inotify_shm_destroy(&g_daemon_state->shm);
     daemon_cleanup();
+    close(lock_fd);
     
     return 0;
 }
+#endif // INOTIFY_DAEMON_LIBRARY_ONLY
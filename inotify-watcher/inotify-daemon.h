@@ -2,49 +2,356 @@
 #define INOTIFY_DAEMON_H
 
 #include <sys/inotify.h>
+#include <sys/types.h>
+#include <sys/stat.h>
 #include <time.h>
+#include <sys/select.h>
+#include <stdint.h>
+#include <limits.h>
+#include <pthread.h>
+#include "inotify-shm.h"
 
-// Event tracking structure
+// Interned path: index of a node in the path trie
+typedef uint32_t path_id_t;
+#define PATH_ID_NONE UINT32_MAX
+
+// Trie node: a name below a parent directory (PATH_ID_NONE = filesystem root)
+typedef struct {
+    path_id_t parent;
+    uint32_t name;            // Offset of the interned name in the name arena
+} path_node_t;
+
+// Directory trie shared by watches and events (inotify-paths.c)
 typedef struct {
-    char* path;
-    char* repository;
+    path_node_t* nodes;
+    uint32_t node_count;
+    uint32_t node_capacity;
+    char* names;              // Interned names, NUL separated
+    size_t names_len;
+    size_t names_capacity;
+    size_t name_count;
+    uint32_t* node_index;     // (parent, name) -> node
+    size_t node_index_size;
+    uint32_t* name_index;     // name -> arena offset
+    size_t name_index_size;
+} path_table_t;
+
+// Event tracking structure; doubles as the content-hash cache of active files
+typedef struct {
+    path_id_t path;
+    uint16_t repository;      // Index into the repository table
+    uint8_t publish_pending;  // Queued for the main thread to publish
+    uint8_t hash_valid;       // content_hash/size/mtime describe the file
     time_t timestamp;
     int event_type;  // IN_MODIFY, IN_CREATE, IN_DELETE, etc.
+    int modify_pending;       // IN_MODIFY held back until close-write verifies it
     time_t first_detected;
     time_t last_updated;
+    time_t pending_since;
+    uint64_t content_hash;
+    int64_t size;
+    struct timespec mtime;
 } file_event_t;
 
+// Content verification (inotify-hash.c): files above the cap are never hashed,
+// and a held-back modification is reported anyway if no close-write follows
+#define INOTIFY_HASH_MAX_SIZE (8 * 1024 * 1024)
+#define INOTIFY_HASH_PENDING_TIMEOUT 2
+
 // Watch descriptor mapping
 typedef struct {
     int wd;
-    char* path;
-    char* repository;
+    path_id_t path;
+    uint16_t repository;      // Index into the repository table
+    dev_t dev;                // Identity and mtime when the watch was added,
+    ino_t ino;                // persisted for warm starts
+    struct timespec mtime;
+    int entries_changed;      // Entries created/deleted since mtime was taken
 } watch_entry_t;
 
-// Daemon state structure
+// Decoded inotify event handed from the reader thread to the main loop
 typedef struct {
-    int inotify_fd;
+    int wd;
+    uint32_t mask;
+    uint64_t received_ns;     // CLOCK_MONOTONIC when the reader pulled it from the kernel
+    char name[NAME_MAX + 1];  // Empty for events on the watched directory itself
+} inotify_record_t;
+
+// Reader thread buffers (inotify-reader.c); the ring size must be a power of two
+#define INOTIFY_READ_BUFFER (256 * 1024)
+#define INOTIFY_RING_SLOTS 4096      // Per shard
+#define INOTIFY_PROCESS_BATCH 1024   // Records a shard worker handles between wakeup checks
+
+// Single-producer (reader thread), single-consumer (shard worker) record ring
+typedef struct {
+    inotify_record_t* slots;
+    size_t head __attribute__((aligned(64)));  // Next slot to fill, written by the reader thread
+    size_t tail __attribute__((aligned(64)));  // Next slot to consume, written by the shard worker
+    int wake_fd __attribute__((aligned(64)));  // eventfd, readable once records were pushed
+    uint64_t high_water;                       // Most records ever waiting, written by the reader
+} inotify_ring_t;
+
+// Kernel event types counted by the reader thread
+typedef enum {
+    EVENT_KIND_MODIFY,
+    EVENT_KIND_CLOSE_WRITE,
+    EVENT_KIND_CREATE,
+    EVENT_KIND_DELETE,
+    EVENT_KIND_MOVED_FROM,
+    EVENT_KIND_MOVED_TO,
+    EVENT_KIND_OTHER,
+    EVENT_KIND_COUNT
+} event_kind_t;
+
+// Reader thread counters
+typedef struct {
+    uint64_t by_kind[EVENT_KIND_COUNT];
+    uint64_t events;              // Records pushed into the rings
+    uint64_t reads;               // read() calls on the inotify descriptor
+    uint64_t ring_full_waits;     // Times the reader had to wait for a shard worker
+    uint64_t kernel_queue_max;    // Most bytes seen queued in the kernel before a read
+    uint64_t queue_overflows;     // IN_Q_OVERFLOW events (kernel dropped events)
+    uint64_t unrouted;            // Records for a watch descriptor no shard owns
+} inotify_reader_stats_t;
+
+// Repositories are spread over at most this many worker threads
+#define INOTIFY_MAX_SHARDS 8
+
+// Event queued for publication and when its triggering record was read
+typedef struct {
+    size_t index;
+    uint64_t received_ns;
+} shard_change_t;
+
+// Event shard: the watches and events of a subset of repositories, owned by one
+// worker thread. The worker reads its tables without locking and takes the lock
+// to modify them; other threads take the lock to read.
+typedef struct {
+    inotify_ring_t ring;          // Records routed to this shard
+    pthread_mutex_t lock;
+    pthread_t thread;
+    int running;
+    size_t index;
+    path_table_t paths;           // Interned paths of this shard's watches and events
     watch_entry_t* watches;
     size_t watch_count;
     size_t watch_capacity;
     file_event_t* events;
     size_t event_count;
     size_t event_capacity;
+    shard_change_t* changed;      // Events waiting for publication
+    size_t changed_count;
+    size_t changed_capacity;
+    size_t* held;                 // Event indices with a modification awaiting close-write
+    size_t held_count;
+    size_t held_capacity;
+    size_t repository_count;
+    uint64_t records;             // Records processed by the worker
+    uint64_t hashed;              // Files hashed on close-write
+    uint64_t hashed_bytes;
+    uint64_t suppressed;          // Modifications dropped because the content did not change
+} event_shard_t;
+
+// Event reference valid across shards: shard in the high bits, event index below
+#define EVENT_REF(shard, index) (((size_t)(shard) << 32) | (size_t)(index))
+#define EVENT_REF_SHARD(ref) ((size_t)(ref) >> 32)
+#define EVENT_REF_INDEX(ref) ((size_t)(ref) & 0xffffffffu)
+#define EVENT_REF_NONE SIZE_MAX
+
+// Daemon metrics (inotify-metrics.c), owned by the main thread
+#define METRICS_RATE_WINDOW 10        // Seconds the per-type event rates are averaged over
+#define METRICS_LATENCY_BUCKETS 6     // <=100us, <=1ms, <=10ms, <=100ms, <=1s, >1s
+
+typedef struct {
+    time_t started_at;
+    time_t sampled_at;
+    uint64_t samples[METRICS_RATE_WINDOW + 1][EVENT_KIND_COUNT];  // Per-second totals, ring
+    size_t sample_count;
+    uint64_t latency_buckets[METRICS_LATENCY_BUCKETS];  // Kernel read to publication
+    uint64_t latency_count;
+    uint64_t latency_total_ns;
+    uint64_t latency_max_ns;
+    uint64_t published;           // Changes handed to subscribers and the snapshot
+    uint64_t report_writes;
+    uint64_t report_bytes;
+    uint64_t shm_publications;
+} daemon_metrics_t;
+
+// Persisted watch set (inotify-snapshot.c), relative to the repoWatch root
+#define WATCH_SNAPSHOT_FILE "inotify-watcher/watch-snapshot.txt"
+#define WATCH_SNAPSHOT_INTERVAL 300
+
+// Repository root registered from git-submodules.report
+typedef struct {
+    char* name;
+    char* root;
+    path_id_t root_path;      // Interned root in its shard, base for relative event paths
+    size_t shard;             // Index of the owning event shard
+} repository_t;
+
+// Per-client output buffer size; records beyond it are coalesced
+#define SUBSCRIBER_BUFFER_SIZE 65536
+#define SUBSCRIBER_MAX_PENDING 1024
+#define SUBSCRIBER_MAX_CLIENTS 32
+
+// Connected socket client
+typedef struct {
+    int fd;
+    int subscribed;
+    int attached;             // Counts as a repoWatch session
+    char in_buf[256];
+    size_t in_len;
+    char* out_buf;
+    size_t out_len;
+    size_t snapshot_cursor;   // Next event reference to send while a snapshot is streaming
+    int in_snapshot;
+    int snapshot_header_sent;
+    int needs_resync;         // Pending set overflowed - send a fresh snapshot
+    size_t* pending;          // Event references changed while the client was behind
+    size_t pending_count;
+    int lagging;
+    unsigned long coalesced;  // Change records merged into a later one
+} subscriber_t;
+
+// Daemon state structure
+typedef struct {
+    int inotify_fd;
+    int listen_fd;
+    int publish_fd;               // eventfd, readable once a shard queued changed events
+    int stop_fd;                  // eventfd, written once to stop the shard workers
+    subscriber_t clients[SUBSCRIBER_MAX_CLIENTS];
+    size_t client_count;
+    size_t session_count;         // Attached sessions sharing this daemon
+    time_t idle_since;            // When the last session detached
+    int exit_when_idle;           // Started on demand by a session
+    repository_t* repositories;
+    size_t repository_count;
+    event_shard_t* shards;
+    size_t shard_count;
+    inotify_shm_t shm;            // Shared-memory snapshot of active files
+    daemon_metrics_t metrics;
     volatile int should_write_report;
     volatile int should_exit;
+    time_t last_snapshot_save;
+    time_t catchup_from;          // Downtime window covered by the startup catch-up scan
+    time_t catchup_until;
     char* report_file;
     char* git_submodules_report;
+    int replay;                   // Fed from a trace by inotify-replay, no kernel watches
+    int next_replay_wd;           // Synthetic watch descriptors handed out in replay mode
 } daemon_state_t;
 
 // Function declarations
-int daemon_init(const char* git_submodules_report_path, const char* report_file_path);
-int add_watch_recursive(const char* path, const char* repository);
+int daemon_init(const char* git_submodules_report_path, const char* report_file_path, int replay);
+int add_watch_recursive(const char* path, uint16_t repository);
+int add_watch_single(const char* path, uint16_t repository, const struct stat* st);
+file_event_t* find_event(path_id_t path, uint16_t repository);
+file_event_t* find_or_create_event(path_id_t path, uint16_t repository, int event_type);
+watch_entry_t* get_watch_from_wd(event_shard_t* shard, int wd);
+event_shard_t* repository_shard(uint16_t repository);
+size_t event_total_count(void);
+size_t event_ref_next(size_t ref);
 void daemon_run(void);
 void handle_sigusr1(int sig);
 void handle_sigterm(int sig);
 void write_report(void);
 void daemon_cleanup(void);
 int should_exclude_path(const char* path);
+const char* event_type_name(int event_type);
+const char* repository_name(uint16_t repository);
+size_t event_relative_path(const file_event_t* event, char* buffer, size_t size);
+size_t watch_total_count(void);
+void publish_shm_snapshot(void);
+
+// Path trie (inotify-paths.c)
+int path_table_init(path_table_t* table);
+void path_table_free(path_table_t* table);
+path_id_t path_intern(path_table_t* table, const char* path);
+path_id_t path_intern_child(path_table_t* table, path_id_t parent, const char* name);
+size_t path_build(const path_table_t* table, path_id_t id, path_id_t base, char* buffer, size_t size);
+size_t path_table_memory(const path_table_t* table);
+
+// Watch-set snapshot and warm start (inotify-snapshot.c)
+int watch_snapshot_save(const char* snapshot_path);
+void add_repository_watches(const char* snapshot_path);
+
+// Inotify reader thread and record rings (inotify-reader.c)
+int inotify_ring_init(inotify_ring_t* ring);
+void inotify_ring_free(inotify_ring_t* ring);
+void inotify_ring_clear_wake(inotify_ring_t* ring);
+const inotify_record_t* inotify_ring_peek(inotify_ring_t* ring);
+void inotify_ring_advance(inotify_ring_t* ring);
+size_t inotify_ring_occupancy(inotify_ring_t* ring);
+int inotify_reader_start(int inotify_fd);
+void inotify_reader_get_stats(inotify_reader_stats_t* stats);
+void inotify_reader_stop(void);
+void inotify_reader_inject(const char* buffer, size_t length);
+
+// Event traces (inotify-trace.c). Text, one record per line:
+//   R <repository>                                   repository, referenced by position
+//   D <repository> <dir>                             directory watched when recording began
+//   E <offset_us> <mask> <repository> <dir> <name>   event; mask in hex, dir "." for the root
+#define INOTIFY_TRACE_HEADER "# repowatch inotify trace 1"
+
+typedef struct {
+    uint64_t offset_us;           // Since the recording started
+    uint32_t mask;
+    uint16_t repository;
+    const char* dir;              // Relative to the repository root, "." for the root
+    const char* name;
+} trace_event_t;
+
+typedef struct {
+    uint16_t repository;
+    const char* dir;
+} trace_dir_t;
+
+typedef struct {
+    char* data;                   // The file; names point into it
+    const char** repositories;
+    size_t repository_count;
+    trace_dir_t* dirs;
+    size_t dir_count;
+    trace_event_t* events;
+    size_t event_count;
+} trace_t;
+
+int trace_record_start(const char* path);
+void trace_record_event(const struct inotify_event* event, uint64_t received_ns);
+void trace_record_stop(void);
+int trace_load(const char* path, trace_t* trace);
+void trace_free(trace_t* trace);
+
+// Metrics (inotify-metrics.c)
+uint64_t monotonic_ns(void);
+event_kind_t event_kind(uint32_t mask);
+void metrics_init(void);
+void metrics_sample(void);
+void metrics_record_latency(uint64_t received_ns, uint64_t now_ns);
+size_t metrics_format(char* buffer, size_t size);
+
+// Content hashing (inotify-hash.c)
+int hash_file_contents(const char* path, uint64_t* hash, uint64_t* bytes_read);
+
+// Event shards and their worker threads (inotify-shards.c)
+int shards_init(size_t repository_count);
+int shards_start(void);
+void shards_stop(void);
+void shards_free(void);
+void shard_route_wd(int wd, size_t shard);
+int shard_for_wd(int wd);
+int shard_for_new_wd(int wd);
+void shard_route_lock(void);
+void shard_route_unlock(void);
+void shard_queue_publish(event_shard_t* shard, file_event_t* event, uint64_t received_ns);
+size_t shards_take_published(size_t** refs, size_t* capacity);
+
+// Subscription socket (inotify-socket.c)
+int subscribers_init(const char* socket_path);
+int subscribers_fill_fd_sets(fd_set* read_fds, fd_set* write_fds, int max_fd);
+void subscribers_handle_io(fd_set* read_fds, fd_set* write_fds);
+void subscribers_publish(size_t event_ref);
+void subscribers_cleanup(const char* socket_path);
 
 // Global daemon state
 extern daemon_state_t* g_daemon_state;
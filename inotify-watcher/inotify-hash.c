@@ -0,0 +1,169 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include "inotify-daemon.h"
+
+// Streaming XXH64: fast, non-cryptographic, good enough to tell whether a
+// save actually changed a file. Matches the reference implementation (seed 0)
+// on little-endian hosts.
+
+#define PRIME64_1 0x9E3779B185EBCA87ULL
+#define PRIME64_2 0xC2B2AE3D27D4EB4FULL
+#define PRIME64_3 0x165667B19E3779F9ULL
+#define PRIME64_4 0x85EBCA77C2B2AE63ULL
+#define PRIME64_5 0x27D4EB2F165667C5ULL
+
+#define HASH_READ_CHUNK 65536
+
+typedef struct {
+    uint64_t v[4];
+    uint64_t total_len;
+    unsigned char mem[32];
+    size_t mem_size;
+} xxh64_state_t;
+
+static uint64_t rotl64(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+static uint64_t read64(const unsigned char* p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static uint32_t read32(const unsigned char* p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static uint64_t xxh64_round(uint64_t acc, uint64_t input) {
+    acc += input * PRIME64_2;
+    acc = rotl64(acc, 31);
+    return acc * PRIME64_1;
+}
+
+static uint64_t xxh64_merge_round(uint64_t acc, uint64_t val) {
+    acc ^= xxh64_round(0, val);
+    return acc * PRIME64_1 + PRIME64_4;
+}
+
+static void xxh64_init(xxh64_state_t* state) {
+    memset(state, 0, sizeof(*state));
+    state->v[0] = PRIME64_1 + PRIME64_2;
+    state->v[1] = PRIME64_2;
+    state->v[2] = 0;
+    state->v[3] = -PRIME64_1;
+}
+
+// Consume 32-byte stripes
+static void xxh64_stripe(xxh64_state_t* state, const unsigned char* p) {
+    state->v[0] = xxh64_round(state->v[0], read64(p));
+    state->v[1] = xxh64_round(state->v[1], read64(p + 8));
+    state->v[2] = xxh64_round(state->v[2], read64(p + 16));
+    state->v[3] = xxh64_round(state->v[3], read64(p + 24));
+}
+
+static void xxh64_update(xxh64_state_t* state, const unsigned char* p, size_t len) {
+    state->total_len += len;
+
+    if (state->mem_size + len < 32) {
+        memcpy(state->mem + state->mem_size, p, len);
+        state->mem_size += len;
+        return;
+    }
+
+    if (state->mem_size > 0) {
+        size_t fill = 32 - state->mem_size;
+        memcpy(state->mem + state->mem_size, p, fill);
+        xxh64_stripe(state, state->mem);
+        p += fill;
+        len -= fill;
+        state->mem_size = 0;
+    }
+
+    while (len >= 32) {
+        xxh64_stripe(state, p);
+        p += 32;
+        len -= 32;
+    }
+
+    memcpy(state->mem, p, len);
+    state->mem_size = len;
+}
+
+static uint64_t xxh64_digest(const xxh64_state_t* state) {
+    uint64_t h;
+    if (state->total_len >= 32) {
+        h = rotl64(state->v[0], 1) + rotl64(state->v[1], 7) + rotl64(state->v[2], 12) + rotl64(state->v[3], 18);
+        for (int i = 0; i < 4; i++) {
+            h = xxh64_merge_round(h, state->v[i]);
+        }
+    } else {
+        h = state->v[2] + PRIME64_5;
+    }
+    h += state->total_len;
+
+    const unsigned char* p = state->mem;
+    size_t len = state->mem_size;
+    while (len >= 8) {
+        h ^= xxh64_round(0, read64(p));
+        h = rotl64(h, 27) * PRIME64_1 + PRIME64_4;
+        p += 8;
+        len -= 8;
+    }
+    if (len >= 4) {
+        h ^= (uint64_t)read32(p) * PRIME64_1;
+        h = rotl64(h, 23) * PRIME64_2 + PRIME64_3;
+        p += 4;
+        len -= 4;
+    }
+    while (len > 0) {
+        h ^= (*p) * PRIME64_5;
+        h = rotl64(h, 11) * PRIME64_1;
+        p++;
+        len--;
+    }
+
+    h ^= h >> 33;
+    h *= PRIME64_2;
+    h ^= h >> 29;
+    h *= PRIME64_3;
+    h ^= h >> 32;
+    return h;
+}
+
+// Hash a file's contents, refusing files above INOTIFY_HASH_MAX_SIZE
+// Returns: 0 on success, -1 if the file is too large or cannot be read
+int hash_file_contents(const char* path, uint64_t* hash, uint64_t* bytes_read) {
+    int fd = open(path, O_RDONLY | O_CLOEXEC | O_NOFOLLOW);
+    if (fd < 0) return -1;
+
+    unsigned char buffer[HASH_READ_CHUNK];
+    xxh64_state_t state;
+    xxh64_init(&state);
+
+    for (;;) {
+        ssize_t n = read(fd, buffer, sizeof(buffer));
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            close(fd);
+            return -1;
+        }
+        if (n == 0) break;
+        xxh64_update(&state, buffer, (size_t)n);
+        if (state.total_len > INOTIFY_HASH_MAX_SIZE) {
+            close(fd); // Grew past the cap while we read it
+            return -1;
+        }
+    }
+    close(fd);
+
+    *hash = xxh64_digest(&state);
+    *bytes_read = state.total_len;
+    return 0;
+}
@@ -0,0 +1,221 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <stdarg.h>
+#include "inotify-daemon.h"
+#include "inotify-protocol.h"
+
+// Daemon health counters for the STATS command. Per-type totals come from the
+// reader thread; the main loop samples them once a second so rates cover the
+// last METRICS_RATE_WINDOW seconds. Everything here runs on the main thread.
+
+static const char* kind_names[EVENT_KIND_COUNT] = {
+    "modify", "close_write", "create", "delete", "moved_from", "moved_to", "other"
+};
+
+static const char* latency_bucket_names[METRICS_LATENCY_BUCKETS] = {
+    "le_100us", "le_1ms", "le_10ms", "le_100ms", "le_1s", "gt_1s"
+};
+
+uint64_t monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// Classify an inotify mask for the per-type counters
+event_kind_t event_kind(uint32_t mask) {
+    if (mask & IN_MODIFY) return EVENT_KIND_MODIFY;
+    if (mask & IN_CLOSE_WRITE) return EVENT_KIND_CLOSE_WRITE;
+    if (mask & IN_CREATE) return EVENT_KIND_CREATE;
+    if (mask & IN_DELETE) return EVENT_KIND_DELETE;
+    if (mask & IN_MOVED_FROM) return EVENT_KIND_MOVED_FROM;
+    if (mask & IN_MOVED_TO) return EVENT_KIND_MOVED_TO;
+    return EVENT_KIND_OTHER;
+}
+
+void metrics_init(void) {
+    daemon_metrics_t* metrics = &g_daemon_state->metrics;
+    memset(metrics, 0, sizeof(*metrics));
+    metrics->started_at = time(NULL);
+}
+
+// Record per-type totals once a second for the rate window
+void metrics_sample(void) {
+    daemon_metrics_t* metrics = &g_daemon_state->metrics;
+    time_t now = time(NULL);
+    if (metrics->sample_count > 0 && now == metrics->sampled_at) return;
+
+    inotify_reader_stats_t stats;
+    inotify_reader_get_stats(&stats);
+    size_t slot = metrics->sample_count % (METRICS_RATE_WINDOW + 1);
+    memcpy(metrics->samples[slot], stats.by_kind, sizeof(stats.by_kind));
+    metrics->sample_count++;
+    metrics->sampled_at = now;
+}
+
+// Account one published change that was read from the kernel at received_ns
+void metrics_record_latency(uint64_t received_ns, uint64_t now_ns) {
+    daemon_metrics_t* metrics = &g_daemon_state->metrics;
+    if (received_ns == 0) return; // Catch-up results never came from the kernel
+
+    uint64_t latency = now_ns > received_ns ? now_ns - received_ns : 0;
+    uint64_t bound = 100000; // 100us
+    int bucket = 0;
+    while (bucket < METRICS_LATENCY_BUCKETS - 1 && latency > bound) {
+        bound *= 10;
+        bucket++;
+    }
+    metrics->latency_buckets[bucket]++;
+    metrics->latency_count++;
+    metrics->latency_total_ns += latency;
+    if (latency > metrics->latency_max_ns) metrics->latency_max_ns = latency;
+}
+
+// Read a single number from a proc file
+static long read_proc_long(const char* path, int field) {
+    FILE* file = fopen(path, "r");
+    if (!file) return -1;
+    long value = -1;
+    for (int i = 0; i <= field; i++) {
+        if (fscanf(file, "%ld", &value) != 1) {
+            value = -1;
+            break;
+        }
+    }
+    fclose(file);
+    return value;
+}
+
+typedef struct {
+    char* buffer;
+    size_t size;
+    size_t len;
+    int full;
+} metrics_writer_t;
+
+static void emit(metrics_writer_t* out, const char* name, const char* format, ...) {
+    char value[64];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(value, sizeof(value), format, args);
+    va_end(args);
+
+    // Leave room for the end marker
+    size_t room = out->size - out->len;
+    int len = snprintf(out->buffer + out->len, room, "%c\t%s\t%s\n", INOTIFY_RECORD_METRIC, name, value);
+    if (out->full || len < 0 || (size_t)len + 2 >= room) {
+        out->full = 1;
+        return;
+    }
+    out->len += (size_t)len;
+}
+
+static void emit_u64(metrics_writer_t* out, const char* name, uint64_t value) {
+    emit(out, name, "%llu", (unsigned long long)value);
+}
+
+// Format every metric as "M\t<name>\t<value>" lines followed by "Z"
+// Returns: bytes written, 0 if the buffer is too small
+size_t metrics_format(char* buffer, size_t size) {
+    daemon_metrics_t* metrics = &g_daemon_state->metrics;
+    metrics_writer_t out = { buffer, size, 0, 0 };
+    char name[64];
+
+    inotify_reader_stats_t stats;
+    inotify_reader_get_stats(&stats);
+    emit_u64(&out, "uptime_seconds", (uint64_t)(time(NULL) - metrics->started_at));
+
+    // Per-type totals and rates over the sampled window
+    size_t window = metrics->sample_count > METRICS_RATE_WINDOW ? METRICS_RATE_WINDOW :
+                    (metrics->sample_count > 0 ? metrics->sample_count - 1 : 0);
+    const uint64_t* newest = metrics->samples[(metrics->sample_count + METRICS_RATE_WINDOW) %
+                                              (METRICS_RATE_WINDOW + 1)];
+    const uint64_t* oldest = metrics->samples[(metrics->sample_count + METRICS_RATE_WINDOW - window) %
+                                              (METRICS_RATE_WINDOW + 1)];
+    for (int kind = 0; kind < EVENT_KIND_COUNT; kind++) {
+        snprintf(name, sizeof(name), "events.%s.total", kind_names[kind]);
+        emit_u64(&out, name, stats.by_kind[kind]);
+        snprintf(name, sizeof(name), "events.%s.per_second", kind_names[kind]);
+        double rate = window > 0 ? (double)(newest[kind] - oldest[kind]) / (double)window : 0.0;
+        emit(&out, name, "%.2f", rate);
+    }
+    emit_u64(&out, "events.rate_window_seconds", window);
+
+    // Kernel side
+    emit_u64(&out, "kernel.queue_overflows", stats.queue_overflows);
+    emit_u64(&out, "kernel.queue_max_bytes", stats.kernel_queue_max);
+    emit_u64(&out, "kernel.reads", stats.reads);
+    emit_u64(&out, "kernel.unrouted", stats.unrouted);
+    emit_u64(&out, "kernel.ring_full_waits", stats.ring_full_waits);
+
+    // Watches against the per-user limit
+    long limit = read_proc_long("/proc/sys/fs/inotify/max_user_watches", 0);
+    size_t watches = watch_total_count();
+    emit_u64(&out, "watches.count", watches);
+    if (limit > 0) {
+        emit_u64(&out, "watches.limit", (uint64_t)limit);
+        emit(&out, "watches.limit_used_percent", "%.1f", 100.0 * (double)watches / (double)limit);
+    }
+
+    // Downtime a warm start caught up on: from the snapshot until watches were back
+    if (g_daemon_state->catchup_until != 0) {
+        emit_u64(&out, "watches.catchup_from", (uint64_t)g_daemon_state->catchup_from);
+        emit_u64(&out, "watches.catchup_until", (uint64_t)g_daemon_state->catchup_until);
+        emit_u64(&out, "watches.catchup_seconds",
+                 (uint64_t)(g_daemon_state->catchup_until - g_daemon_state->catchup_from));
+    }
+
+    // Event table and how much the pipeline collapsed
+    uint64_t records = 0, hashed = 0, hashed_bytes = 0, suppressed = 0;
+    for (size_t s = 0; s < g_daemon_state->shard_count; s++) {
+        event_shard_t* shard = &g_daemon_state->shards[s];
+        records += __atomic_load_n(&shard->records, __ATOMIC_RELAXED);
+        hashed += __atomic_load_n(&shard->hashed, __ATOMIC_RELAXED);
+        hashed_bytes += __atomic_load_n(&shard->hashed_bytes, __ATOMIC_RELAXED);
+        suppressed += __atomic_load_n(&shard->suppressed, __ATOMIC_RELAXED);
+    }
+    uint64_t coalesced = 0;
+    for (size_t i = 0; i < g_daemon_state->client_count; i++) {
+        coalesced += g_daemon_state->clients[i].coalesced;
+    }
+    emit_u64(&out, "table.events", event_total_count());
+    emit_u64(&out, "table.shards", g_daemon_state->shard_count);
+    emit_u64(&out, "pipeline.records", records);
+    emit_u64(&out, "pipeline.published", metrics->published);
+    emit(&out, "pipeline.coalescing_ratio", "%.2f",
+         metrics->published ? (double)records / (double)metrics->published : 0.0);
+    emit_u64(&out, "pipeline.suppressed", suppressed);
+    emit_u64(&out, "pipeline.hashed_files", hashed);
+    emit_u64(&out, "pipeline.hashed_bytes", hashed_bytes);
+    emit_u64(&out, "subscribers.clients", g_daemon_state->client_count);
+    emit_u64(&out, "subscribers.sessions", g_daemon_state->session_count);
+    emit_u64(&out, "subscribers.coalesced", coalesced);
+
+    // Outputs
+    emit_u64(&out, "output.report_writes", metrics->report_writes);
+    emit_u64(&out, "output.report_bytes", metrics->report_bytes);
+    emit_u64(&out, "output.shm_publications", metrics->shm_publications);
+
+    // Kernel read to publication
+    emit_u64(&out, "latency.count", metrics->latency_count);
+    emit(&out, "latency.mean_us", "%.1f", metrics->latency_count ?
+         (double)metrics->latency_total_ns / (double)metrics->latency_count / 1000.0 : 0.0);
+    emit(&out, "latency.max_us", "%.1f", (double)metrics->latency_max_ns / 1000.0);
+    for (int bucket = 0; bucket < METRICS_LATENCY_BUCKETS; bucket++) {
+        snprintf(name, sizeof(name), "latency.%s", latency_bucket_names[bucket]);
+        emit_u64(&out, name, metrics->latency_buckets[bucket]);
+    }
+
+    long resident_pages = read_proc_long("/proc/self/statm", 1);
+    if (resident_pages >= 0) {
+        emit_u64(&out, "memory.rss_bytes", (uint64_t)resident_pages * (uint64_t)sysconf(_SC_PAGESIZE));
+    }
+
+    if (out.full) return 0;
+    out.buffer[out.len++] = INOTIFY_RECORD_METRICS_END;
+    out.buffer[out.len++] = '\n';
+    return out.len;
+}
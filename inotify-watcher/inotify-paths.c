@@ -0,0 +1,226 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "inotify-daemon.h"
+
+// Paths are stored as (parent, name) nodes of a trie shared by watches and
+// events. Names are interned once in a single arena, so a node is 8 bytes
+// plus its hash slot no matter how deep it sits. Full paths are only built
+// when something has to be written out.
+
+#define PATH_MAX_DEPTH 512
+#define INDEX_EMPTY UINT32_MAX
+
+static size_t hash_bytes(const char* str, size_t len) {
+    size_t hash = 1469598103934665603ULL;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= (unsigned char)str[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+static size_t hash_node(path_id_t parent, uint32_t name) {
+    uint64_t key = ((uint64_t)parent << 32) | name;
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    return (size_t)key;
+}
+
+static uint32_t* alloc_index(size_t size) {
+    uint32_t* index = malloc(size * sizeof(uint32_t));
+    if (index) memset(index, 0xff, size * sizeof(uint32_t));
+    return index;
+}
+
+int path_table_init(path_table_t* table) {
+    memset(table, 0, sizeof(*table));
+    table->node_index_size = 1024;
+    table->name_index_size = 1024;
+    table->node_index = alloc_index(table->node_index_size);
+    table->name_index = alloc_index(table->name_index_size);
+    if (!table->node_index || !table->name_index) {
+        path_table_free(table);
+        return -1;
+    }
+    return 0;
+}
+
+void path_table_free(path_table_t* table) {
+    free(table->nodes);
+    free(table->names);
+    free(table->node_index);
+    free(table->name_index);
+    memset(table, 0, sizeof(*table));
+}
+
+// Double the name index once it is half full
+static int grow_name_index(path_table_t* table) {
+    size_t new_size = table->name_index_size * 2;
+    uint32_t* new_index = alloc_index(new_size);
+    if (!new_index) return -1;
+
+    for (size_t i = 0; i < table->name_index_size; i++) {
+        uint32_t offset = table->name_index[i];
+        if (offset == INDEX_EMPTY) continue;
+        const char* name = table->names + offset;
+        size_t slot = hash_bytes(name, strlen(name)) & (new_size - 1);
+        while (new_index[slot] != INDEX_EMPTY) slot = (slot + 1) & (new_size - 1);
+        new_index[slot] = offset;
+    }
+
+    free(table->name_index);
+    table->name_index = new_index;
+    table->name_index_size = new_size;
+    return 0;
+}
+
+// Intern a name in the arena
+// Returns: arena offset, INDEX_EMPTY on allocation failure
+static uint32_t intern_name(path_table_t* table, const char* name, size_t len) {
+    size_t slot = hash_bytes(name, len) & (table->name_index_size - 1);
+    while (table->name_index[slot] != INDEX_EMPTY) {
+        const char* existing = table->names + table->name_index[slot];
+        if (strncmp(existing, name, len) == 0 && existing[len] == '\0') {
+            return table->name_index[slot];
+        }
+        slot = (slot + 1) & (table->name_index_size - 1);
+    }
+
+    if (table->names_len + len + 1 > table->names_capacity) {
+        size_t new_capacity = table->names_capacity == 0 ? 65536 : table->names_capacity * 2;
+        while (table->names_len + len + 1 > new_capacity) new_capacity *= 2;
+        if (new_capacity > UINT32_MAX) return INDEX_EMPTY;
+        char* new_names = realloc(table->names, new_capacity);
+        if (!new_names) return INDEX_EMPTY;
+        table->names = new_names;
+        table->names_capacity = new_capacity;
+    }
+
+    uint32_t offset = (uint32_t)table->names_len;
+    memcpy(table->names + offset, name, len);
+    table->names[offset + len] = '\0';
+    table->names_len += len + 1;
+    table->name_index[slot] = offset;
+    table->name_count++;
+
+    if (table->name_count * 2 > table->name_index_size && grow_name_index(table) != 0) {
+        return INDEX_EMPTY;
+    }
+    return offset;
+}
+
+// Double the node index once it is half full
+static int grow_node_index(path_table_t* table) {
+    size_t new_size = table->node_index_size * 2;
+    uint32_t* new_index = alloc_index(new_size);
+    if (!new_index) return -1;
+
+    for (uint32_t id = 0; id < table->node_count; id++) {
+        const path_node_t* node = &table->nodes[id];
+        size_t slot = hash_node(node->parent, node->name) & (new_size - 1);
+        while (new_index[slot] != INDEX_EMPTY) slot = (slot + 1) & (new_size - 1);
+        new_index[slot] = id;
+    }
+
+    free(table->node_index);
+    table->node_index = new_index;
+    table->node_index_size = new_size;
+    return 0;
+}
+
+// Look up or add the node for one path component
+static path_id_t intern_component(path_table_t* table, path_id_t parent, const char* name, size_t len) {
+    uint32_t name_offset = intern_name(table, name, len);
+    if (name_offset == INDEX_EMPTY) return PATH_ID_NONE;
+
+    size_t slot = hash_node(parent, name_offset) & (table->node_index_size - 1);
+    while (table->node_index[slot] != INDEX_EMPTY) {
+        const path_node_t* node = &table->nodes[table->node_index[slot]];
+        if (node->parent == parent && node->name == name_offset) {
+            return table->node_index[slot];
+        }
+        slot = (slot + 1) & (table->node_index_size - 1);
+    }
+
+    if (table->node_count >= table->node_capacity) {
+        uint32_t new_capacity = table->node_capacity == 0 ? 1024 : table->node_capacity * 2;
+        path_node_t* new_nodes = realloc(table->nodes, new_capacity * sizeof(path_node_t));
+        if (!new_nodes) return PATH_ID_NONE;
+        table->nodes = new_nodes;
+        table->node_capacity = new_capacity;
+    }
+
+    path_id_t id = table->node_count++;
+    table->nodes[id].parent = parent;
+    table->nodes[id].name = name_offset;
+    table->node_index[slot] = id;
+
+    if ((size_t)table->node_count * 2 > table->node_index_size && grow_node_index(table) != 0) {
+        return PATH_ID_NONE;
+    }
+    return id;
+}
+
+// Intern a direct child of an interned directory
+path_id_t path_intern_child(path_table_t* table, path_id_t parent, const char* name) {
+    if (!table || !name || !*name) return PATH_ID_NONE;
+    return intern_component(table, parent, name, strlen(name));
+}
+
+// Intern an absolute path, one node per component
+path_id_t path_intern(path_table_t* table, const char* path) {
+    if (!table || !path || path[0] != '/') return PATH_ID_NONE;
+
+    path_id_t id = PATH_ID_NONE;
+    const char* p = path;
+    while (*p) {
+        while (*p == '/') p++;
+        if (!*p) break;
+        const char* end = strchr(p, '/');
+        size_t len = end ? (size_t)(end - p) : strlen(p);
+        id = intern_component(table, id, p, len);
+        if (id == PATH_ID_NONE) return PATH_ID_NONE;
+        p += len;
+    }
+    return id;
+}
+
+// Build a path; relative to base when base is one of its ancestors, absolute otherwise
+// Returns: length written, 0 if the path does not fit
+size_t path_build(const path_table_t* table, path_id_t id, path_id_t base, char* buffer, size_t size) {
+    if (!table || !buffer || size == 0 || id == PATH_ID_NONE || id >= table->node_count) return 0;
+
+    path_id_t chain[PATH_MAX_DEPTH];
+    size_t depth = 0;
+    path_id_t current = id;
+    while (current != PATH_ID_NONE && current != base && depth < PATH_MAX_DEPTH) {
+        chain[depth++] = current;
+        current = table->nodes[current].parent;
+    }
+    if (depth == PATH_MAX_DEPTH) return 0;
+
+    // base was not an ancestor - fall back to the absolute path
+    int absolute = current != base || base == PATH_ID_NONE;
+
+    size_t len = 0;
+    for (size_t i = depth; i-- > 0;) {
+        const char* name = table->names + table->nodes[chain[i]].name;
+        size_t name_len = strlen(name);
+        int slash = absolute || i != depth - 1;
+        if (len + slash + name_len + 1 > size) return 0;
+        if (slash) buffer[len++] = '/';
+        memcpy(buffer + len, name, name_len);
+        len += name_len;
+    }
+    buffer[len] = '\0';
+    return len;
+}
+
+// Bytes held by the trie (nodes, names and both indexes)
+size_t path_table_memory(const path_table_t* table) {
+    if (!table) return 0;
+    return table->node_capacity * sizeof(path_node_t) + table->names_capacity +
+           (table->node_index_size + table->name_index_size) * sizeof(uint32_t);
+}
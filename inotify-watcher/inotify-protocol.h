@@ -0,0 +1,59 @@
+#ifndef INOTIFY_PROTOCOL_H
+#define INOTIFY_PROTOCOL_H
+
+// Wire protocol shared by inotify-daemon and its subscribers (three-pane-tui).
+//
+// Clients connect to the daemon's Unix domain socket and send newline
+// terminated commands. After SUBSCRIBE the daemon answers with a hello line,
+// a snapshot of its event table and then a live stream of change records.
+// All daemon records are single lines with tab separated fields:
+//
+//   H <version>                                      hello
+//   S <count>                                        snapshot begins
+//   C <event> <first> <last> <repository> <path>     change record
+//   E                                                snapshot ends
+//   R                                                resync, a new snapshot follows
+//   M <name> <value>                                 metric, in reply to STATS
+//   Z                                                end of the metrics reply
+//
+// <path> is relative to the repository root, <first>/<last> are unix seconds.
+// STATS may be sent without subscribing; inotify-stats uses it that way.
+//
+// One daemon serves every repoWatch session of a user in a workspace. Sessions
+// ATTACH when they start and are detached when they DETACH or disconnect; a
+// daemon started with --exit-when-idle exits once no session has been
+// attached for INOTIFY_IDLE_GRACE_SECONDS.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define INOTIFY_PROTOCOL_VERSION 1
+
+// Client -> daemon commands
+#define INOTIFY_CMD_SUBSCRIBE "SUBSCRIBE"
+#define INOTIFY_CMD_ATTACH "ATTACH"
+#define INOTIFY_CMD_DETACH "DETACH"
+#define INOTIFY_CMD_STATS "STATS"
+
+// Daemon -> client record tags
+#define INOTIFY_RECORD_HELLO 'H'
+#define INOTIFY_RECORD_SNAPSHOT_BEGIN 'S'
+#define INOTIFY_RECORD_CHANGE 'C'
+#define INOTIFY_RECORD_SNAPSHOT_END 'E'
+#define INOTIFY_RECORD_RESYNC 'R'
+#define INOTIFY_RECORD_METRIC 'M'
+#define INOTIFY_RECORD_METRICS_END 'Z'
+
+// Longest record line either side will produce or accept
+#define INOTIFY_RECORD_MAX 8192
+
+// How long an on-demand daemon outlives its last session
+#define INOTIFY_IDLE_GRACE_SECONDS 10
+
+// Well-known per-user, per-workspace locations (inotify-workspace.c).
+// The workspace is the repoWatch root, i.e. the caller's working directory.
+int inotify_workspace_key(uint32_t* key);
+int inotify_socket_path(char* buffer, size_t size);
+int inotify_lock_path(char* buffer, size_t size);
+
+#endif // INOTIFY_PROTOCOL_H
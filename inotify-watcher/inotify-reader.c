@@ -0,0 +1,266 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <time.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#include "inotify-daemon.h"
+
+// The reader thread only drains the inotify descriptor. Each kernel event is
+// decoded into a fixed-size slot of the owning shard's single-producer/
+// single-consumer ring; the shard worker consumes slots and does the
+// stat/trie/table work. Each ring index is written by one side only, and the
+// ring's eventfd wakes the worker after every batch.
+
+typedef struct {
+    int inotify_fd;
+    int stop_fd;
+    int running;
+    pthread_t thread;
+    char* buffer;
+    size_t heads[INOTIFY_MAX_SHARDS];  // Filled but not yet published, per ring
+    inotify_reader_stats_t stats;      // Written by the reader thread
+} inotify_reader_t;
+
+static inotify_reader_t g_reader = { .stop_fd = -1 };
+
+static void stat_add(uint64_t* counter, uint64_t value) {
+    __atomic_fetch_add(counter, value, __ATOMIC_RELAXED);
+}
+
+static void stat_max(uint64_t* counter, uint64_t value) {
+    if (value > __atomic_load_n(counter, __ATOMIC_RELAXED)) {
+        __atomic_store_n(counter, value, __ATOMIC_RELAXED);
+    }
+}
+
+// Allocate a ring and its wakeup descriptor
+// Returns: 0 on success, -1 on error
+int inotify_ring_init(inotify_ring_t* ring) {
+    ring->head = 0;
+    ring->tail = 0;
+    ring->high_water = 0;
+    ring->slots = calloc(INOTIFY_RING_SLOTS, sizeof(inotify_record_t));
+    ring->wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (!ring->slots || ring->wake_fd < 0) {
+        inotify_ring_free(ring);
+        return -1;
+    }
+    return 0;
+}
+
+void inotify_ring_free(inotify_ring_t* ring) {
+    if (ring->wake_fd >= 0) close(ring->wake_fd);
+    free(ring->slots);
+    ring->slots = NULL;
+    ring->wake_fd = -1;
+}
+
+// Make filled slots visible and wake the consumer
+static void ring_publish(inotify_ring_t* ring, size_t head) {
+    if (head == ring->head) return;
+    __atomic_store_n(&ring->head, head, __ATOMIC_RELEASE);
+    uint64_t one = 1;
+    ssize_t written = write(ring->wake_fd, &one, sizeof(one));
+    (void)written; // Counter already non-zero is just as good
+}
+
+// Reset the wakeup before draining, so records pushed meanwhile wake us again
+void inotify_ring_clear_wake(inotify_ring_t* ring) {
+    uint64_t count;
+    ssize_t got = read(ring->wake_fd, &count, sizeof(count));
+    (void)got;
+}
+
+// Oldest unconsumed record, NULL if the ring is empty
+const inotify_record_t* inotify_ring_peek(inotify_ring_t* ring) {
+    size_t tail = ring->tail;
+    if (tail == __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE)) return NULL;
+    return &ring->slots[tail & (INOTIFY_RING_SLOTS - 1)];
+}
+
+// Release the record returned by inotify_ring_peek()
+void inotify_ring_advance(inotify_ring_t* ring) {
+    __atomic_store_n(&ring->tail, ring->tail + 1, __ATOMIC_RELEASE);
+}
+
+// Records waiting right now
+size_t inotify_ring_occupancy(inotify_ring_t* ring) {
+    return __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+}
+
+// Whether inotify_reader_stop() has been called
+static int stop_requested(void) {
+    struct pollfd pfd = { .fd = g_reader.stop_fd, .events = POLLIN };
+    return poll(&pfd, 1, 0) > 0;
+}
+
+// Wait for a shard worker to free a slot
+// Returns: 0 once there is room, -1 if the reader is being stopped
+static int wait_for_room(inotify_ring_t* ring, size_t head) {
+    const struct timespec pause = { 0, 1000000 };
+    ring_publish(ring, head);
+    stat_add(&g_reader.stats.ring_full_waits, 1);
+    while (head - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE) >= INOTIFY_RING_SLOTS) {
+        if (stop_requested()) return -1;
+        nanosleep(&pause, NULL);
+    }
+    return 0;
+}
+
+// Decode one read() worth of events into the shard rings
+// Returns: 0 on success, -1 if the reader is being stopped
+static int push_events(const char* buffer, size_t length, uint64_t received_ns) {
+    event_shard_t* shards = g_daemon_state->shards;
+    size_t shard_count = g_daemon_state->shard_count;
+    for (size_t s = 0; s < shard_count; s++) {
+        g_reader.heads[s] = shards[s].ring.head;
+    }
+
+    size_t i = 0;
+    while (i + sizeof(struct inotify_event) <= length) {
+        const struct inotify_event* event = (const struct inotify_event*)(buffer + i);
+        i += sizeof(struct inotify_event) + event->len;
+
+        if (event->mask & IN_Q_OVERFLOW) {
+            stat_add(&g_reader.stats.queue_overflows, 1);
+            continue;
+        }
+
+        int shard = shard_for_wd(event->wd);
+        if (shard < 0) shard = shard_for_new_wd(event->wd);
+        if (shard < 0) {
+            stat_add(&g_reader.stats.unrouted, 1);
+            continue;
+        }
+        trace_record_event(event, received_ns);
+
+        inotify_ring_t* ring = &shards[shard].ring;
+        size_t head = g_reader.heads[shard];
+        if (head - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE) >= INOTIFY_RING_SLOTS &&
+            wait_for_room(ring, head) != 0) {
+            return -1;
+        }
+
+        inotify_record_t* record = &ring->slots[head & (INOTIFY_RING_SLOTS - 1)];
+        record->wd = event->wd;
+        record->mask = event->mask;
+        record->received_ns = received_ns;
+        size_t name_len = event->len > 0 ? strnlen(event->name, event->len) : 0;
+        if (name_len > NAME_MAX) name_len = NAME_MAX;
+        memcpy(record->name, event->name, name_len);
+        record->name[name_len] = '\0';
+        g_reader.heads[shard] = ++head;
+
+        stat_max(&ring->high_water, head - __atomic_load_n(&ring->tail, __ATOMIC_RELAXED));
+        stat_add(&g_reader.stats.events, 1);
+        stat_add(&g_reader.stats.by_kind[event_kind(event->mask)], 1);
+    }
+
+    for (size_t s = 0; s < shard_count; s++) {
+        ring_publish(&shards[s].ring, g_reader.heads[s]);
+    }
+    return 0;
+}
+
+static void* reader_thread(void* arg) {
+    (void)arg;
+    struct pollfd fds[2] = {
+        { .fd = g_reader.inotify_fd, .events = POLLIN },
+        { .fd = g_reader.stop_fd, .events = POLLIN },
+    };
+
+    for (;;) {
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) continue;
+            perror("poll");
+            break;
+        }
+        if (fds[1].revents) break;
+        if (!(fds[0].revents & POLLIN)) continue;
+
+        // Bytes still queued in the kernel when we got around to reading
+        int queued = 0;
+        if (ioctl(g_reader.inotify_fd, FIONREAD, &queued) == 0 && queued > 0) {
+            stat_max(&g_reader.stats.kernel_queue_max, (uint64_t)queued);
+        }
+
+        ssize_t length = read(g_reader.inotify_fd, g_reader.buffer, INOTIFY_READ_BUFFER);
+        if (length < 0) {
+            if (errno == EINTR || errno == EAGAIN) continue;
+            perror("read");
+            break;
+        }
+        stat_add(&g_reader.stats.reads, 1);
+
+        if (push_events(g_reader.buffer, (size_t)length, monotonic_ns()) != 0) break;
+    }
+    return NULL;
+}
+
+// Start draining inotify_fd into the shard rings on a dedicated thread
+// Returns: 0 on success, -1 on error
+int inotify_reader_start(int inotify_fd) {
+    g_reader.inotify_fd = inotify_fd;
+    g_reader.buffer = malloc(INOTIFY_READ_BUFFER);
+    g_reader.stop_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (!g_reader.buffer || g_reader.stop_fd < 0) {
+        perror("inotify reader");
+        inotify_reader_stop();
+        return -1;
+    }
+
+    // Signals stay with the main thread, which owns the select() loop
+    sigset_t all, old;
+    sigfillset(&all);
+    pthread_sigmask(SIG_SETMASK, &all, &old);
+    int rc = pthread_create(&g_reader.thread, NULL, reader_thread, NULL);
+    pthread_sigmask(SIG_SETMASK, &old, NULL);
+
+    if (rc != 0) {
+        fprintf(stderr, "pthread_create: %s\n", strerror(rc));
+        inotify_reader_stop();
+        return -1;
+    }
+    g_reader.running = 1;
+    return 0;
+}
+
+// Snapshot of the reader counters
+void inotify_reader_get_stats(inotify_reader_stats_t* stats) {
+    for (int kind = 0; kind < EVENT_KIND_COUNT; kind++) {
+        stats->by_kind[kind] = __atomic_load_n(&g_reader.stats.by_kind[kind], __ATOMIC_RELAXED);
+    }
+    stats->events = __atomic_load_n(&g_reader.stats.events, __ATOMIC_RELAXED);
+    stats->reads = __atomic_load_n(&g_reader.stats.reads, __ATOMIC_RELAXED);
+    stats->ring_full_waits = __atomic_load_n(&g_reader.stats.ring_full_waits, __ATOMIC_RELAXED);
+    stats->kernel_queue_max = __atomic_load_n(&g_reader.stats.kernel_queue_max, __ATOMIC_RELAXED);
+    stats->queue_overflows = __atomic_load_n(&g_reader.stats.queue_overflows, __ATOMIC_RELAXED);
+    stats->unrouted = __atomic_load_n(&g_reader.stats.unrouted, __ATOMIC_RELAXED);
+}
+
+// Feed events to the shard rings as if they had been read from the kernel;
+// inotify-replay uses this in place of the reader thread
+void inotify_reader_inject(const char* buffer, size_t length) {
+    push_events(buffer, length, monotonic_ns());
+}
+
+// Stop and join the reader thread
+void inotify_reader_stop(void) {
+    if (g_reader.running) {
+        uint64_t one = 1;
+        ssize_t written = write(g_reader.stop_fd, &one, sizeof(one));
+        (void)written;
+        pthread_join(g_reader.thread, NULL);
+        g_reader.running = 0;
+    }
+    if (g_reader.stop_fd >= 0) close(g_reader.stop_fd);
+    free(g_reader.buffer);
+    g_reader.buffer = NULL;
+    g_reader.stop_fd = -1;
+}
@@ -0,0 +1,438 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <ftw.h>
+#include <pthread.h>
+#include "inotify-daemon.h"
+#include "../json-utils/json-utils.h"
+
+// inotify-replay - feed a recorded inotify trace through the daemon pipeline
+//
+// Usage: inotify-replay [--speed FACTOR | --max] [--metrics] [--keep] TRACE
+//
+// The repositories are recreated under a scratch directory with the directories
+// that were watched when recording began. Each trace event is applied to the
+// scratch tree (create, write, delete, move) and then handed to the shard
+// rings through the reader's decoding path, so the workers stat, hash and
+// publish exactly as they would for kernel events - but without inotify, and
+// with the same input every run. Batches are replayed one after the other, so
+// the counts do not depend on thread timing. File writes carry a sequence
+// number, so every recorded modification is a content change.
+//
+// Recorded with: inotify-daemon --record FILE. Canned workloads live in
+// inotify-watcher/traces/.
+
+typedef struct {
+    trace_t trace;
+    double speed;                 // 0 replays as fast as the pipeline accepts
+    char scratch[64];             // mkdtemp() directory holding the repositories
+    char** roots;                 // Scratch root per trace repository
+    char* batch;                  // inotify_event records waiting to be injected
+    size_t batch_len;
+    uint64_t injected;
+    uint64_t skipped;             // Events for directories that were never watched
+    uint64_t adopted;             // Directories watched by a crawl rather than a create event
+    uint64_t first_ns;
+    uint64_t busy_ns;             // Spent waiting for the workers, i.e. pipeline time
+    int done;
+} replay_t;
+
+static replay_t g_replay;
+
+// mkdir -p
+static int make_dirs(const char* path) {
+    char buffer[PATH_MAX];
+    snprintf(buffer, sizeof(buffer), "%s", path);
+    for (char* p = buffer + 1; *p; p++) {
+        if (*p != '/') continue;
+        *p = '\0';
+        if (mkdir(buffer, 0755) != 0 && errno != EEXIST) return -1;
+        *p = '/';
+    }
+    return mkdir(buffer, 0755) != 0 && errno != EEXIST ? -1 : 0;
+}
+
+// Absolute scratch path of a trace directory
+static void scratch_dir(const trace_event_t* event, char* buffer, size_t size) {
+    const char* root = g_replay.roots[event->repository];
+    if (strcmp(event->dir, ".") == 0) {
+        snprintf(buffer, size, "%s", root);
+    } else {
+        snprintf(buffer, size, "%s/%s", root, event->dir);
+    }
+}
+
+// Recreate the effect of an event in the scratch tree before the pipeline sees it
+static void apply_event(const trace_event_t* event, const char* dir, uint64_t sequence) {
+    if (event->name[0] == '\0') return;
+
+    char path[PATH_MAX];
+    snprintf(path, sizeof(path), "%s/%s", dir, event->name);
+    int is_dir = (event->mask & IN_ISDIR) != 0;
+
+    if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+        if (is_dir) {
+            mkdir(path, 0755);
+        } else {
+            int fd = open(path, O_WRONLY | O_CREAT | O_CLOEXEC, 0644);
+            if (fd >= 0) close(fd);
+        }
+    } else if (event->mask & IN_MODIFY) {
+        int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd >= 0) {
+            char content[32];
+            int len = snprintf(content, sizeof(content), "%llu\n", (unsigned long long)sequence);
+            ssize_t written = write(fd, content, (size_t)len);
+            (void)written;
+            close(fd);
+        }
+    } else if (event->mask & IN_CLOSE_WRITE) {
+        int fd = open(path, O_WRONLY | O_CREAT | O_CLOEXEC, 0644);
+        if (fd >= 0) close(fd);
+    } else if (event->mask & IN_DELETE) {
+        if (is_dir) rmdir(path); else unlink(path);
+    } else if (event->mask & IN_MOVED_FROM) {
+        // Park it outside the repositories; a matching MOVED_TO recreates the target
+        char parked[PATH_MAX];
+        snprintf(parked, sizeof(parked), "%s/moved/%llu", g_replay.scratch, (unsigned long long)sequence);
+        rename(path, parked);
+    }
+}
+
+// Watch descriptor the daemon gave a scratch directory, -1 if it is not watched
+static int lookup_wd(uint16_t repository, const char* dir) {
+    event_shard_t* shard = repository_shard(repository);
+    if (!shard) return -1;
+
+    int wd = -1;
+    pthread_mutex_lock(&shard->lock);
+    path_id_t path = path_intern(&shard->paths, dir);
+    for (size_t i = 0; path != PATH_ID_NONE && i < shard->watch_count; i++) {
+        if (shard->watches[i].path == path && shard->watches[i].repository == repository) {
+            wd = shard->watches[i].wd;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&shard->lock);
+    return wd;
+}
+
+// A directory created while its parent was being crawled produces no create
+// event, but the crawl watches it. Recreate that: materialize the directory
+// below its nearest watched ancestor and watch it as the crawl would have.
+// Returns: the new watch descriptor, -1 if no ancestor is watched
+static int adopt_directory(uint16_t repository, const char* dir) {
+    const char* root = g_replay.roots[repository];
+    if (strlen(dir) <= strlen(root)) return -1;
+
+    char parent[PATH_MAX];
+    snprintf(parent, sizeof(parent), "%s", dir);
+    char* slash = strrchr(parent, '/');
+    if (!slash) return -1;
+    *slash = '\0';
+    if (lookup_wd(repository, parent) < 0 && adopt_directory(repository, parent) < 0) return -1;
+
+    struct stat st;
+    if (make_dirs(dir) != 0 || stat(dir, &st) != 0 || add_watch_single(dir, repository, &st) != 0) return -1;
+    g_replay.adopted++;
+    return lookup_wd(repository, dir);
+}
+
+// Records the shard workers have finished with
+static uint64_t processed_records(void) {
+    uint64_t total = 0;
+    for (size_t s = 0; s < g_daemon_state->shard_count; s++) {
+        total += __atomic_load_n(&g_daemon_state->shards[s].records, __ATOMIC_RELAXED);
+    }
+    return total;
+}
+
+static void flush_batch(void) {
+    if (g_replay.batch_len == 0) return;
+    if (g_replay.first_ns == 0) g_replay.first_ns = monotonic_ns();
+    inotify_reader_inject(g_replay.batch, g_replay.batch_len);
+    g_replay.batch_len = 0;
+}
+
+// Inject what is batched and let the workers process everything so far, so the
+// next events' effects on the tree happen after the pipeline looked at it
+static void wait_for_workers(void) {
+    uint64_t start = monotonic_ns();
+    flush_batch();
+    const struct timespec pause = { 0, 20000 };
+    while (processed_records() < __atomic_load_n(&g_replay.injected, __ATOMIC_ACQUIRE)) {
+        nanosleep(&pause, NULL);
+    }
+    g_replay.busy_ns += monotonic_ns() - start;
+}
+
+static void sleep_until(uint64_t target_ns) {
+    uint64_t now = monotonic_ns();
+    if (target_ns <= now) return;
+    struct timespec pause = { (time_t)((target_ns - now) / 1000000000ULL),
+                              (long)((target_ns - now) % 1000000000ULL) };
+    nanosleep(&pause, NULL);
+}
+
+// Apply an event to the scratch tree and append it to the injection batch
+static void queue_event(const trace_event_t* event, uint64_t sequence) {
+    char dir[PATH_MAX];
+    scratch_dir(event, dir, sizeof(dir));
+    int wd = lookup_wd(event->repository, dir);
+    if (wd < 0) {
+        // Maybe created by an event still in flight
+        wait_for_workers();
+        wd = lookup_wd(event->repository, dir);
+    }
+    if (wd < 0) {
+        wd = adopt_directory(event->repository, dir);
+    }
+    if (wd < 0) {
+        g_replay.skipped++;
+        return;
+    }
+    apply_event(event, dir, sequence);
+
+    size_t name_len = strlen(event->name);
+    size_t record_len = sizeof(struct inotify_event) + (name_len ? ((name_len + 16) & ~(size_t)15) : 0);
+    if (g_replay.batch_len + record_len > INOTIFY_READ_BUFFER) flush_batch();
+
+    struct inotify_event* record = (struct inotify_event*)(g_replay.batch + g_replay.batch_len);
+    memset(record, 0, record_len);
+    record->wd = wd;
+    record->mask = event->mask;
+    record->len = (uint32_t)(record_len - sizeof(struct inotify_event));
+    memcpy(record->name, event->name, name_len);
+    g_replay.batch_len += record_len;
+    __atomic_add_fetch(&g_replay.injected, 1, __ATOMIC_RELEASE);
+}
+
+// Events with the same timestamp came from one read() of the kernel queue;
+// replay them as one batch, in order, after the previous batch was processed
+static void* driver_thread(void* arg) {
+    (void)arg;
+    trace_t* trace = &g_replay.trace;
+    uint64_t start_ns = monotonic_ns();
+    uint64_t first_us = trace->event_count ? trace->events[0].offset_us : 0;
+
+    size_t i = 0;
+    while (i < trace->event_count) {
+        uint64_t offset_us = trace->events[i].offset_us;
+        if (g_replay.speed > 0) {
+            sleep_until(start_ns + (uint64_t)((double)(offset_us - first_us) * 1000.0 / g_replay.speed));
+        }
+        for (; i < trace->event_count && trace->events[i].offset_us == offset_us; i++) {
+            queue_event(&trace->events[i], i);
+        }
+        wait_for_workers();
+    }
+    __atomic_store_n(&g_replay.done, 1, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+// Create the scratch repositories and the daemon's git-submodules.report for them
+// Returns: 0 on success, -1 on error
+static int prepare_scratch(char* report_path, size_t size) {
+    snprintf(g_replay.scratch, sizeof(g_replay.scratch), "/tmp/repowatch-replay-XXXXXX");
+    if (!mkdtemp(g_replay.scratch)) {
+        perror("mkdtemp");
+        return -1;
+    }
+
+    trace_t* trace = &g_replay.trace;
+    g_replay.roots = calloc(trace->repository_count, sizeof(char*));
+    json_value_t* root = json_create_object();
+    json_value_t* repositories = json_create_array();
+    if (!g_replay.roots || !root || !repositories) return -1;
+
+    char path[PATH_MAX];
+    snprintf(path, sizeof(path), "%s/moved", g_replay.scratch);
+    make_dirs(path);
+    for (size_t i = 0; i < trace->repository_count; i++) {
+        snprintf(path, sizeof(path), "%s/repos/%zu", g_replay.scratch, i);
+        g_replay.roots[i] = strdup(path);
+        if (!g_replay.roots[i] || make_dirs(path) != 0) return -1;
+
+        json_value_t* repo = json_create_object();
+        json_object_set(repo, "name", json_create_string(trace->repositories[i]));
+        json_object_set(repo, "path", json_create_string(path));
+        json_array_add(repositories, repo);
+    }
+    json_object_set(root, "repositories", repositories);
+
+    // Directories watched when recording began
+    for (size_t i = 0; i < trace->dir_count; i++) {
+        const trace_dir_t* dir = &trace->dirs[i];
+        if (strcmp(dir->dir, ".") == 0) continue;
+        snprintf(path, sizeof(path), "%s/%s", g_replay.roots[dir->repository], dir->dir);
+        make_dirs(path);
+    }
+
+    snprintf(report_path, size, "%s/git-submodules.report", g_replay.scratch);
+    int result = json_write_file(report_path, root);
+    json_free(root);
+    return result;
+}
+
+static int remove_entry(const char* path, const struct stat* st, int type, struct FTW* ftw) {
+    (void)st;
+    (void)type;
+    (void)ftw;
+    remove(path);
+    return 0;
+}
+
+static void print_report(const char* trace_path, uint64_t wall_ns, size_t published) {
+    trace_t* trace = &g_replay.trace;
+    daemon_metrics_t* metrics = &g_daemon_state->metrics;
+    double recorded = trace->event_count ?
+        (double)(trace->events[trace->event_count - 1].offset_us - trace->events[0].offset_us) / 1e6 : 0.0;
+    double wall = (double)wall_ns / 1e9;
+
+    uint64_t suppressed = 0, hashed = 0;
+    size_t held = 0;
+    for (size_t s = 0; s < g_daemon_state->shard_count; s++) {
+        event_shard_t* shard = &g_daemon_state->shards[s];
+        suppressed += shard->suppressed;
+        hashed += shard->hashed;
+        held += shard->held_count;
+    }
+
+    printf("trace            %s (%zu events over %.2f s, %zu repositories)\n",
+           trace_path, trace->event_count, recorded, trace->repository_count);
+    if (g_replay.speed > 0) {
+        printf("speed            %.2fx\n", g_replay.speed);
+    } else {
+        printf("speed            max\n");
+    }
+    printf("wall time        %.3f s\n", wall);
+    double busy = (double)g_replay.busy_ns / 1e9;
+    printf("pipeline time    %.3f s\n", busy);
+    printf("throughput       %.0f events/s of pipeline time\n", busy > 0 ? (double)g_replay.injected / busy : 0.0);
+    printf("injected         %llu (%llu skipped, directory not watched)\n",
+           (unsigned long long)g_replay.injected, (unsigned long long)g_replay.skipped);
+    printf("published        %zu changes (%.2f events per change)\n", published,
+           published ? (double)g_replay.injected / (double)published : 0.0);
+    printf("event table      %zu files\n", event_total_count());
+    printf("watches          %zu (%llu found by crawling a new parent)\n", watch_total_count(),
+           (unsigned long long)g_replay.adopted);
+    printf("hashed           %llu files, %llu unchanged saves dropped, %zu still held\n",
+           (unsigned long long)hashed, (unsigned long long)suppressed, held);
+    printf("latency          mean %.1f us, max %.1f us\n",
+           metrics->latency_count ? (double)metrics->latency_total_ns / (double)metrics->latency_count / 1000.0 : 0.0,
+           (double)metrics->latency_max_ns / 1000.0);
+
+    static const char* buckets[METRICS_LATENCY_BUCKETS] = {
+        "<= 100us", "<= 1ms", "<= 10ms", "<= 100ms", "<= 1s", "> 1s"
+    };
+    for (int i = 0; i < METRICS_LATENCY_BUCKETS; i++) {
+        printf("  %-10s %10llu\n", buckets[i], (unsigned long long)metrics->latency_buckets[i]);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    const char* trace_path = NULL;
+    int show_metrics = 0;
+    int keep = 0;
+    g_replay.speed = 1.0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--speed") == 0 && i + 1 < argc) {
+            g_replay.speed = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--max") == 0) {
+            g_replay.speed = 0;
+        } else if (strcmp(argv[i], "--metrics") == 0) {
+            show_metrics = 1;
+        } else if (strcmp(argv[i], "--keep") == 0) {
+            keep = 1;
+        } else if (argv[i][0] != '-' && !trace_path) {
+            trace_path = argv[i];
+        } else {
+            trace_path = NULL;
+            break;
+        }
+    }
+    if (!trace_path || g_replay.speed < 0) {
+        fprintf(stderr, "Usage: %s [--speed FACTOR | --max] [--metrics] [--keep] TRACE\n", argv[0]);
+        return 1;
+    }
+
+    if (trace_load(trace_path, &g_replay.trace) != 0) return 1;
+    if (g_replay.trace.repository_count == 0) {
+        fprintf(stderr, "%s: no repositories in trace\n", trace_path);
+        return 1;
+    }
+
+    char report_path[PATH_MAX];
+    char changes_path[PATH_MAX];
+    if (prepare_scratch(report_path, sizeof(report_path)) != 0) {
+        fprintf(stderr, "Cannot prepare scratch repositories\n");
+        return 1;
+    }
+    snprintf(changes_path, sizeof(changes_path), "%s/inotify-changes-report.json", g_replay.scratch);
+
+    if (daemon_init(report_path, changes_path, 1) != 0) return 1;
+    add_repository_watches(NULL);
+    g_replay.batch = malloc(INOTIFY_READ_BUFFER);
+    if (!g_replay.batch || shards_start() != 0) {
+        daemon_cleanup();
+        return 1;
+    }
+
+    pthread_t driver;
+    if (pthread_create(&driver, NULL, driver_thread, NULL) != 0) {
+        daemon_cleanup();
+        return 1;
+    }
+
+    // Collect publications the way the daemon's main loop does
+    size_t* refs = NULL;
+    size_t capacity = 0;
+    size_t published = 0;
+    uint64_t last_ns = 0;
+    struct pollfd pfd = { .fd = g_daemon_state->publish_fd, .events = POLLIN };
+    for (;;) {
+        int finished = __atomic_load_n(&g_replay.done, __ATOMIC_ACQUIRE) &&
+                       processed_records() >= __atomic_load_n(&g_replay.injected, __ATOMIC_ACQUIRE);
+        if (poll(&pfd, 1, finished ? 0 : 10) > 0) {
+            uint64_t count;
+            ssize_t got = read(g_daemon_state->publish_fd, &count, sizeof(count));
+            (void)got;
+        }
+        size_t changed = shards_take_published(&refs, &capacity);
+        if (changed > 0) {
+            published += changed;
+            g_daemon_state->metrics.published += changed;
+            last_ns = monotonic_ns();
+        }
+        metrics_sample();
+        if (finished) break;
+    }
+    pthread_join(driver, NULL);
+
+    uint64_t end_ns = last_ns > 0 ? last_ns : monotonic_ns();
+    uint64_t wall_ns = g_replay.first_ns && end_ns > g_replay.first_ns ? end_ns - g_replay.first_ns : 0;
+    print_report(trace_path, wall_ns, published);
+    if (show_metrics) {
+        static char buffer[16384];
+        size_t len = metrics_format(buffer, sizeof(buffer));
+        fwrite(buffer, 1, len, stdout);
+    }
+
+    daemon_cleanup();
+    if (keep) {
+        printf("scratch tree     %s\n", g_replay.scratch);
+    } else {
+        nftw(g_replay.scratch, remove_entry, 16, FTW_DEPTH | FTW_PHYS);
+    }
+    for (size_t i = 0; i < g_replay.trace.repository_count; i++) free(g_replay.roots[i]);
+    free(g_replay.roots);
+    free(g_replay.batch);
+    free(refs);
+    trace_free(&g_replay.trace);
+    return 0;
+}
@@ -0,0 +1,434 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <time.h>
+#include "inotify-daemon.h"
+
+// Repositories are spread round-robin over up to INOTIFY_MAX_SHARDS shards,
+// one worker thread each. A shard's watches, events and path trie belong to
+// its worker; the only state shared between shards is the watch descriptor
+// routing table below (read by the reader thread) and the publication queue
+// the main thread drains into the socket feed and shared-memory snapshot.
+
+// wd -> shard + 1 (0 = unknown), in lazily allocated chunks so lookups never lock
+#define ROUTE_CHUNK_SIZE 4096
+#define ROUTE_CHUNKS 1024
+
+static uint8_t* g_routes[ROUTE_CHUNKS];
+
+// Held from inotify_add_watch() until the new descriptor is routed: the
+// reader can pull the watch's first events before that, and takes the lock
+// to wait for the route rather than drop them
+static pthread_mutex_t g_route_lock = PTHREAD_MUTEX_INITIALIZER;
+
+void shard_route_lock(void) {
+    pthread_mutex_lock(&g_route_lock);
+}
+
+void shard_route_unlock(void) {
+    pthread_mutex_unlock(&g_route_lock);
+}
+
+// Route events for a watch descriptor to a shard
+void shard_route_wd(int wd, size_t shard) {
+    if (wd < 0 || (size_t)wd >= (size_t)ROUTE_CHUNK_SIZE * ROUTE_CHUNKS) return;
+
+    uint8_t** slot = &g_routes[wd / ROUTE_CHUNK_SIZE];
+    uint8_t* chunk = __atomic_load_n(slot, __ATOMIC_ACQUIRE);
+    if (!chunk) {
+        uint8_t* fresh = calloc(ROUTE_CHUNK_SIZE, 1);
+        if (!fresh) return;
+        if (__atomic_compare_exchange_n(slot, &chunk, fresh, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+            chunk = fresh;
+        } else {
+            free(fresh); // Another worker installed the chunk first
+        }
+    }
+    __atomic_store_n(&chunk[wd % ROUTE_CHUNK_SIZE], (uint8_t)(shard + 1), __ATOMIC_RELEASE);
+}
+
+// Shard owning a watch descriptor
+// Returns: shard index, -1 if no shard watches it
+int shard_for_wd(int wd) {
+    if (wd < 0 || (size_t)wd >= (size_t)ROUTE_CHUNK_SIZE * ROUTE_CHUNKS) return -1;
+
+    uint8_t* chunk = __atomic_load_n(&g_routes[wd / ROUTE_CHUNK_SIZE], __ATOMIC_ACQUIRE);
+    if (!chunk) return -1;
+    return (int)__atomic_load_n(&chunk[wd % ROUTE_CHUNK_SIZE], __ATOMIC_ACQUIRE) - 1;
+}
+
+// Shard owning a watch descriptor shard_for_wd() did not find, once any
+// watch being added has been routed
+// Returns: shard index, -1 if no shard watches it (e.g. a removed watch)
+int shard_for_new_wd(int wd) {
+    pthread_mutex_lock(&g_route_lock);
+    int shard = shard_for_wd(wd);
+    pthread_mutex_unlock(&g_route_lock);
+    return shard;
+}
+
+// Pick the shard count and allocate the shards
+// Returns: 0 on success, -1 on error
+int shards_init(size_t repository_count) {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t count = repository_count;
+    if (cpus > 0 && count > (size_t)cpus) count = (size_t)cpus;
+    if (count > INOTIFY_MAX_SHARDS) count = INOTIFY_MAX_SHARDS;
+    if (count == 0) count = 1;
+
+    // The rings' indexes sit on their own cache lines
+    event_shard_t* shards = aligned_alloc(64, count * sizeof(event_shard_t));
+    if (!shards) return -1;
+    memset(shards, 0, count * sizeof(event_shard_t));
+    g_daemon_state->shards = shards;
+
+    for (size_t i = 0; i < count; i++) {
+        event_shard_t* shard = &shards[i];
+        shard->index = i;
+        shard->ring.wake_fd = -1;
+        pthread_mutex_init(&shard->lock, NULL);
+        g_daemon_state->shard_count++;
+
+        shard->watch_capacity = 16;
+        shard->event_capacity = 100;
+        shard->watches = calloc(shard->watch_capacity, sizeof(watch_entry_t));
+        shard->events = calloc(shard->event_capacity, sizeof(file_event_t));
+        if (!shard->watches || !shard->events ||
+            path_table_init(&shard->paths) != 0 || inotify_ring_init(&shard->ring) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// Queue an event for the main thread to publish; called with the shard lock held
+void shard_queue_publish(event_shard_t* shard, file_event_t* event, uint64_t received_ns) {
+    if (event->publish_pending) return;
+
+    if (shard->changed_count >= shard->changed_capacity) {
+        size_t new_capacity = shard->changed_capacity == 0 ? 64 : shard->changed_capacity * 2;
+        shard_change_t* new_changed = realloc(shard->changed, new_capacity * sizeof(shard_change_t));
+        if (!new_changed) return;
+        shard->changed = new_changed;
+        shard->changed_capacity = new_capacity;
+    }
+    shard->changed[shard->changed_count].index = (size_t)(event - shard->events);
+    shard->changed[shard->changed_count].received_ns = received_ns;
+    shard->changed_count++;
+    event->publish_pending = 1;
+}
+
+// Collect the events every shard queued for publication and record their latency
+// Returns: number of event references stored in *refs (grown as needed)
+size_t shards_take_published(size_t** refs, size_t* capacity) {
+    uint64_t now_ns = monotonic_ns();
+    size_t total = 0;
+    for (size_t s = 0; s < g_daemon_state->shard_count; s++) {
+        event_shard_t* shard = &g_daemon_state->shards[s];
+        pthread_mutex_lock(&shard->lock);
+
+        if (total + shard->changed_count > *capacity) {
+            size_t new_capacity = (total + shard->changed_count) * 2;
+            size_t* new_refs = realloc(*refs, new_capacity * sizeof(size_t));
+            if (!new_refs) {
+                pthread_mutex_unlock(&shard->lock);
+                break;
+            }
+            *refs = new_refs;
+            *capacity = new_capacity;
+        }
+
+        for (size_t i = 0; i < shard->changed_count; i++) {
+            size_t index = shard->changed[i].index;
+            shard->events[index].publish_pending = 0;
+            metrics_record_latency(shard->changed[i].received_ns, now_ns);
+            (*refs)[total++] = EVENT_REF(s, index);
+        }
+        shard->changed_count = 0;
+        pthread_mutex_unlock(&shard->lock);
+    }
+    return total;
+}
+
+// Report a file modification; called with the shard lock held
+// Returns: 1 if the event was queued for publication
+static int report_modification(event_shard_t* shard, path_id_t file, uint16_t repository, int event_type,
+                               uint64_t received_ns) {
+    file_event_t* changed = find_or_create_event(file, repository, event_type);
+    if (!changed) return 0;
+    shard_queue_publish(shard, changed, received_ns);
+    return 1;
+}
+
+// Hold back a modification of a file whose content hash is known; called with the shard lock held
+static void hold_modification(event_shard_t* shard, file_event_t* event, uint64_t received_ns) {
+    if (event->modify_pending) return;
+
+    if (shard->held_count >= shard->held_capacity) {
+        size_t new_capacity = shard->held_capacity == 0 ? 64 : shard->held_capacity * 2;
+        size_t* new_held = realloc(shard->held, new_capacity * sizeof(size_t));
+        if (!new_held) {
+            // Cannot track it - report right away instead
+            report_modification(shard, event->path, event->repository, IN_MODIFY, received_ns);
+            return;
+        }
+        shard->held = new_held;
+        shard->held_capacity = new_capacity;
+    }
+    shard->held[shard->held_count++] = (size_t)(event - shard->events);
+    event->modify_pending = 1;
+    event->pending_since = time(NULL);
+}
+
+// Report held modifications whose close-write never came (mmap writers, long-lived appenders)
+// Returns: 1 if anything was queued for publication
+static int release_held_modifications(event_shard_t* shard) {
+    time_t now = time(NULL);
+    uint64_t now_ns = monotonic_ns();
+    int queued = 0;
+
+    pthread_mutex_lock(&shard->lock);
+    size_t kept = 0;
+    for (size_t i = 0; i < shard->held_count; i++) {
+        file_event_t* event = &shard->events[shard->held[i]];
+        if (!event->modify_pending) continue; // Settled by its close-write
+        if (now - event->pending_since < INOTIFY_HASH_PENDING_TIMEOUT) {
+            shard->held[kept++] = shard->held[i];
+            continue;
+        }
+        event->modify_pending = 0;
+        event->hash_valid = 0;
+        // Latency counts from when the modification was first held
+        uint64_t held_ns = (uint64_t)(now - event->pending_since) * 1000000000ULL;
+        queued |= report_modification(shard, event->path, event->repository, IN_MODIFY,
+                                      now_ns > held_ns ? now_ns - held_ns : 0);
+    }
+    shard->held_count = kept;
+    pthread_mutex_unlock(&shard->lock);
+    return queued;
+}
+
+// Verify a closed file against its cached content hash
+// Returns: 1 if a modification was queued for publication
+static int verify_close_write(event_shard_t* shard, path_id_t dir, const char* name, uint16_t repository,
+                              const char* file_path, const struct stat* st, uint64_t received_ns) {
+    pthread_mutex_lock(&shard->lock);
+    path_id_t file = path_intern_child(&shard->paths, dir, name);
+    file_event_t* event = find_event(file, repository);
+    if (!event) {
+        // Opened for writing but never reported as modified - nothing to verify
+        pthread_mutex_unlock(&shard->lock);
+        return 0;
+    }
+    size_t index = (size_t)(event - shard->events);
+    int was_valid = event->hash_valid;
+    uint64_t old_hash = event->content_hash;
+    int unchanged_stat = was_valid && event->size == (int64_t)st->st_size &&
+                         event->mtime.tv_sec == st->st_mtim.tv_sec &&
+                         event->mtime.tv_nsec == st->st_mtim.tv_nsec;
+    event->modify_pending = 0;
+    pthread_mutex_unlock(&shard->lock);
+
+    // Same size and mtime as the hashed content - the write did not touch it
+    if (unchanged_stat) {
+        __atomic_fetch_add(&shard->suppressed, 1, __ATOMIC_RELAXED);
+        return 0;
+    }
+
+    // Read outside the lock; only this worker changes the event array
+    uint64_t hash = 0, bytes = 0;
+    int hashed = st->st_size <= INOTIFY_HASH_MAX_SIZE && hash_file_contents(file_path, &hash, &bytes) == 0;
+    if (hashed) {
+        __atomic_fetch_add(&shard->hashed, 1, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&shard->hashed_bytes, bytes, __ATOMIC_RELAXED);
+    }
+
+    int queued = 0;
+    pthread_mutex_lock(&shard->lock);
+    event = &shard->events[index];
+    event->hash_valid = (uint8_t)hashed;
+    event->content_hash = hash;
+    event->size = (int64_t)st->st_size;
+    event->mtime = st->st_mtim;
+    if (was_valid && (!hashed || hash != old_hash)) {
+        queued = report_modification(shard, file, repository, IN_MODIFY, received_ns);
+    } else if (was_valid) {
+        __atomic_fetch_add(&shard->suppressed, 1, __ATOMIC_RELAXED);
+    }
+    pthread_mutex_unlock(&shard->lock);
+    return queued;
+}
+
+// Apply one inotify record to the shard's tables
+// Returns: 1 if an event was queued for publication, 0 otherwise
+static int process_record(event_shard_t* shard, const inotify_record_t* record) {
+    // Only this worker modifies the shard, so it reads its own tables unlocked
+    watch_entry_t* watch = get_watch_from_wd(shard, record->wd);
+    if (!watch) return 0;
+
+    if (record->mask & (IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO)) {
+        // The directory mtime recorded for the snapshot is stale now; the main
+        // thread clears the flag when it saves the snapshot
+        pthread_mutex_lock(&shard->lock);
+        watch->entries_changed = 1;
+        pthread_mutex_unlock(&shard->lock);
+    }
+    if (record->name[0] == '\0') return 0;
+
+    // Copy the ids out; adding a watch below may move the array
+    path_id_t dir = watch->path;
+    uint16_t repository = watch->repository;
+
+    // Build full file path
+    char file_path[PATH_MAX];
+    size_t dir_len = path_build(&shard->paths, dir, PATH_ID_NONE, file_path, sizeof(file_path));
+    if (dir_len == 0 ||
+        snprintf(file_path + dir_len, sizeof(file_path) - dir_len, "/%s", record->name) >=
+            (int)(sizeof(file_path) - dir_len)) {
+        return 0;
+    }
+
+    struct stat st;
+    if (stat(file_path, &st) != 0) return 0;
+
+    if (S_ISREG(st.st_mode)) {
+        if (record->mask & IN_CLOSE_WRITE) {
+            return verify_close_write(shard, dir, record->name, repository, file_path, &st,
+                                      record->received_ns);
+        }
+        
+        // Regular file - track it
+        pthread_mutex_lock(&shard->lock);
+        path_id_t file = path_intern_child(&shard->paths, dir, record->name);
+        file_event_t* existing = find_event(file, repository);
+        int queued = 0;
+        if ((record->mask & IN_MODIFY) && existing && existing->hash_valid) {
+            // Known content - let the close-write decide whether anything changed
+            hold_modification(shard, existing, record->received_ns);
+        } else {
+            queued = report_modification(shard, file, repository, (int)record->mask, record->received_ns);
+        }
+        pthread_mutex_unlock(&shard->lock);
+        return queued;
+    }
+    if (S_ISDIR(st.st_mode) && (record->mask & IN_CREATE)) {
+        // New directory created - add watch to it
+        add_watch_recursive(file_path, repository);
+    }
+    return 0;
+}
+
+static void* shard_worker(void* arg) {
+    event_shard_t* shard = arg;
+    struct pollfd fds[2] = {
+        { .fd = shard->ring.wake_fd, .events = POLLIN },
+        { .fd = g_daemon_state->stop_fd, .events = POLLIN },
+    };
+    int backlog = 0;
+
+    for (;;) {
+        // Do not sleep while the ring still holds records from the last pass, and
+        // wake up periodically while modifications are held back
+        int timeout = backlog ? 0 : (shard->held_count > 0 ? 500 : -1);
+        if (poll(fds, 2, timeout) < 0) {
+            if (errno == EINTR) continue;
+            perror("poll");
+            break;
+        }
+        if (fds[1].revents) break;
+
+        inotify_ring_clear_wake(&shard->ring);
+
+        int queued = 0;
+        size_t processed = 0;
+        const inotify_record_t* record;
+        while (processed < INOTIFY_PROCESS_BATCH && (record = inotify_ring_peek(&shard->ring)) != NULL) {
+            queued |= process_record(shard, record);
+            inotify_ring_advance(&shard->ring);
+            processed++;
+        }
+        __atomic_fetch_add(&shard->records, processed, __ATOMIC_RELAXED);
+        if (shard->held_count > 0) {
+            queued |= release_held_modifications(shard);
+        }
+
+        // One main-thread wakeup per batch
+        if (queued) {
+            uint64_t one = 1;
+            ssize_t written = write(g_daemon_state->publish_fd, &one, sizeof(one));
+            (void)written;
+        }
+        backlog = inotify_ring_peek(&shard->ring) != NULL;
+    }
+    return NULL;
+}
+
+// Start one worker per shard
+// Returns: 0 on success, -1 on error
+int shards_start(void) {
+    // Signals stay with the main thread, which owns the select() loop
+    sigset_t all, old;
+    sigfillset(&all);
+    pthread_sigmask(SIG_SETMASK, &all, &old);
+
+    int result = 0;
+    for (size_t i = 0; i < g_daemon_state->shard_count; i++) {
+        event_shard_t* shard = &g_daemon_state->shards[i];
+        int rc = pthread_create(&shard->thread, NULL, shard_worker, shard);
+        if (rc != 0) {
+            fprintf(stderr, "pthread_create: %s\n", strerror(rc));
+            result = -1;
+            break;
+        }
+        shard->running = 1;
+    }
+
+    pthread_sigmask(SIG_SETMASK, &old, NULL);
+    return result;
+}
+
+// Stop and join the workers
+void shards_stop(void) {
+    if (!g_daemon_state || !g_daemon_state->shards) return;
+
+    uint64_t one = 1;
+    ssize_t written = write(g_daemon_state->stop_fd, &one, sizeof(one));
+    (void)written;
+
+    for (size_t i = 0; i < g_daemon_state->shard_count; i++) {
+        event_shard_t* shard = &g_daemon_state->shards[i];
+        if (shard->running) {
+            pthread_join(shard->thread, NULL);
+            shard->running = 0;
+        }
+    }
+}
+
+// Release the shards and the routing table; the workers must be stopped
+void shards_free(void) {
+    if (!g_daemon_state || !g_daemon_state->shards) return;
+
+    for (size_t i = 0; i < g_daemon_state->shard_count; i++) {
+        event_shard_t* shard = &g_daemon_state->shards[i];
+        free(shard->watches);
+        free(shard->events);
+        free(shard->changed);
+        free(shard->held);
+        path_table_free(&shard->paths);
+        inotify_ring_free(&shard->ring);
+        pthread_mutex_destroy(&shard->lock);
+    }
+    free(g_daemon_state->shards);
+    g_daemon_state->shards = NULL;
+    g_daemon_state->shard_count = 0;
+
+    for (size_t i = 0; i < ROUTE_CHUNKS; i++) {
+        free(g_routes[i]);
+        g_routes[i] = NULL;
+    }
+}
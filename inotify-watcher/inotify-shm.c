@@ -0,0 +1,272 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "inotify-shm.h"
+#include "inotify-protocol.h"
+
+#define SHM_READ_RETRIES 64
+
+// Total size of the mapped region
+static size_t shm_region_size(void) {
+    return sizeof(inotify_shm_header_t) +
+           INOTIFY_SHM_MAX_RECORDS * sizeof(inotify_shm_record_t) +
+           INOTIFY_SHM_STRING_AREA;
+}
+
+static inotify_shm_header_t* shm_header(const inotify_shm_t* shm) {
+    return (inotify_shm_header_t*)shm->base;
+}
+
+static inotify_shm_record_t* shm_records(const inotify_shm_t* shm) {
+    return (inotify_shm_record_t*)((char*)shm->base + sizeof(inotify_shm_header_t));
+}
+
+static char* shm_strings(const inotify_shm_t* shm) {
+    return (char*)shm_records(shm) + INOTIFY_SHM_MAX_RECORDS * sizeof(inotify_shm_record_t);
+}
+
+// Name of the region for the current user and working directory
+// Returns: 0 on success, -1 on error
+int inotify_shm_name(char* buffer, size_t size) {
+    uint32_t hash;
+    if (inotify_workspace_key(&hash) != 0) return -1;
+
+    int len = snprintf(buffer, size, "/repowatch-%u-%08x", (unsigned)getuid(), hash);
+    return (len < 0 || (size_t)len >= size) ? -1 : 0;
+}
+
+// Map an open region descriptor
+static int shm_map(inotify_shm_t* shm, int writable) {
+    shm->size = shm_region_size();
+    shm->base = mmap(NULL, shm->size, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, shm->fd, 0);
+    if (shm->base == MAP_FAILED) {
+        shm->base = NULL;
+        return -1;
+    }
+    shm->writable = writable;
+    return 0;
+}
+
+// Create (or replace) the region as its single writer
+// Returns: 0 on success, -1 on error
+int inotify_shm_create(inotify_shm_t* shm) {
+    memset(shm, 0, sizeof(*shm));
+    shm->fd = -1;
+
+    if (inotify_shm_name(shm->name, sizeof(shm->name)) != 0) return -1;
+
+    // A region left by a crashed daemon may still be mapped by readers; start fresh
+    shm_unlink(shm->name);
+
+    shm->fd = shm_open(shm->name, O_CREAT | O_EXCL | O_RDWR | O_CLOEXEC, 0600);
+    if (shm->fd < 0) {
+        perror("shm_open");
+        return -1;
+    }
+
+    if (ftruncate(shm->fd, (off_t)shm_region_size()) != 0 || shm_map(shm, 1) != 0) {
+        perror("shared memory snapshot");
+        close(shm->fd);
+        shm_unlink(shm->name);
+        shm->fd = -1;
+        return -1;
+    }
+
+    inotify_shm_header_t* header = shm_header(shm);
+    header->magic = INOTIFY_SHM_MAGIC;
+    header->version = INOTIFY_SHM_VERSION;
+    return 0;
+}
+
+// Start a publication; readers retry until inotify_shm_end_write()
+void inotify_shm_begin_write(inotify_shm_t* shm) {
+    if (!shm->base || !shm->writable) return;
+    inotify_shm_header_t* header = shm_header(shm);
+
+    uint64_t sequence = __atomic_load_n(&header->sequence, __ATOMIC_RELAXED);
+    __atomic_store_n(&header->sequence, sequence + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    header->record_count = 0;
+    header->string_bytes = 0;
+    header->truncated = 0;
+}
+
+// Copy a string into the string area
+// Returns: offset of the string, or UINT32_MAX if the area is full
+static uint32_t shm_append_string(inotify_shm_t* shm, const char* str) {
+    inotify_shm_header_t* header = shm_header(shm);
+    size_t len = strlen(str) + 1;
+    if (header->string_bytes + len > INOTIFY_SHM_STRING_AREA) return UINT32_MAX;
+
+    uint32_t offset = header->string_bytes;
+    memcpy(shm_strings(shm) + offset, str, len);
+    header->string_bytes += (uint32_t)len;
+    return offset;
+}
+
+// Add a record to the publication in progress
+// Returns: 0 on success, -1 once the region is full (marked truncated)
+int inotify_shm_append(inotify_shm_t* shm, uint32_t event_type, int64_t first_detected, int64_t last_updated,
+                       const char* repository, const char* path) {
+    if (!shm->base || !shm->writable) return -1;
+    inotify_shm_header_t* header = shm_header(shm);
+
+    if (header->record_count >= INOTIFY_SHM_MAX_RECORDS) {
+        header->truncated = 1;
+        return -1;
+    }
+
+    uint32_t string_mark = header->string_bytes;
+    uint32_t repository_offset = shm_append_string(shm, repository);
+    uint32_t path_offset = shm_append_string(shm, path);
+    if (repository_offset == UINT32_MAX || path_offset == UINT32_MAX) {
+        header->string_bytes = string_mark;
+        header->truncated = 1;
+        return -1;
+    }
+
+    inotify_shm_record_t* record = &shm_records(shm)[header->record_count++];
+    record->repository_offset = repository_offset;
+    record->path_offset = path_offset;
+    record->event_type = event_type;
+    record->reserved = 0;
+    record->first_detected = first_detected;
+    record->last_updated = last_updated;
+    return 0;
+}
+
+// Finish a publication
+void inotify_shm_end_write(inotify_shm_t* shm) {
+    if (!shm->base || !shm->writable) return;
+    inotify_shm_header_t* header = shm_header(shm);
+
+    header->published_at = (int64_t)time(NULL);
+    uint64_t sequence = __atomic_load_n(&header->sequence, __ATOMIC_RELAXED);
+    __atomic_store_n(&header->sequence, sequence + 1, __ATOMIC_RELEASE);
+}
+
+// Tell readers the region is dead, then remove it
+void inotify_shm_destroy(inotify_shm_t* shm) {
+    if (shm->base && shm->writable) {
+        inotify_shm_begin_write(shm);
+        shm_header(shm)->closed = 1;
+        inotify_shm_end_write(shm);
+        shm_unlink(shm->name);
+    }
+    inotify_shm_close(shm);
+}
+
+// Map the daemon's region read-only
+// Returns: 0 on success, -1 if the daemon does not publish one
+int inotify_shm_open_reader(inotify_shm_t* shm) {
+    memset(shm, 0, sizeof(*shm));
+    shm->fd = -1;
+
+    if (inotify_shm_name(shm->name, sizeof(shm->name)) != 0) return -1;
+
+    shm->fd = shm_open(shm->name, O_RDONLY | O_CLOEXEC, 0);
+    if (shm->fd < 0) return -1;
+
+    struct stat st;
+    if (fstat(shm->fd, &st) != 0 || (size_t)st.st_size < shm_region_size() || shm_map(shm, 0) != 0) {
+        inotify_shm_close(shm);
+        return -1;
+    }
+
+    inotify_shm_header_t* header = shm_header(shm);
+    if (header->magic != INOTIFY_SHM_MAGIC || header->version != INOTIFY_SHM_VERSION) {
+        inotify_shm_close(shm);
+        return -1;
+    }
+    return 0;
+}
+
+// Current generation; unchanged means the last snapshot is still current
+uint64_t inotify_shm_sequence(const inotify_shm_t* shm) {
+    if (!shm->base) return 0;
+    return __atomic_load_n(&shm_header(shm)->sequence, __ATOMIC_ACQUIRE);
+}
+
+// Whether the daemon has shut the region down
+int inotify_shm_is_closed(const inotify_shm_t* shm) {
+    if (!shm->base) return 1;
+    return __atomic_load_n(&shm_header(shm)->closed, __ATOMIC_RELAXED) != 0;
+}
+
+// Allocate snapshot buffers large enough for a full region
+int inotify_shm_snapshot_init(inotify_shm_snapshot_t* snapshot) {
+    memset(snapshot, 0, sizeof(*snapshot));
+    snapshot->records = malloc(INOTIFY_SHM_MAX_RECORDS * sizeof(inotify_shm_record_t));
+    snapshot->strings = malloc(INOTIFY_SHM_STRING_AREA);
+    if (!snapshot->records || !snapshot->strings) {
+        inotify_shm_snapshot_free(snapshot);
+        return -1;
+    }
+    return 0;
+}
+
+// Copy a consistent snapshot out of the region
+// Returns: 0 on success, -1 if no consistent copy could be taken
+int inotify_shm_read(const inotify_shm_t* shm, inotify_shm_snapshot_t* snapshot) {
+    if (!shm->base || !snapshot->records || !snapshot->strings) return -1;
+    const inotify_shm_header_t* header = shm_header(shm);
+
+    for (int attempt = 0; attempt < SHM_READ_RETRIES; attempt++) {
+        uint64_t start = __atomic_load_n(&header->sequence, __ATOMIC_ACQUIRE);
+        if (start & 1) continue; // Publication in progress
+
+        // Counts may be torn mid-write; clamp before copying
+        uint32_t record_count = header->record_count;
+        uint32_t string_bytes = header->string_bytes;
+        if (record_count > INOTIFY_SHM_MAX_RECORDS) record_count = INOTIFY_SHM_MAX_RECORDS;
+        if (string_bytes > INOTIFY_SHM_STRING_AREA) string_bytes = INOTIFY_SHM_STRING_AREA;
+
+        memcpy(snapshot->records, shm_records(shm), record_count * sizeof(inotify_shm_record_t));
+        memcpy(snapshot->strings, shm_strings(shm), string_bytes);
+        snapshot->published_at = header->published_at;
+        snapshot->truncated = header->truncated;
+
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&header->sequence, __ATOMIC_RELAXED) != start) continue;
+
+        // Reject offsets outside the copied strings so callers can use them directly
+        uint32_t valid = 0;
+        for (uint32_t i = 0; i < record_count; i++) {
+            const inotify_shm_record_t* record = &snapshot->records[i];
+            if (record->repository_offset >= string_bytes || record->path_offset >= string_bytes) continue;
+            snapshot->records[valid++] = *record;
+        }
+        if (string_bytes > 0) snapshot->strings[string_bytes - 1] = '\0';
+
+        snapshot->record_count = valid;
+        snapshot->sequence = start;
+        return 0;
+    }
+    return -1;
+}
+
+void inotify_shm_snapshot_free(inotify_shm_snapshot_t* snapshot) {
+    free(snapshot->records);
+    free(snapshot->strings);
+    snapshot->records = NULL;
+    snapshot->strings = NULL;
+    snapshot->record_count = 0;
+}
+
+// Unmap the region without removing it
+void inotify_shm_close(inotify_shm_t* shm) {
+    if (shm->base) {
+        munmap(shm->base, shm->size);
+        shm->base = NULL;
+    }
+    if (shm->fd >= 0) {
+        close(shm->fd);
+        shm->fd = -1;
+    }
+}
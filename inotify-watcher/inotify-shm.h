@@ -0,0 +1,85 @@
+#ifndef INOTIFY_SHM_H
+#define INOTIFY_SHM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Shared-memory snapshot of inotify-daemon's active files.
+//
+// The daemon owns a POSIX shared memory object named after the user and the
+// repoWatch root. It holds a header, a fixed array of records and a string
+// area the records point into. Every publication is bracketed by a seqlock:
+// the sequence is odd while the daemon writes, so readers copy the region
+// and retry if the sequence moved underneath them. Reading needs no
+// syscalls and no parsing.
+
+#define INOTIFY_SHM_MAGIC 0x52574953u  // "RWIS"
+#define INOTIFY_SHM_VERSION 1
+#define INOTIFY_SHM_MAX_RECORDS 4096
+#define INOTIFY_SHM_STRING_AREA (1024 * 1024)
+
+// Only events updated within this window are published
+#define INOTIFY_SHM_ACTIVE_WINDOW 30
+
+// One active file; strings are offsets into the string area
+typedef struct {
+    uint32_t repository_offset;
+    uint32_t path_offset;        // Relative to the repository root
+    uint32_t event_type;         // IN_* mask of the latest event
+    uint32_t reserved;
+    int64_t first_detected;
+    int64_t last_updated;
+} inotify_shm_record_t;
+
+// Region header, followed by the record array and the string area
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t sequence;           // Seqlock generation, odd while writing
+    int64_t published_at;
+    uint32_t record_count;
+    uint32_t string_bytes;
+    uint32_t truncated;          // More active files than records
+    uint32_t closed;             // Daemon shut down, reader should remap
+} inotify_shm_header_t;
+
+// Mapping of the region (either side)
+typedef struct {
+    int fd;
+    void* base;
+    size_t size;
+    int writable;
+    char name[64];
+} inotify_shm_t;
+
+// Consistent copy taken by a reader
+typedef struct {
+    uint64_t sequence;
+    int64_t published_at;
+    uint32_t record_count;
+    uint32_t truncated;
+    inotify_shm_record_t* records;  // INOTIFY_SHM_MAX_RECORDS entries
+    char* strings;                  // INOTIFY_SHM_STRING_AREA bytes
+} inotify_shm_snapshot_t;
+
+// Name of the region for the current user and working directory
+int inotify_shm_name(char* buffer, size_t size);
+
+// Writer side (inotify-daemon)
+int inotify_shm_create(inotify_shm_t* shm);
+void inotify_shm_begin_write(inotify_shm_t* shm);
+int inotify_shm_append(inotify_shm_t* shm, uint32_t event_type, int64_t first_detected, int64_t last_updated,
+                       const char* repository, const char* path);
+void inotify_shm_end_write(inotify_shm_t* shm);
+void inotify_shm_destroy(inotify_shm_t* shm);
+
+// Reader side (three-pane-tui)
+int inotify_shm_open_reader(inotify_shm_t* shm);
+uint64_t inotify_shm_sequence(const inotify_shm_t* shm);
+int inotify_shm_is_closed(const inotify_shm_t* shm);
+int inotify_shm_snapshot_init(inotify_shm_snapshot_t* snapshot);
+int inotify_shm_read(const inotify_shm_t* shm, inotify_shm_snapshot_t* snapshot);
+void inotify_shm_snapshot_free(inotify_shm_snapshot_t* snapshot);
+void inotify_shm_close(inotify_shm_t* shm);
+
+#endif // INOTIFY_SHM_H
@@ -0,0 +1,374 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "inotify-daemon.h"
+#include "inotify-protocol.h"
+
+// Make a file descriptor non-blocking
+static int set_nonblocking(int fd) {
+    int flags = fcntl(fd, F_GETFL, 0);
+    if (flags < 0) return -1;
+    return fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+}
+
+// Create the listening Unix domain socket clients subscribe to
+int subscribers_init(const char* socket_path) {
+    if (!g_daemon_state || !socket_path) return -1;
+
+    g_daemon_state->listen_fd = -1;
+
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(socket_path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "Socket path too long: %s\n", socket_path);
+        return -1;
+    }
+    strcpy(addr.sun_path, socket_path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        perror("socket");
+        return -1;
+    }
+
+    // Remove a stale socket left behind by a previous daemon
+    unlink(socket_path);
+
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0 ||
+        listen(fd, SUBSCRIBER_MAX_CLIENTS) != 0 ||
+        set_nonblocking(fd) != 0) {
+        perror("subscriber socket");
+        close(fd);
+        return -1;
+    }
+
+    g_daemon_state->listen_fd = fd;
+    return 0;
+}
+
+// Release a client's session reference
+static void subscriber_detach(subscriber_t* client) {
+    if (!client->attached) return;
+    client->attached = 0;
+    g_daemon_state->session_count--;
+    if (g_daemon_state->session_count == 0) {
+        g_daemon_state->idle_since = time(NULL);
+    }
+}
+
+// Drop a client and release its buffers
+static void subscriber_close(size_t index) {
+    subscriber_t* client = &g_daemon_state->clients[index];
+    subscriber_detach(client);
+    close(client->fd);
+    free(client->out_buf);
+    free(client->pending);
+
+    // Keep the client array dense
+    g_daemon_state->client_count--;
+    if (index != g_daemon_state->client_count) {
+        *client = g_daemon_state->clients[g_daemon_state->client_count];
+    }
+    memset(&g_daemon_state->clients[g_daemon_state->client_count], 0, sizeof(subscriber_t));
+}
+
+// Append a formatted record if it fits into the client's output buffer
+// Returns: 0 on success, -1 if the buffer is full
+static int subscriber_append(subscriber_t* client, const char* record, size_t len) {
+    if (client->out_len + len > SUBSCRIBER_BUFFER_SIZE) {
+        return -1;
+    }
+    memcpy(client->out_buf + client->out_len, record, len);
+    client->out_len += len;
+    return 0;
+}
+
+// Format a change record for an event reference
+static size_t format_change_record(char* buffer, size_t size, size_t ref) {
+    if (EVENT_REF_SHARD(ref) >= g_daemon_state->shard_count) return 0;
+    event_shard_t* shard = &g_daemon_state->shards[EVENT_REF_SHARD(ref)];
+    
+    // Copy the event out under the lock; its worker may be updating it
+    file_event_t event;
+    char path[PATH_MAX];
+    size_t path_len = 0;
+    pthread_mutex_lock(&shard->lock);
+    if (EVENT_REF_INDEX(ref) < shard->event_count) {
+        event = shard->events[EVENT_REF_INDEX(ref)];
+        path_len = event_relative_path(&event, path, sizeof(path));
+    }
+    pthread_mutex_unlock(&shard->lock);
+    if (path_len == 0) return 0;
+    
+    int len = snprintf(buffer, size, "%c\t%s\t%ld\t%ld\t%s\t%s\n",
+                       INOTIFY_RECORD_CHANGE, event_type_name(event.event_type),
+                       (long)event.first_detected, (long)event.last_updated,
+                       repository_name(event.repository), path);
+    if (len < 0 || (size_t)len >= size) return 0;
+    return (size_t)len;
+}
+
+// Append the change record for an event; records that cannot be formatted are skipped
+static int subscriber_append_event(subscriber_t* client, size_t event_ref) {
+    char record[INOTIFY_RECORD_MAX];
+    size_t len = format_change_record(record, sizeof(record), event_ref);
+    if (len == 0) return 0;
+    return subscriber_append(client, record, len);
+}
+
+// Queue an event for a client that is behind; repeated changes collapse into one record
+static void subscriber_defer(subscriber_t* client, size_t event_ref) {
+    for (size_t i = 0; i < client->pending_count; i++) {
+        if (client->pending[i] == event_ref) {
+            client->coalesced++;
+            return;
+        }
+    }
+
+    if (client->pending_count >= SUBSCRIBER_MAX_PENDING) {
+        // Too far behind to track individual changes - resend everything instead
+        client->coalesced += client->pending_count;
+        client->pending_count = 0;
+        client->needs_resync = 1;
+        client->lagging = 1;
+        return;
+    }
+
+    client->pending[client->pending_count++] = event_ref;
+    client->lagging = 1;
+}
+
+// Top up a client's output buffer from its snapshot cursor and pending changes
+static void subscriber_fill(subscriber_t* client) {
+    if (!client->subscribed) return;
+    char record[64];
+
+    if (client->needs_resync) {
+        int len = snprintf(record, sizeof(record), "%c\n", INOTIFY_RECORD_RESYNC);
+        if (subscriber_append(client, record, (size_t)len) != 0) return;
+        client->needs_resync = 0;
+        client->in_snapshot = 1;
+        client->snapshot_header_sent = 0;
+        client->snapshot_cursor = 0;
+    }
+
+    if (client->in_snapshot) {
+        if (!client->snapshot_header_sent) {
+            int len = snprintf(record, sizeof(record), "%c\t%zu\n",
+                               INOTIFY_RECORD_SNAPSHOT_BEGIN, event_total_count());
+            if (subscriber_append(client, record, (size_t)len) != 0) return;
+            client->snapshot_header_sent = 1;
+        }
+
+        // Events only ever get appended, so the cursor walks shard by shard
+        while ((client->snapshot_cursor = event_ref_next(client->snapshot_cursor)) != EVENT_REF_NONE) {
+            if (subscriber_append_event(client, client->snapshot_cursor) != 0) return;
+            client->snapshot_cursor++;
+        }
+
+        int len = snprintf(record, sizeof(record), "%c\n", INOTIFY_RECORD_SNAPSHOT_END);
+        if (subscriber_append(client, record, (size_t)len) != 0) return;
+        client->in_snapshot = 0;
+        client->snapshot_cursor = 0;
+    }
+
+    // Flush coalesced changes with their latest state
+    size_t sent = 0;
+    while (sent < client->pending_count) {
+        if (subscriber_append_event(client, client->pending[sent]) != 0) break;
+        sent++;
+    }
+    if (sent > 0) {
+        memmove(client->pending, client->pending + sent,
+                (client->pending_count - sent) * sizeof(size_t));
+        client->pending_count -= sent;
+    }
+
+    if (client->pending_count == 0) {
+        client->lagging = 0;
+    }
+}
+
+// Handle a command line received from a client
+static void subscriber_command(subscriber_t* client, const char* line) {
+    if (strcmp(line, INOTIFY_CMD_SUBSCRIBE) == 0 && !client->subscribed) {
+        char record[32];
+        int len = snprintf(record, sizeof(record), "%c\t%d\n", INOTIFY_RECORD_HELLO, INOTIFY_PROTOCOL_VERSION);
+        subscriber_append(client, record, (size_t)len);
+        client->subscribed = 1;
+        client->in_snapshot = 1;
+        client->snapshot_header_sent = 0;
+        client->snapshot_cursor = 0;
+        client->lagging = 1;
+        subscriber_fill(client);
+    } else if (strcmp(line, INOTIFY_CMD_ATTACH) == 0 && !client->attached) {
+        client->attached = 1;
+        g_daemon_state->session_count++;
+    } else if (strcmp(line, INOTIFY_CMD_DETACH) == 0) {
+        subscriber_detach(client);
+    } else if (strcmp(line, INOTIFY_CMD_STATS) == 0) {
+        static char stats[16384];
+        size_t len = metrics_format(stats, sizeof(stats));
+        if (len > 0) subscriber_append(client, stats, len);
+    }
+}
+
+// Read commands from a client
+// Returns: 0 to keep the client, -1 to drop it
+static int subscriber_read(subscriber_t* client) {
+    ssize_t n = read(client->fd, client->in_buf + client->in_len, sizeof(client->in_buf) - client->in_len - 1);
+    if (n == 0) return -1;
+    if (n < 0) return (errno == EAGAIN || errno == EINTR) ? 0 : -1;
+
+    client->in_len += (size_t)n;
+    client->in_buf[client->in_len] = '\0';
+
+    char* line = client->in_buf;
+    char* newline;
+    while ((newline = strchr(line, '\n')) != NULL) {
+        *newline = '\0';
+        subscriber_command(client, line);
+        line = newline + 1;
+    }
+
+    // Keep any partial command for the next read
+    size_t remaining = client->in_len - (size_t)(line - client->in_buf);
+    if (remaining >= sizeof(client->in_buf) - 1) {
+        return -1; // Command too long, not a well-behaved client
+    }
+    memmove(client->in_buf, line, remaining);
+    client->in_len = remaining;
+    return 0;
+}
+
+// Write as much buffered output as the socket accepts
+// Returns: 0 to keep the client, -1 to drop it
+static int subscriber_flush(subscriber_t* client) {
+    while (client->out_len > 0) {
+        ssize_t n = send(client->fd, client->out_buf, client->out_len, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+        }
+        memmove(client->out_buf, client->out_buf + n, client->out_len - (size_t)n);
+        client->out_len -= (size_t)n;
+
+        // Room freed up - catch the client up before the next send
+        if (client->lagging) subscriber_fill(client);
+    }
+    return 0;
+}
+
+// Accept pending connections
+static void subscribers_accept(void) {
+    for (;;) {
+        int fd = accept4(g_daemon_state->listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) return;
+
+        if (g_daemon_state->client_count >= SUBSCRIBER_MAX_CLIENTS) {
+            close(fd);
+            continue;
+        }
+
+        subscriber_t* client = &g_daemon_state->clients[g_daemon_state->client_count];
+        memset(client, 0, sizeof(*client));
+        client->fd = fd;
+        client->out_buf = malloc(SUBSCRIBER_BUFFER_SIZE);
+        client->pending = malloc(SUBSCRIBER_MAX_PENDING * sizeof(size_t));
+        if (!client->out_buf || !client->pending) {
+            free(client->out_buf);
+            free(client->pending);
+            close(fd);
+            continue;
+        }
+        g_daemon_state->client_count++;
+    }
+}
+
+// Register the listening socket and clients with select()
+// Returns: highest file descriptor added
+int subscribers_fill_fd_sets(fd_set* read_fds, fd_set* write_fds, int max_fd) {
+    if (!g_daemon_state || g_daemon_state->listen_fd < 0) return max_fd;
+
+    FD_SET(g_daemon_state->listen_fd, read_fds);
+    if (g_daemon_state->listen_fd > max_fd) max_fd = g_daemon_state->listen_fd;
+
+    for (size_t i = 0; i < g_daemon_state->client_count; i++) {
+        subscriber_t* client = &g_daemon_state->clients[i];
+        FD_SET(client->fd, read_fds);
+        if (client->out_len > 0) {
+            FD_SET(client->fd, write_fds);
+        }
+        if (client->fd > max_fd) max_fd = client->fd;
+    }
+    return max_fd;
+}
+
+// Service readable/writable clients after select()
+void subscribers_handle_io(fd_set* read_fds, fd_set* write_fds) {
+    if (!g_daemon_state || g_daemon_state->listen_fd < 0) return;
+
+    // Walk backwards so closing a client (which moves the last one into its slot) is safe
+    for (size_t i = g_daemon_state->client_count; i-- > 0;) {
+        subscriber_t* client = &g_daemon_state->clients[i];
+        int drop = 0;
+
+        if (FD_ISSET(client->fd, read_fds) && subscriber_read(client) != 0) {
+            drop = 1;
+        }
+        if (!drop && FD_ISSET(client->fd, write_fds) && subscriber_flush(client) != 0) {
+            drop = 1;
+        }
+
+        if (drop) {
+            subscriber_close(i);
+        }
+    }
+
+    if (FD_ISSET(g_daemon_state->listen_fd, read_fds)) {
+        subscribers_accept();
+    }
+}
+
+// Push a changed event to every subscriber
+void subscribers_publish(size_t event_ref) {
+    if (!g_daemon_state) return;
+
+    for (size_t i = 0; i < g_daemon_state->client_count; i++) {
+        subscriber_t* client = &g_daemon_state->clients[i];
+        if (!client->subscribed || client->needs_resync) continue;
+
+        if (client->in_snapshot && event_ref >= client->snapshot_cursor) {
+            // Not streamed yet - the snapshot will carry the latest state
+            continue;
+        }
+
+        if (client->lagging || subscriber_append_event(client, event_ref) != 0) {
+            subscriber_defer(client, event_ref);
+        }
+    }
+}
+
+// Close all clients and remove the socket file
+void subscribers_cleanup(const char* socket_path) {
+    if (!g_daemon_state) return;
+
+    while (g_daemon_state->client_count > 0) {
+        subscriber_close(g_daemon_state->client_count - 1);
+    }
+
+    if (g_daemon_state->listen_fd >= 0) {
+        close(g_daemon_state->listen_fd);
+        g_daemon_state->listen_fd = -1;
+        if (socket_path) unlink(socket_path);
+    }
+}
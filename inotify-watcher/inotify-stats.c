@@ -0,0 +1,228 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <limits.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "inotify-protocol.h"
+
+// inotify-stats - print the shared inotify-daemon's metrics
+//
+// Usage: inotify-stats [--raw] [--interval SECONDS]
+// Run from the repoWatch root (or its inotify-watcher directory) so the
+// workspace socket resolves to the daemon serving this checkout.
+
+#define STATS_MAX_METRICS 128
+#define STATS_BUFFER_SIZE 32768
+
+typedef struct {
+    char name[64];
+    char value[64];
+} metric_t;
+
+typedef struct {
+    metric_t items[STATS_MAX_METRICS];
+    size_t count;
+} metric_set_t;
+
+// Send STATS and read the reply up to the end marker
+// Returns: 0 on success, -1 on error
+static int fetch_stats(char* buffer, size_t size) {
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (inotify_socket_path(addr.sun_path, sizeof(addr.sun_path)) != 0) return -1;
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+    if (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+        fprintf(stderr, "inotify-stats: no daemon at %s: %s\n", addr.sun_path, strerror(errno));
+        close(fd);
+        return -1;
+    }
+
+    const char* command = INOTIFY_CMD_STATS "\n";
+    if (send(fd, command, strlen(command), MSG_NOSIGNAL) != (ssize_t)strlen(command)) {
+        close(fd);
+        return -1;
+    }
+
+    size_t len = 0;
+    const char end[] = { '\n', INOTIFY_RECORD_METRICS_END, '\n', '\0' };
+    for (;;) {
+        ssize_t n = read(fd, buffer + len, size - len - 1);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        len += (size_t)n;
+        buffer[len] = '\0';
+        if (strstr(buffer, end) || len + 1 >= size) break;
+    }
+    close(fd);
+    buffer[len] = '\0';
+    return strstr(buffer, end) ? 0 : -1;
+}
+
+// Split "M\t<name>\t<value>" lines
+static void parse_stats(char* buffer, metric_set_t* set) {
+    set->count = 0;
+    for (char* line = strtok(buffer, "\n"); line; line = strtok(NULL, "\n")) {
+        if (line[0] != INOTIFY_RECORD_METRIC || line[1] != '\t') continue;
+        char* name = line + 2;
+        char* value = strchr(name, '\t');
+        if (!value || set->count >= STATS_MAX_METRICS) continue;
+        *value++ = '\0';
+        metric_t* metric = &set->items[set->count++];
+        snprintf(metric->name, sizeof(metric->name), "%s", name);
+        snprintf(metric->value, sizeof(metric->value), "%s", value);
+    }
+}
+
+static const char* metric(const metric_set_t* set, const char* name) {
+    for (size_t i = 0; i < set->count; i++) {
+        if (strcmp(set->items[i].name, name) == 0) return set->items[i].value;
+    }
+    return NULL;
+}
+
+static double metric_number(const metric_set_t* set, const char* name) {
+    const char* value = metric(set, name);
+    return value ? strtod(value, NULL) : 0.0;
+}
+
+// Human readable byte count
+static const char* format_bytes(double bytes, char* buffer, size_t size) {
+    const char* units[] = { "B", "KiB", "MiB", "GiB" };
+    int unit = 0;
+    while (bytes >= 1024.0 && unit < 3) {
+        bytes /= 1024.0;
+        unit++;
+    }
+    snprintf(buffer, size, unit == 0 ? "%.0f %s" : "%.1f %s", bytes, units[unit]);
+    return buffer;
+}
+
+static void print_row(const char* label, const char* value) {
+    printf("  %-24s %s\n", label, value ? value : "-");
+}
+
+static void print_stats(const metric_set_t* set) {
+    char buffer[64];
+    static const char* kinds[] = { "modify", "close_write", "create", "delete", "moved_from", "moved_to", "other" };
+    static const char* buckets[][2] = {
+        { "le_100us", "<= 100us" }, { "le_1ms", "<= 1ms" }, { "le_10ms", "<= 10ms" },
+        { "le_100ms", "<= 100ms" }, { "le_1s", "<= 1s" }, { "gt_1s", "> 1s" },
+    };
+
+    printf("inotify-daemon, up %s s\n\n", metric(set, "uptime_seconds"));
+
+    printf("Events (rates over the last %s s)\n", metric(set, "events.rate_window_seconds"));
+    printf("  %-24s %12s %10s\n", "type", "total", "per sec");
+    for (size_t i = 0; i < sizeof(kinds) / sizeof(kinds[0]); i++) {
+        char name[64];
+        snprintf(name, sizeof(name), "events.%s.total", kinds[i]);
+        const char* total = metric(set, name);
+        snprintf(name, sizeof(name), "events.%s.per_second", kinds[i]);
+        printf("  %-24s %12s %10s\n", kinds[i], total ? total : "-", metric(set, name));
+    }
+
+    printf("\nKernel\n");
+    print_row("queue overflows", metric(set, "kernel.queue_overflows"));
+    print_row("queue peak", format_bytes(metric_number(set, "kernel.queue_max_bytes"), buffer, sizeof(buffer)));
+    print_row("reads", metric(set, "kernel.reads"));
+    print_row("ring full waits", metric(set, "kernel.ring_full_waits"));
+
+    printf("\nWatches\n");
+    if (metric(set, "watches.limit")) {
+        snprintf(buffer, sizeof(buffer), "%s of %s (%s%%)", metric(set, "watches.count"),
+                 metric(set, "watches.limit"), metric(set, "watches.limit_used_percent"));
+        print_row("in use", buffer);
+    } else {
+        print_row("in use", metric(set, "watches.count"));
+    }
+    if (metric(set, "watches.catchup_seconds")) {
+        snprintf(buffer, sizeof(buffer), "%s s caught up at warm start", metric(set, "watches.catchup_seconds"));
+        print_row("unwatched window", buffer);
+    }
+
+    printf("\nPipeline\n");
+    print_row("event table size", metric(set, "table.events"));
+    print_row("shards", metric(set, "table.shards"));
+    print_row("kernel records", metric(set, "pipeline.records"));
+    print_row("published changes", metric(set, "pipeline.published"));
+    snprintf(buffer, sizeof(buffer), "%s records per change", metric(set, "pipeline.coalescing_ratio"));
+    print_row("coalescing", buffer);
+    print_row("unchanged saves dropped", metric(set, "pipeline.suppressed"));
+    print_row("coalesced for clients", metric(set, "subscribers.coalesced"));
+    snprintf(buffer, sizeof(buffer), "%s clients, %s sessions", metric(set, "subscribers.clients"),
+             metric(set, "subscribers.sessions"));
+    print_row("subscribers", buffer);
+
+    printf("\nOutput\n");
+    char bytes[32];
+    snprintf(buffer, sizeof(buffer), "%s (%s)", metric(set, "output.report_writes"),
+             format_bytes(metric_number(set, "output.report_bytes"), bytes, sizeof(bytes)));
+    print_row("report writes", buffer);
+    print_row("shm publications", metric(set, "output.shm_publications"));
+
+    printf("\nLatency, kernel read to publication (%s changes, mean %s us, max %s us)\n",
+           metric(set, "latency.count"), metric(set, "latency.mean_us"), metric(set, "latency.max_us"));
+    double count = metric_number(set, "latency.count");
+    for (size_t i = 0; i < sizeof(buckets) / sizeof(buckets[0]); i++) {
+        char name[64];
+        snprintf(name, sizeof(name), "latency.%s", buckets[i][0]);
+        double value = metric_number(set, name);
+        int width = count > 0 ? (int)(40.0 * value / count + 0.5) : 0;
+        printf("  %-10s %10.0f  %.*s\n", buckets[i][1], value, width,
+               "########################################");
+    }
+
+    printf("\nMemory\n");
+    print_row("resident", format_bytes(metric_number(set, "memory.rss_bytes"), buffer, sizeof(buffer)));
+}
+
+int main(int argc, char* argv[]) {
+    int raw = 0;
+    int interval = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--raw") == 0) {
+            raw = 1;
+        } else if (strcmp(argv[i], "--interval") == 0 && i + 1 < argc) {
+            interval = atoi(argv[++i]);
+        } else {
+            fprintf(stderr, "Usage: %s [--raw] [--interval SECONDS]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    // The workspace is the repoWatch root, like the daemon's
+    char cwd[PATH_MAX];
+    if (getcwd(cwd, sizeof(cwd)) != NULL) {
+        const char* base = strrchr(cwd, '/');
+        if (base && strcmp(base + 1, "inotify-watcher") == 0 && chdir("..") != 0) {
+            perror("chdir");
+            return 1;
+        }
+    }
+
+    static char buffer[STATS_BUFFER_SIZE];
+    static metric_set_t set;
+    for (;;) {
+        if (fetch_stats(buffer, sizeof(buffer)) != 0) {
+            fprintf(stderr, "inotify-stats: failed to read metrics from inotify-daemon\n");
+            return 1;
+        }
+        if (raw) {
+            fputs(buffer, stdout);
+        } else {
+            if (interval > 0) printf("\033[H\033[2J");
+            parse_stats(buffer, &set);
+            print_stats(&set);
+        }
+        fflush(stdout);
+        if (interval <= 0) break;
+        sleep((unsigned)interval);
+    }
+    return 0;
+}
@@ -0,0 +1,212 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "inotify-daemon.h"
+
+// Event traces: the reader thread writes every routed kernel event with its
+// watch resolved to a repository-relative directory, so inotify-replay can
+// feed the same workload through the pipeline again without the kernel.
+
+typedef struct {
+    FILE* file;
+    uint64_t start_ns;
+    int active;                   // Set once the header is written; read by the reader thread
+} trace_recorder_t;
+
+static trace_recorder_t g_trace;
+
+// Directory of a watch relative to its repository root; needs the shard lock
+// Returns: length written, 0 if it does not fit
+static size_t watch_relative_dir(event_shard_t* shard, const watch_entry_t* watch, char* buffer, size_t size) {
+    path_id_t base = g_daemon_state->repositories[watch->repository].root_path;
+    if (watch->path == base) {
+        return (size_t)snprintf(buffer, size, ".");
+    }
+    return path_build(&shard->paths, watch->path, base, buffer, size);
+}
+
+// Names with separators cannot be represented in the line format
+static int trace_safe(const char* text) {
+    return strpbrk(text, "\t\n") == NULL;
+}
+
+// Start recording: write the repositories and the current watch set, then
+// let the reader thread append events
+// Returns: 0 on success, -1 on error
+int trace_record_start(const char* path) {
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        perror(path);
+        return -1;
+    }
+
+    fprintf(file, "%s\n", INOTIFY_TRACE_HEADER);
+    for (size_t i = 0; i < g_daemon_state->repository_count; i++) {
+        fprintf(file, "R\t%s\n", g_daemon_state->repositories[i].name);
+    }
+
+    char dir[PATH_MAX];
+    for (size_t s = 0; s < g_daemon_state->shard_count; s++) {
+        event_shard_t* shard = &g_daemon_state->shards[s];
+        pthread_mutex_lock(&shard->lock);
+        for (size_t i = 0; i < shard->watch_count; i++) {
+            watch_entry_t* watch = &shard->watches[i];
+            if (watch_relative_dir(shard, watch, dir, sizeof(dir)) == 0 || !trace_safe(dir)) continue;
+            fprintf(file, "D\t%u\t%s\n", (unsigned)watch->repository, dir);
+        }
+        pthread_mutex_unlock(&shard->lock);
+    }
+
+    g_trace.file = file;
+    g_trace.start_ns = monotonic_ns();
+    __atomic_store_n(&g_trace.active, 1, __ATOMIC_RELEASE);
+    return 0;
+}
+
+// Append one routed kernel event; called by the reader thread
+void trace_record_event(const struct inotify_event* event, uint64_t received_ns) {
+    if (!__atomic_load_n(&g_trace.active, __ATOMIC_ACQUIRE)) return;
+
+    int shard_index = shard_for_wd(event->wd);
+    if (shard_index < 0) return;
+    event_shard_t* shard = &g_daemon_state->shards[shard_index];
+
+    char dir[PATH_MAX];
+    size_t dir_len = 0;
+    uint16_t repository = 0;
+    pthread_mutex_lock(&shard->lock);
+    watch_entry_t* watch = get_watch_from_wd(shard, event->wd);
+    if (watch) {
+        dir_len = watch_relative_dir(shard, watch, dir, sizeof(dir));
+        repository = watch->repository;
+    }
+    pthread_mutex_unlock(&shard->lock);
+
+    const char* name = event->len > 0 ? event->name : "";
+    if (dir_len == 0 || !trace_safe(dir) || !trace_safe(name)) return;
+
+    uint64_t offset_us = received_ns > g_trace.start_ns ? (received_ns - g_trace.start_ns) / 1000 : 0;
+    fprintf(g_trace.file, "E\t%llu\t%x\t%u\t%s\t%s\n", (unsigned long long)offset_us,
+            (unsigned)event->mask, (unsigned)repository, dir, name);
+}
+
+// Stop recording; the reader thread must be stopped
+void trace_record_stop(void) {
+    if (!g_trace.file) return;
+    __atomic_store_n(&g_trace.active, 0, __ATOMIC_RELEASE);
+    fclose(g_trace.file);
+    g_trace.file = NULL;
+}
+
+// Make room for one more element; capacity is 64, then doubles whenever count reaches it
+static void* grow(void* array, size_t count, size_t element_size) {
+    if (count != 0 && (count < 64 || (count & (count - 1)) != 0)) return array; // Still has room
+    size_t capacity = count == 0 ? 64 : count * 2;
+    return realloc(array, capacity * element_size);
+}
+
+// Split a line on tabs in place
+// Returns: number of fields
+static size_t split_fields(char* line, char** fields, size_t max_fields) {
+    size_t count = 0;
+    fields[count++] = line;
+    for (char* p = line; *p && count < max_fields; p++) {
+        if (*p == '\t') {
+            *p = '\0';
+            fields[count++] = p + 1;
+        }
+    }
+    return count;
+}
+
+// Load a trace into memory
+// Returns: 0 on success, -1 on error
+int trace_load(const char* path, trace_t* trace) {
+    memset(trace, 0, sizeof(*trace));
+
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        perror(path);
+        return -1;
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    trace->data = size >= 0 ? malloc((size_t)size + 1) : NULL;
+    if (!trace->data || fread(trace->data, 1, (size_t)size, file) != (size_t)size) {
+        fclose(file);
+        trace_free(trace);
+        return -1;
+    }
+    fclose(file);
+    trace->data[size] = '\0';
+
+    size_t header_len = strlen(INOTIFY_TRACE_HEADER);
+    if (strncmp(trace->data, INOTIFY_TRACE_HEADER, header_len) != 0 || trace->data[header_len] != '\n') {
+        fprintf(stderr, "%s: not an inotify trace\n", path);
+        trace_free(trace);
+        return -1;
+    }
+
+    size_t line_number = 1;
+    char* line = trace->data + header_len + 1;
+    while (*line) {
+        char* end = strchr(line, '\n');
+        if (end) *end = '\0';
+        line_number++;
+
+        char* fields[6];
+        size_t count = split_fields(line, fields, 6);
+        int valid = 1;
+        if (line[0] == 'R' && count == 2) {
+            const char** repositories = grow(trace->repositories, trace->repository_count, sizeof(char*));
+            if (!repositories) valid = 0;
+            else {
+                trace->repositories = repositories;
+                trace->repositories[trace->repository_count++] = fields[1];
+            }
+        } else if (line[0] == 'D' && count == 3) {
+            unsigned long repository = strtoul(fields[1], NULL, 10);
+            trace_dir_t* dirs = grow(trace->dirs, trace->dir_count, sizeof(trace_dir_t));
+            if (!dirs || repository >= trace->repository_count) valid = 0;
+            else {
+                trace->dirs = dirs;
+                trace->dirs[trace->dir_count].repository = (uint16_t)repository;
+                trace->dirs[trace->dir_count].dir = fields[2];
+                trace->dir_count++;
+            }
+        } else if (line[0] == 'E' && count == 6) {
+            unsigned long repository = strtoul(fields[3], NULL, 10);
+            trace_event_t* events = grow(trace->events, trace->event_count, sizeof(trace_event_t));
+            if (!events || repository >= trace->repository_count) valid = 0;
+            else {
+                trace->events = events;
+                trace_event_t* event = &trace->events[trace->event_count++];
+                event->offset_us = strtoull(fields[1], NULL, 10);
+                event->mask = (uint32_t)strtoul(fields[2], NULL, 16);
+                event->repository = (uint16_t)repository;
+                event->dir = fields[4];
+                event->name = fields[5];
+            }
+        } else if (line[0] != '#' && line[0] != '\0') {
+            valid = 0;
+        }
+
+        if (!valid) {
+            fprintf(stderr, "%s:%zu: malformed trace record\n", path, line_number);
+            trace_free(trace);
+            return -1;
+        }
+        if (!end) break;
+        line = end + 1;
+    }
+    return 0;
+}
+
+void trace_free(trace_t* trace) {
+    free(trace->data);
+    free(trace->repositories);
+    free(trace->dirs);
+    free(trace->events);
+    memset(trace, 0, sizeof(*trace));
+}
@@ -0,0 +1,64 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <limits.h>
+#include <sys/stat.h>
+#include "inotify-protocol.h"
+
+// Hash of the canonical repoWatch root (the current working directory)
+// Returns: 0 on success, -1 on error
+int inotify_workspace_key(uint32_t* key) {
+    char root[PATH_MAX];
+    if (!key || !realpath(".", root)) return -1;
+
+    // FNV-1a keeps separate workspaces apart
+    uint32_t hash = 2166136261u;
+    for (const char* p = root; *p; p++) {
+        hash ^= (unsigned char)*p;
+        hash *= 16777619u;
+    }
+    *key = hash;
+    return 0;
+}
+
+// Private per-user runtime directory, created on first use
+static int runtime_dir(char* buffer, size_t size) {
+    const char* xdg_runtime = getenv("XDG_RUNTIME_DIR");
+    int len;
+    if (xdg_runtime && xdg_runtime[0] == '/') {
+        len = snprintf(buffer, size, "%s/repowatch", xdg_runtime);
+    } else {
+        len = snprintf(buffer, size, "/tmp/repowatch-%u", (unsigned)getuid());
+    }
+    if (len < 0 || (size_t)len >= size) return -1;
+
+    if (mkdir(buffer, 0700) != 0) {
+        struct stat st;
+        // Refuse a directory another user could have planted
+        if (stat(buffer, &st) != 0 || !S_ISDIR(st.st_mode) || st.st_uid != getuid()) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// Build <runtime dir>/<workspace key><suffix>
+static int workspace_file(char* buffer, size_t size, const char* suffix) {
+    char dir[PATH_MAX];
+    uint32_t key;
+    if (runtime_dir(dir, sizeof(dir)) != 0 || inotify_workspace_key(&key) != 0) return -1;
+
+    int len = snprintf(buffer, size, "%s/%08x%s", dir, key, suffix);
+    return (len < 0 || (size_t)len >= size) ? -1 : 0;
+}
+
+// Socket every session of this workspace connects to
+int inotify_socket_path(char* buffer, size_t size) {
+    return workspace_file(buffer, size, ".sock");
+}
+
+// Lock file held by the daemon that owns the socket
+int inotify_lock_path(char* buffer, size_t size) {
+    return workspace_file(buffer, size, ".lock");
+}
@@ -1,6 +1,13 @@
+#define _GNU_SOURCE // pipe2()
 #include "json-utils.h"
 #include <unistd.h>
 #include <fcntl.h>
+#include <errno.h>
+#include <signal.h>
+#include <spawn.h>
+#include <sys/wait.h>
+
+extern char** environ;
 
 // Skip whitespace
 static const char* skip_whitespace(const char* str) {
@@ -1095,3 +1102,53 @@ int state_update_section(const char* state_file_path, const char* section_name,
 
     return result;
 }
+
+// Start a shell command with its stdout readable from the returned stream,
+// like popen(command, "r"), except that the child starts with no signals
+// blocked and default dispositions whatever the calling thread blocks, so
+// Ctrl+C and SIGTERM reach it
+// Returns: the stream (*pid set), or NULL on error
+FILE* command_open(const char* command, pid_t* pid) {
+    int fds[2];
+    if (pipe2(fds, O_CLOEXEC) != 0) return NULL;
+
+    posix_spawn_file_actions_t actions;
+    posix_spawnattr_t attr;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, fds[1], STDOUT_FILENO);
+    posix_spawnattr_init(&attr);
+    sigset_t none, all;
+    sigemptyset(&none);
+    sigfillset(&all);
+    posix_spawnattr_setsigmask(&attr, &none);
+    posix_spawnattr_setsigdefault(&attr, &all);
+    posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETSIGDEF);
+
+    char* argv[] = { "sh", "-c", (char*)command, NULL };
+    int rc = posix_spawn(pid, "/bin/sh", &actions, &attr, argv, environ);
+    posix_spawn_file_actions_destroy(&actions);
+    posix_spawnattr_destroy(&attr);
+    close(fds[1]);
+    if (rc != 0) {
+        close(fds[0]);
+        return NULL;
+    }
+
+    FILE* fp = fdopen(fds[0], "r");
+    if (!fp) {
+        close(fds[0]);
+        waitpid(*pid, NULL, 0);
+    }
+    return fp;
+}
+
+// Close a command_open() stream and wait for the command
+// Returns: its wait status, -1 on error
+int command_close(FILE* fp, pid_t pid) {
+    fclose(fp);
+    int status;
+    while (waitpid(pid, &status, 0) < 0) {
+        if (errno != EINTR) return -1;
+    }
+    return status;
+}
@@ -5,6 +5,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#include <sys/types.h>
 
 // JSON value types
 typedef enum {
@@ -124,4 +125,9 @@ json_value_t* state_get_section(json_value_t* state, const char* section_name);
 int state_update_section(const char* state_file_path, const char* section_name, json_value_t* section_data);
 const char* state_get_default_path(void);
 
+// Child processes: popen()/pclose() for a shell command, with the child's
+// signal mask and dispositions reset to the defaults
+FILE* command_open(const char* command, pid_t* pid);
+int command_close(FILE* fp, pid_t pid);
+
 #endif // JSON_UTILS_H
@@ -18,25 +18,32 @@ animation_state_t* create_animation_state(const char* filepath, animation_type_t
     time_t now = time(NULL);
     anim->start_time = now;
     anim->end_time = now + 30;  // 30 second duration
+    clock_gettime(CLOCK_MONOTONIC, &anim->started);
     anim->scroll_position = 0;
     anim->pane_width = pane_width;
 
     return anim;
 }
 
-// Update animation state (advance scroll position, etc.)
-void update_animation_state(animation_state_t* anim, int pane_width, time_t now) {
-    if (!anim) return;
+// Update animation state for the current time: scroll animations advance one
+// column per frame at fps, counted from when they started, so frames that were
+// late or skipped are caught up rather than slowing the marquee down
+// Returns: 1 if the animation moved or the pane width changed
+int update_animation_state(animation_state_t* anim, int pane_width, const struct timespec* now, int fps) {
+    if (!anim) return 0;
 
     // Update pane width in case it changed
+    int changed = anim->pane_width != pane_width;
     anim->pane_width = pane_width;
 
-    // For scroll animations, advance the scroll position
     if (anim->type == ANIM_SCROLL_LEFT_RIGHT) {
-        // Increment scroll position by 1 character per frame
-        // This will create the scrolling effect when used in the render function
-        anim->scroll_position++;
+        int64_t elapsed_ms = (int64_t)(now->tv_sec - anim->started.tv_sec) * 1000 +
+                             (now->tv_nsec - anim->started.tv_nsec) / 1000000;
+        int position = elapsed_ms > 0 ? (int)(elapsed_ms * fps / 1000) : 0;
+        if (position != anim->scroll_position) changed = 1;
+        anim->scroll_position = position;
     }
+    return changed;
 }
 
 // Render scrolling left-to-right animation (Pac-Man style loop)
@@ -62,25 +69,36 @@ void render_scroll_left_right(animation_state_t* anim, int row, int start_col, i
     }
 
     // Move cursor to the row
-    move_cursor(row, start_col + 1); // +1 for left padding
-
-    // Render the visible portion of the text
-    int pane_start_col = 0;
-    int pane_end_col = available_width - 1;
-
-    for (int pane_col = pane_start_col; pane_col <= pane_end_col; pane_col++) {
-        int text_pos = pane_col - display_start;
+    screen_move(row, start_col + 1); // +1 for left padding
 
-        if (text_pos >= 0 && text_pos < text_width) {
-            // Get the character at this position in the filepath
-            // For simplicity, we'll use byte indexing (not perfect for UTF-8 but works for ASCII filenames)
-            if (text_pos < (int)strlen(anim->filepath)) {
-                putchar(anim->filepath[text_pos]);
+    // Walk the glyphs by column: those entirely inside the pane are drawn,
+    // the rest of the pane is padded, so wide glyphs never split
+    const char* text = anim->filepath;
+    size_t len = strlen(text);
+    int pane_col = 0;
+    int text_col = display_start;
+    int after_joiner = 0;
+    for (size_t i = 0; i < len && text_col < available_width; ) {
+        uint32_t cp;
+        size_t n = utf8_decode(text + i, len - i, &cp);
+        int glyph = glyph_width(cp, &after_joiner);
+        if (glyph > 0 && text_col >= 0 && text_col + glyph <= available_width) {
+            while (pane_col < text_col) {
+                screen_putc(' ');
+                pane_col++;
             }
-        } else {
-            // Space padding
-            putchar(' ');
+            char bytes[5];
+            memcpy(bytes, text + i, n);
+            bytes[n] = '\0';
+            screen_puts(bytes);
+            pane_col += glyph;
         }
+        text_col += glyph;
+        i += n;
+    }
+    while (pane_col < available_width) {
+        screen_putc(' ');
+        pane_col++;
     }
 }
 
@@ -98,3 +116,230 @@ void cleanup_animation_state(animation_state_t* anim) {
     free(anim);
 }
 
+
+#define ANIMATION_SET_INITIAL_SIZE 64
+#define PATH_SET_INITIAL_SIZE 64
+
+static size_t hash_path(const char* path) {
+    size_t hash = 1469598103934665603ULL;
+    for (const unsigned char* p = (const unsigned char*)path; *p; p++) {
+        hash ^= *p;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+// Find an animation by path
+// Returns: the animation, or NULL if the path has none
+animation_state_t* animation_set_find(const animation_set_t* set, const char* filepath) {
+    if (!set || !filepath || set->index_size == 0) return NULL;
+
+    size_t hash = hash_path(filepath);
+    size_t mask = set->index_size - 1;
+    for (size_t slot = hash & mask; set->index[slot]; slot = (slot + 1) & mask) {
+        animation_state_t* anim = set->index[slot];
+        if (anim->path_hash == hash && strcmp(anim->filepath, filepath) == 0) return anim;
+    }
+    return NULL;
+}
+
+// Rebuild the index at twice its size once it is half full
+static int animation_set_grow_index(animation_set_t* set) {
+    size_t new_size = set->index_size ? set->index_size * 2 : ANIMATION_SET_INITIAL_SIZE;
+    animation_state_t** new_index = calloc(new_size, sizeof(animation_state_t*));
+    if (!new_index) return -1;
+
+    for (size_t i = 0; i < set->index_size; i++) {
+        animation_state_t* anim = set->index[i];
+        if (!anim) continue;
+        size_t slot = anim->path_hash & (new_size - 1);
+        while (new_index[slot]) slot = (slot + 1) & (new_size - 1);
+        new_index[slot] = anim;
+    }
+
+    free(set->index);
+    set->index = new_index;
+    set->index_size = new_size;
+    return 0;
+}
+
+// Remove an animation from the index, shifting later entries of its probe
+// run back so lookups never stop at the hole
+static void animation_set_unindex(animation_set_t* set, animation_state_t* anim) {
+    size_t mask = set->index_size - 1;
+    size_t hole = anim->path_hash & mask;
+    while (set->index[hole] != anim) hole = (hole + 1) & mask;
+
+    for (size_t slot = (hole + 1) & mask; set->index[slot]; slot = (slot + 1) & mask) {
+        size_t home = set->index[slot]->path_hash & mask;
+        // The entry may fill the hole unless its home lies between the two
+        if (((slot - home) & mask) >= ((slot - hole) & mask)) {
+            set->index[hole] = set->index[slot];
+            hole = slot;
+        }
+    }
+    set->index[hole] = NULL;
+}
+
+static void wheel_link(animation_set_t* set, animation_state_t* anim) {
+    // Anything already due goes in the next slot the wheel will visit
+    time_t due = anim->end_time > set->wheel_time ? anim->end_time : set->wheel_time + 1;
+    animation_state_t** head = &set->wheel[(uint64_t)due % ANIMATION_WHEEL_SLOTS];
+    anim->wheel_prev = NULL;
+    anim->wheel_next = *head;
+    if (*head) (*head)->wheel_prev = anim;
+    *head = anim;
+}
+
+static void wheel_unlink(animation_set_t* set, animation_state_t* anim) {
+    if (anim->wheel_prev) {
+        anim->wheel_prev->wheel_next = anim->wheel_next;
+    } else {
+        for (size_t i = 0; i < ANIMATION_WHEEL_SLOTS; i++) {
+            if (set->wheel[i] == anim) {
+                set->wheel[i] = anim->wheel_next;
+                break;
+            }
+        }
+    }
+    if (anim->wheel_next) anim->wheel_next->wheel_prev = anim->wheel_prev;
+    anim->wheel_prev = NULL;
+    anim->wheel_next = NULL;
+}
+
+// Add an animation; the set takes ownership of it
+// Returns: 0 on success, -1 on allocation failure (the caller keeps it)
+int animation_set_add(animation_set_t* set, animation_state_t* anim) {
+    if (!set || !anim || !anim->filepath) return -1;
+
+    if ((set->count + 1) * 2 > set->index_size && animation_set_grow_index(set) != 0) return -1;
+    if (set->count == set->order_capacity) {
+        size_t new_capacity = set->order_capacity ? set->order_capacity * 2 : ANIMATION_SET_INITIAL_SIZE;
+        animation_state_t** new_order = realloc(set->order, new_capacity * sizeof(animation_state_t*));
+        if (!new_order) return -1;
+        set->order = new_order;
+        set->order_capacity = new_capacity;
+    }
+
+    anim->path_hash = hash_path(anim->filepath);
+    size_t mask = set->index_size - 1;
+    size_t slot = anim->path_hash & mask;
+    while (set->index[slot]) slot = (slot + 1) & mask;
+    set->index[slot] = anim;
+
+    anim->order_index = set->count;
+    set->order[set->count++] = anim;
+    wheel_link(set, anim);
+    return 0;
+}
+
+// Move an animation's expiry, e.g. when its file changed again
+void animation_set_reschedule(animation_set_t* set, animation_state_t* anim, time_t end_time) {
+    if (!set || !anim || anim->end_time == end_time) return;
+
+    wheel_unlink(set, anim);
+    anim->end_time = end_time;
+    wheel_link(set, anim);
+}
+
+// Drop the animations that have expired by now; only the wheel slots for the
+// seconds since the last call are visited
+// Returns: number of animations removed
+size_t animation_set_expire(animation_set_t* set, time_t now) {
+    if (!set || now <= set->wheel_time) return 0;
+
+    // A gap of a full lap or more visits every slot once
+    time_t first = now - set->wheel_time >= ANIMATION_WHEEL_SLOTS ? now - ANIMATION_WHEEL_SLOTS + 1
+                                                                  : set->wheel_time + 1;
+    size_t removed = 0;
+    for (time_t second = first; second <= now; second++) {
+        animation_state_t* anim = set->wheel[(uint64_t)second % ANIMATION_WHEEL_SLOTS];
+        while (anim) {
+            animation_state_t* next = anim->wheel_next;
+            if (is_animation_expired(anim, now)) {
+                wheel_unlink(set, anim);
+                animation_set_unindex(set, anim);
+                set->order[anim->order_index] = NULL;
+                cleanup_animation_state(anim);
+                removed++;
+            }
+            anim = next;
+        }
+    }
+    set->wheel_time = now;
+
+    // Close the gaps in one pass, keeping arrival order
+    if (removed > 0) {
+        size_t write_idx = 0;
+        for (size_t i = 0; i < set->count; i++) {
+            animation_state_t* anim = set->order[i];
+            if (!anim) continue;
+            anim->order_index = write_idx;
+            set->order[write_idx++] = anim;
+        }
+        set->count = write_idx;
+    }
+    return removed;
+}
+
+// Free every animation in the set
+void animation_set_free(animation_set_t* set) {
+    if (!set) return;
+
+    for (size_t i = 0; i < set->count; i++) {
+        cleanup_animation_state(set->order[i]);
+    }
+    free(set->order);
+    free(set->index);
+    memset(set, 0, sizeof(*set));
+}
+
+// Add a path to the set
+// Returns: 0 on success (including if it was already present), -1 on error
+int path_set_add(path_set_t* set, const char* path) {
+    if (!set || !path) return -1;
+    if (path_set_contains(set, path)) return 0;
+
+    if ((set->count + 1) * 2 > set->size) {
+        size_t new_size = set->size ? set->size * 2 : PATH_SET_INITIAL_SIZE;
+        char** new_slots = calloc(new_size, sizeof(char*));
+        if (!new_slots) return -1;
+        for (size_t i = 0; i < set->size; i++) {
+            if (!set->slots[i]) continue;
+            size_t slot = hash_path(set->slots[i]) & (new_size - 1);
+            while (new_slots[slot]) slot = (slot + 1) & (new_size - 1);
+            new_slots[slot] = set->slots[i];
+        }
+        free(set->slots);
+        set->slots = new_slots;
+        set->size = new_size;
+    }
+
+    char* copy = strdup(path);
+    if (!copy) return -1;
+    size_t slot = hash_path(path) & (set->size - 1);
+    while (set->slots[slot]) slot = (slot + 1) & (set->size - 1);
+    set->slots[slot] = copy;
+    set->count++;
+    return 0;
+}
+
+// Returns: 1 if the path is in the set, 0 otherwise
+int path_set_contains(const path_set_t* set, const char* path) {
+    if (!set || !path || set->size == 0) return 0;
+
+    for (size_t slot = hash_path(path) & (set->size - 1); set->slots[slot]; slot = (slot + 1) & (set->size - 1)) {
+        if (strcmp(set->slots[slot], path) == 0) return 1;
+    }
+    return 0;
+}
+
+void path_set_free(path_set_t* set) {
+    if (!set) return;
+
+    for (size_t i = 0; i < set->size; i++) {
+        free(set->slots[i]);
+    }
+    free(set->slots);
+    memset(set, 0, sizeof(*set));
+}
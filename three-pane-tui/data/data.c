@@ -1,13 +1,5 @@
 #include "../three-pane-tui.h"
 
-// Tree node structure for hierarchical display
-typedef struct tree_node {
-    char* name;
-    struct tree_node** children;
-    size_t child_count;
-    int is_file;
-} tree_node_t;
-
 // Helper function to check if a filename is a known submodule
 static int is_submodule(const char* filename, char** submodules, size_t submodule_count) {
     if (!filename || !submodules) return 0;
@@ -19,729 +11,565 @@ static int is_submodule(const char* filename, char** submodules, size_t submodul
     return 0;
 }
 
-// Cleanup tree node recursively
-static void cleanup_tree_node(tree_node_t* node) {
-    if (!node) return;
+#define PANE_ARENA_CHUNK_SIZE 65536
+#define PANE_ROWS_INITIAL_CAPACITY 64
+#define PANE_TREES_GROWTH 16
+
+// Copy text into the arena
+// Returns: the copy, or NULL on allocation failure
+const char* pane_arena_strdup(pane_arena_t* arena, const char* text) {
+    size_t size = strlen(text) + 1;
+    if (arena->chunk_count == 0 || arena->used + size > PANE_ARENA_CHUNK_SIZE) {
+        char** chunks = realloc(arena->chunks, (arena->chunk_count + 1) * sizeof(char*));
+        if (!chunks) return NULL;
+        arena->chunks = chunks;
+        char* chunk = malloc(size > PANE_ARENA_CHUNK_SIZE ? size : PANE_ARENA_CHUNK_SIZE);
+        if (!chunk) return NULL;
+        arena->chunks[arena->chunk_count++] = chunk;
+        arena->used = 0;
+    }
+    char* copy = arena->chunks[arena->chunk_count - 1] + arena->used;
+    memcpy(copy, text, size);
+    arena->used += size;
+    return copy;
+}
 
-    for (size_t i = 0; i < node->child_count; i++) {
-        cleanup_tree_node(node->children[i]);
+void pane_arena_free(pane_arena_t* arena) {
+    for (size_t i = 0; i < arena->chunk_count; i++) {
+        free(arena->chunks[i]);
     }
+    free(arena->chunks);
+    memset(arena, 0, sizeof(*arena));
+}
 
-    free(node->children);
-    free(node->name);
-    free(node);
+// Append one row; colors are filled in by finish_pane_rows()
+static void append_pane_row(pane_rows_t* pane, const char* text, pane_row_kind_t kind) {
+    if (pane->count == pane->capacity) {
+        size_t capacity = pane->capacity ? pane->capacity * 2 : PANE_ROWS_INITIAL_CAPACITY;
+        pane_row_t* rows = realloc(pane->rows, capacity * sizeof(pane_row_t));
+        if (!rows) return;
+        pane->rows = rows;
+        pane->capacity = capacity;
+    }
+    const char* copy = pane_arena_strdup(&pane->arena, text);
+    if (!copy) return;
+
+    pane_row_t* row = &pane->rows[pane->count++];
+    memset(row, 0, sizeof(*row));
+    row->text = copy;
+    row->byte_mask = pane_filter_byte_mask(copy);
+    row->display_width = get_string_display_width(copy);
+    row->kind = (uint8_t)kind;
 }
 
-// Build file tree from flat file paths
-static tree_node_t* build_file_tree(char** files, size_t file_count) {
-    tree_node_t* root = calloc(1, sizeof(tree_node_t));
-    if (!root) return NULL;
+// Assign alternating repository colors (1-8, advancing at each header) and the
+// color each row is drawn in; TREE view rows get theirs in pane_row_at()
+static void finish_pane_rows(pane_rows_t* pane, const style_config_t* styles) {
+    if (pane->tree_count > 0) return;
+
+    int current_repo_color = 0;
+    for (size_t i = 0; i < pane->count; i++) {
+        pane_row_t* row = &pane->rows[i];
+        if (row->kind == PANE_ROW_HEADER) {
+            current_repo_color++;
+            if (current_repo_color > 8) current_repo_color = 1;
+        }
+        row->repo_color = (uint8_t)current_repo_color;
+        row->color = (uint8_t)(current_repo_color ? color_index_to_ansi(current_repo_color)
+                                                  : get_file_color(row->text, styles));
+    }
+}
 
-    root->name = strdup("/");
-    root->is_file = 0;
+static void free_pane_rows(pane_rows_t* pane) {
+    for (size_t i = 0; i < pane->tree_count; i++) {
+        tree_release(pane->trees[i].root);
+    }
+    free(pane->trees);
+    free(pane->candidates);
+    pane_arena_free(&pane->arena);
+    free(pane->rows);
+}
 
-    for (size_t i = 0; i < file_count; i++) {
-        const char* path = files[i];
-        tree_node_t* current = root;
+// Header name for a repository: the last component of its path, else its name
+static const char* repo_display_name(const char* name, const char* path) {
+    const char* repo_name_from_path = path ? strrchr(path, '/') : NULL;
+    if (repo_name_from_path && repo_name_from_path[1]) {
+        return repo_name_from_path + 1;
+    }
+    return name ? name : "unknown";
+}
 
-        // Skip leading slash
-        if (path[0] == '/') path++;
+// Append a "Repository: X" header
+static void append_repo_header(pane_rows_t* pane, const char* name, const char* path) {
+    char header_buffer[512];
+    snprintf(header_buffer, sizeof(header_buffer), "Repository: %s", repo_display_name(name, path));
+    append_pane_row(pane, header_buffer, PANE_ROW_HEADER);
+}
 
-        char* path_copy = strdup(path);
-        char* token = strtok(path_copy, "/");
+// Where the rows of one repository's trie go as filter candidates
+typedef struct {
+    pane_rows_t* pane;
+    uint32_t header;                // Pane row of the repository header
+} tree_candidates_t;
+
+static int append_tree_candidate(const char* text, size_t length, uint64_t byte_mask, size_t index, void* context) {
+    tree_candidates_t* tree = context;
+    pane_rows_t* pane = tree->pane;
+    const char* copy = pane_arena_strdup(&pane->arena, text);
+    if (!copy) return -1;
+
+    pane_filter_candidate_t* candidate = &pane->candidates[pane->candidate_count++];
+    candidate->text = copy;
+    candidate->byte_mask = byte_mask;
+    candidate->length = (uint32_t)length;
+    candidate->row = tree->header + 1 + (uint32_t)index;
+    candidate->header = tree->header;
+    return 0;
+}
 
-        while (token) {
-            // Check if child already exists
-            tree_node_t* child = NULL;
-            for (size_t j = 0; j < current->child_count; j++) {
-                if (strcmp(current->children[j]->name, token) == 0) {
-                    child = current->children[j];
-                    break;
-                }
+// Add a repository to a TREE view pane: its header row, then one row per
+// trie node, generated by pane_row_at() when drawn. The rows' text and masks
+// are also kept as "/" filter candidates, taken in one walk of the trie so
+// the filter does not have to look every row up on the UI thread.
+static void append_repo_tree(pane_rows_t* pane, const char* name, const char* path, tree_node_t* root) {
+    if (pane->tree_count % PANE_TREES_GROWTH == 0) {
+        pane_tree_t* trees = realloc(pane->trees, (pane->tree_count + PANE_TREES_GROWTH) * sizeof(pane_tree_t));
+        if (!trees) return;
+        pane->trees = trees;
+    }
+    char header_buffer[512];
+    snprintf(header_buffer, sizeof(header_buffer), "Repository: %s", repo_display_name(name, path));
+    const char* header = pane_arena_strdup(&pane->arena, header_buffer);
+    if (!header) return;
+
+    pane_tree_t* tree = &pane->trees[pane->tree_count];
+    tree->first_row = pane->count;
+    tree->header = header;
+    tree->header_width = get_string_display_width(header);
+    tree->repo_color = (uint8_t)(pane->tree_count % 8 + 1); // Same alternation as finish_pane_rows()
+    tree->root = root;
+    tree_retain(root);
+    pane->tree_count++;
+
+    size_t rows = root ? root->row_count : 0;
+    pane_filter_candidate_t* candidates = realloc(pane->candidates, (pane->candidate_count + rows + 1) * sizeof(pane_filter_candidate_t));
+    if (candidates) {
+        pane->candidates = candidates;
+        tree_candidates_t walk = {pane, (uint32_t)pane->count};
+        tree_walk_rows(root, append_tree_candidate, &walk);
+    }
+    pane->count += 1 + rows;
+}
+
+// Pane 2 rows for one view of the unpushed commits
+static void build_unpushed_rows(const unpushed_collection_t* collection, char** submodules,
+                                 size_t submodule_count, view_mode_t view_mode, tree_cache_t* trees,
+                                 pane_rows_t* pane) {
+    for (size_t i = 0; i < collection->count; i++) {
+        const unpushed_repo_t* repo = &collection->repos[i];
+        if (repo->commit_count == 0) continue;
+
+        // For tree view, one tree of the files of all commits
+        if (view_mode == VIEW_TREE) {
+            size_t file_total = 0;
+            for (size_t j = 0; j < repo->commit_count; j++) {
+                file_total += repo->commit_file_counts[j];
+            }
+            char** repo_files = calloc(file_total + 1, sizeof(char*));
+            if (!repo_files) {
+                append_repo_header(pane, repo->repo_name, repo->repo_path);
+                continue;
             }
 
-            // Create new child if not found
-            if (!child) {
-                child = calloc(1, sizeof(tree_node_t));
-                child->name = strdup(token);
-
-                // Check if this is the last token (file) or not (directory)
-                char* next_token = strtok(NULL, "/");
-                child->is_file = (next_token == NULL);
-
-                // Put token back for proper processing
-                if (next_token) {
-                    // This is a directory, put the token back
-                    char* temp = strtok(NULL, ""); // Get rest of string
-                    if (temp) {
-                        char* full_rest = malloc(strlen(next_token) + strlen(temp) + 2);
-                        sprintf(full_rest, "%s/%s", next_token, temp);
-                        strtok(full_rest, "/"); // Reset strtok state
-                        free(full_rest);
+            size_t repo_file_count = 0;
+            for (size_t j = 0; j < repo->commit_count; j++) {
+                for (size_t k = 0; k < repo->commit_file_counts[j]; k++) {
+                    if (!is_submodule(repo->commit_files[j][k], submodules, submodule_count)) {
+                        repo_files[repo_file_count++] = repo->commit_files[j][k];
                     }
                 }
-
-                // Add to parent's children
-                current->children = realloc(current->children, (current->child_count + 1) * sizeof(tree_node_t*));
-                current->children[current->child_count] = child;
-                current->child_count++;
             }
 
-            current = child;
+            tree_node_t* root = tree_cache_update(trees, repo->repo_path, repo_files, repo_file_count);
+            append_repo_tree(pane, repo->repo_name, repo->repo_path, root);
+            free(repo_files);
+            continue;
+        }
 
-            // Get next token only if we haven't already processed it
-            if (!child->is_file) {
-                token = strtok(NULL, "/");
-            } else {
-                token = NULL;
+        append_repo_header(pane, repo->repo_name, repo->repo_path);
+
+        // Add each commit and its files
+        for (size_t j = 0; j < repo->commit_count; j++) {
+            char commit_buffer[1024];
+            // Truncate commit info using glyph-aware approach
+            char* truncated_commit = truncate_string_right_priority(repo->unpushed_commits[j], 60 - 4); // 4 for "└── "
+            snprintf(commit_buffer, sizeof(commit_buffer), "└── %s", truncated_commit ? truncated_commit : "");
+            free(truncated_commit);
+            append_pane_row(pane, commit_buffer, PANE_ROW_ITEM);
+
+            // Add files changed (skip submodules)
+            for (size_t k = 0; k < repo->commit_file_counts[j]; k++) {
+                const char* file = repo->commit_files[j][k];
+                if (!is_submodule(file, submodules, submodule_count)) {
+                    // For FLAT view, just show the filename without tree prefixes
+                    append_pane_row(pane, file, PANE_ROW_ITEM);
+                }
             }
         }
-
-        free(path_copy);
     }
-
-    return root;
 }
 
-// Print tree node with proper indentation
-static void print_tree_node(tree_node_t* node, int depth, int is_last, const char* prefix, const char* last_prefix, const char* indent, int max_width, int current_row, int max_row, char*** items, size_t* item_count) {
-    if (current_row >= max_row || !items || !item_count || !node || !node->name) {
-        return;
-    }
-
-    // Print indentation
-    char buffer[4096] = {0};
-    int buffer_pos = 0;
-
-    for (int i = 0; i < depth; i++) {
-        buffer_pos += snprintf(buffer + buffer_pos, sizeof(buffer) - buffer_pos, "%s", indent);
-    }
+// Pane 1 rows for one view of the dirty files
+static void build_dirty_files_rows(const dirty_collection_t* collection, char** submodules,
+                                    size_t submodule_count, view_mode_t view_mode, tree_cache_t* trees,
+                                    pane_rows_t* pane) {
+    for (size_t i = 0; i < collection->count; i++) {
+        const dirty_repo_t* repo = &collection->repos[i];
+        if (repo->file_count == 0) continue;
+
+        // Collect the files of this repository, skipping submodules
+        char** repo_files = calloc(repo->file_count + 1, sizeof(char*));
+        if (!repo_files) continue;
+
+        size_t repo_file_count = 0;
+        for (size_t j = 0; j < repo->file_count; j++) {
+            if (!is_submodule(repo->dirty_files[j], submodules, submodule_count)) {
+                repo_files[repo_file_count++] = repo->dirty_files[j];
+            }
+        }
 
-    // Print tree prefix
-    if (depth > 0) {
-        if (is_last) {
-            buffer_pos += snprintf(buffer + buffer_pos, sizeof(buffer) - buffer_pos, "%s", last_prefix);
+        if (view_mode == VIEW_TREE) {
+            tree_node_t* root = tree_cache_update(trees, repo->repo_path, repo_files, repo_file_count);
+            append_repo_tree(pane, repo->repo_name, repo->repo_path, root);
         } else {
-            buffer_pos += snprintf(buffer + buffer_pos, sizeof(buffer) - buffer_pos, "%s", prefix);
+            append_repo_header(pane, repo->repo_name, repo->repo_path);
+            // Plain filenames, no repo prefix
+            for (size_t j = 0; j < repo_file_count; j++) {
+                append_pane_row(pane, repo_files[j], PANE_ROW_ITEM);
+            }
         }
-    }
-
-    // Calculate available width for filename (accounting for indentation and tree prefix)
-    int indent_width = depth * strlen(indent); // Rough estimate for indentation
-    int prefix_width = (depth > 0) ? strlen(is_last ? last_prefix : prefix) : 0;
-    int used_width = indent_width + prefix_width;
-    int available_width = max_width - used_width;
-
-    if (available_width <= 0) available_width = 10; // Minimum fallback
-
-    // Get truncated name using glyph-aware right-priority truncation
-    char* display_name = truncate_string_right_priority(node->name, available_width);
-
-    buffer_pos += snprintf(buffer + buffer_pos, sizeof(buffer) - buffer_pos, "%s", display_name);
-
-    free(display_name);
-
-    // Add to items array
-    *items = realloc(*items, (*item_count + 1) * sizeof(char*));
-    (*items)[*item_count] = strdup(buffer);
-    (*item_count)++;
-    current_row++;
-
-    // Print children
-    for (size_t i = 0; i < node->child_count; i++) {
-        int child_is_last = (i == node->child_count - 1);
-        print_tree_node(node->children[i], depth + 1, child_is_last, prefix, last_prefix, indent, max_width, current_row, max_row, items, item_count);
+        free(repo_files);
     }
 }
 
-// Read and parse git-submodules.report for pane 1
-int load_git_submodules_data(three_pane_tui_orchestrator_t* orch) {
+// Collect dirty files and unpushed commits for every repository in
+// git-submodules.report. Submodule names are returned too: submodules show
+// up as entries in their parent's lists, and the panes leave them out.
+// Returns: 0 on success, -1 if the repository list could not be read
+int collect_pane_data(dirty_collection_t** dirty_out, unpushed_collection_t** unpushed_out,
+                      char*** submodules_out, size_t* submodule_count_out) {
     json_value_t* report = json_parse_file("git-submodules.report");
     if (!report || report->type != JSON_OBJECT) {
         fprintf(stderr, "Failed to load git-submodules.report\n");
+        if (report) json_free(report);
         return -1;
     }
 
-    // Get repositories array
     json_value_t* repos = get_nested_value(report, "repositories");
     if (!repos || repos->type != JSON_ARRAY) {
-        fprintf(stderr, "No repositories found in report\n");
+        fprintf(stderr, "No repositories found in git-submodules.report\n");
         json_free(report);
         return -1;
     }
 
-    // Free old data before allocating new data
-    if (orch->data.pane1_items) {
-        for (size_t i = 0; i < orch->data.pane1_count; i++) {
-            free(orch->data.pane1_items[i]);
-        }
-        free(orch->data.pane1_items);
-        orch->data.pane1_items = NULL;
-        orch->data.pane1_count = 0;
+    dirty_collection_t* dirty = dirty_collection_init();
+    unpushed_collection_t* unpushed = unpushed_collection_init();
+    char** submodules = calloc(repos->value.arr_val->count + 1, sizeof(char*));
+    size_t submodule_count = 0;
+    if (!dirty || !unpushed || !submodules) {
+        dirty_collection_cleanup(dirty);
+        unpushed_collection_cleanup(unpushed);
+        free(submodules);
+        json_free(report);
+        return -1;
     }
 
-    // Allocate space for repository data
-    orch->data.pane1_count = repos->value.arr_val->count;
-    orch->data.pane1_items = calloc(orch->data.pane1_count, sizeof(char*));
-
-    // Parse each repository
     for (size_t i = 0; i < repos->value.arr_val->count; i++) {
         json_value_t* repo = repos->value.arr_val->items[i];
         if (repo->type != JSON_OBJECT) continue;
-
-        // Get repository name and status
         json_value_t* name = get_nested_value(repo, "name");
-        json_value_t* status = get_nested_value(repo, "status");
-        json_value_t* changes = get_nested_value(repo, "changes");
-
-        // Format repository info
-        char buffer[1024];
-        if (name && name->type == JSON_STRING &&
-            status && status->type == JSON_STRING) {
-            if (changes && changes->type == JSON_STRING && strlen(changes->value.str_val) > 0) {
-                // Show first line of changes if available
-                char* newline_pos = strchr(changes->value.str_val, '\n');
-                if (newline_pos) {
-                    *newline_pos = '\0';
-                }
-                snprintf(buffer, sizeof(buffer), "%s [%s]: %s",
-                        name->value.str_val, status->value.str_val, changes->value.str_val);
-            } else {
-                snprintf(buffer, sizeof(buffer), "%s [%s]",
-                        name->value.str_val, status->value.str_val);
-            }
-        } else {
-            snprintf(buffer, sizeof(buffer), "Unknown repo");
-        }
-
-        orch->data.pane1_items[i] = strdup(buffer);
-    }
+        json_value_t* path = get_nested_value(repo, "path");
+        if (!name || name->type != JSON_STRING || !path || path->type != JSON_STRING) continue;
 
-    json_free(report);
-    return 0;
-}
+        add_dirty_repo(dirty, path->value.str_val, name->value.str_val);
+        add_unpushed_repo(unpushed, path->value.str_val, name->value.str_val);
 
-// Read and parse committed-not-pushed-report.json for pane 2
-int load_committed_not_pushed_data(three_pane_tui_orchestrator_t* orch, view_mode_t view_mode) {
-    // Clean up old pane2 data first
-    for (size_t i = 0; i < orch->data.pane2_count; i++) {
-        if (orch->data.pane2_items[i]) {
-            free(orch->data.pane2_items[i]);
+        // Submodules show up as entries in their parent's lists; they are filtered out
+        if (strcmp(name->value.str_val, "root") != 0) {
+            submodules[submodule_count++] = strdup(name->value.str_val);
         }
     }
-    free(orch->data.pane2_items);
-    orch->data.pane2_items = NULL;
-    orch->data.pane2_count = 0;
+    json_free(report);
 
-    // First, read git-submodules.report to get list of known submodules to filter out
-    char** submodules = NULL;
-    size_t submodule_count = 0;
+    dirty_files_collect(dirty);
+    committed_not_pushed_collect(unpushed);
 
-    json_value_t* submodules_report = json_parse_file("git-submodules.report");
-    if (submodules_report && submodules_report->type == JSON_OBJECT) {
-        json_value_t* repos = get_nested_value(submodules_report, "repositories");
-        if (repos && repos->type == JSON_ARRAY) {
-            // Count non-root repositories (submodules)
-            for (size_t i = 0; i < repos->value.arr_val->count; i++) {
-                json_value_t* repo = repos->value.arr_val->items[i];
-                if (repo->type != JSON_OBJECT) continue;
-                json_value_t* name = get_nested_value(repo, "name");
-                if (name && name->type == JSON_STRING && strcmp(name->value.str_val, "root") != 0) {
-                    submodule_count++;
-                }
-            }
+    *dirty_out = dirty;
+    *unpushed_out = unpushed;
+    *submodules_out = submodules;
+    *submodule_count_out = submodule_count;
+    return 0;
+}
 
-            // Allocate and populate submodules array
-            submodules = calloc(submodule_count, sizeof(char*));
-            size_t sub_idx = 0;
-            for (size_t i = 0; i < repos->value.arr_val->count; i++) {
-                json_value_t* repo = repos->value.arr_val->items[i];
-                if (repo->type != JSON_OBJECT) continue;
-                json_value_t* name = get_nested_value(repo, "name");
-                if (name && name->type == JSON_STRING && strcmp(name->value.str_val, "root") != 0) {
-                    submodules[sub_idx++] = strdup(name->value.str_val);
-                }
-            }
-        }
+// Render panes 1 and 2 for both views from collected repository data. The
+// TREE views are brought up to date from the previous build's tries in trees.
+// Returns: new model, or NULL on allocation failure
+pane_model_t* build_pane_model_from(const dirty_collection_t* dirty, const unpushed_collection_t* unpushed,
+                                    char** submodules, size_t submodule_count,
+                                    const style_config_t* styles, pane_tree_cache_t* trees) {
+    pane_model_t* model = calloc(1, sizeof(pane_model_t));
+    if (!model) return NULL;
+
+    for (int view = 0; view < VIEW_MODE_COUNT; view++) {
+        build_dirty_files_rows(dirty, submodules, submodule_count, (view_mode_t)view,
+                               &trees->dirty_files, &model->dirty_files[view]);
+        build_unpushed_rows(unpushed, submodules, submodule_count, (view_mode_t)view,
+                            &trees->unpushed_commits, &model->unpushed_commits[view]);
+        finish_pane_rows(&model->dirty_files[view], styles);
+        finish_pane_rows(&model->unpushed_commits[view], styles);
     }
+    tree_cache_sweep(&trees->dirty_files);
+    tree_cache_sweep(&trees->unpushed_commits);
+    return model;
+}
 
-    json_value_t* report = json_parse_file("committed-not-pushed-report.json");
-    if (!report || report->type != JSON_OBJECT) {
-        fprintf(stderr, "Error: Cannot parse committed-not-pushed-report.json\n");
-        if (submodules_report) json_free(submodules_report);
-        return 1;
+// Collect dirty files and unpushed commits for every repository in
+// git-submodules.report and render panes 1 and 2 for both views.
+// Runs on the refresh worker thread; touches no orchestrator state. The TREE
+// views are brought up to date from the previous scan's tries in trees.
+// Returns: new model, or NULL if the repository list could not be read
+pane_model_t* build_pane_model(const style_config_t* styles, pane_tree_cache_t* trees) {
+    dirty_collection_t* dirty;
+    unpushed_collection_t* unpushed;
+    char** submodules;
+    size_t submodule_count;
+    if (collect_pane_data(&dirty, &unpushed, &submodules, &submodule_count) != 0) return NULL;
+
+    pane_model_t* model = build_pane_model_from(dirty, unpushed, submodules, submodule_count, styles, trees);
+
+    dirty_collection_cleanup(dirty);
+    unpushed_collection_cleanup(unpushed);
+    for (size_t i = 0; i < submodule_count; i++) {
+        free(submodules[i]);
     }
+    free(submodules);
+    return model;
+}
 
-    json_value_t* repos = get_nested_value(report, "repositories");
-    if (!repos || repos->type != JSON_ARRAY) {
-        fprintf(stderr, "Error: No repositories array in committed-not-pushed-report.json\n");
-        json_free(report);
-        if (submodules_report) json_free(submodules_report);
-        return 1;
+void pane_model_free(pane_model_t* model) {
+    if (!model) return;
+    for (int view = 0; view < VIEW_MODE_COUNT; view++) {
+        free_pane_rows(&model->dirty_files[view]);
+        free_pane_rows(&model->unpushed_commits[view]);
     }
+    free(model);
+}
 
-    // For tree view, collect all files per repository and build trees
-    if (view_mode == VIEW_TREE) {
-        // Count repositories with commits
-        size_t repo_with_commits_count = 0;
-        for (size_t i = 0; i < repos->value.arr_val->count; i++) {
-            json_value_t* repo = repos->value.arr_val->items[i];
-            if (repo->type != JSON_OBJECT) continue;
-            json_value_t* commits = get_nested_value(repo, "unpushed_commits");
-            if (commits && commits->type == JSON_ARRAY && commits->value.arr_val->count > 0) {
-                repo_with_commits_count++;
-            }
-        }
-
-        orch->data.pane2_count = 0;
-        orch->data.pane2_items = NULL;
-
-        // Process each repository with commits
-        for (size_t i = 0; i < repos->value.arr_val->count; i++) {
-            json_value_t* repo = repos->value.arr_val->items[i];
-            if (repo->type != JSON_OBJECT) continue;
-
-            json_value_t* repo_name = get_nested_value(repo, "name");
-            json_value_t* commits = get_nested_value(repo, "unpushed_commits");
-
-            if (!repo_name || repo_name->type != JSON_STRING) continue;
-            if (!commits || commits->type != JSON_ARRAY || commits->value.arr_val->count == 0) continue;
-
-            // Get repository name
-            json_value_t* repo_path = get_nested_value(repo, "path");
-            const char* display_name = repo_name->value.str_val;
-            if (repo_path && repo_path->type == JSON_STRING) {
-                const char* path = repo_path->value.str_val;
-                const char* repo_name_from_path = strrchr(path, '/');
-                if (repo_name_from_path) {
-                    display_name = repo_name_from_path + 1;
-                }
-            }
-
-            // Add repository header
-            char header_buffer[512];
-            snprintf(header_buffer, sizeof(header_buffer), "Repository: %s", display_name);
-            orch->data.pane2_items = realloc(orch->data.pane2_items, (orch->data.pane2_count + 1) * sizeof(char*));
-            orch->data.pane2_items[orch->data.pane2_count] = strdup(header_buffer);
-            orch->data.pane2_count++;
-
-            // Collect all files from all commits in this repository
-            char** repo_files = NULL;
-            size_t repo_file_count = 0;
-
-            for (size_t j = 0; j < commits->value.arr_val->count; j++) {
-                json_value_t* commit = commits->value.arr_val->items[j];
-                if (commit->type != JSON_OBJECT) continue;
-
-                json_value_t* files_changed = get_nested_value(commit, "files_changed");
-                if (files_changed && files_changed->type == JSON_ARRAY) {
-                    for (size_t k = 0; k < files_changed->value.arr_val->count; k++) {
-                        json_value_t* file = files_changed->value.arr_val->items[k];
-                        if (file->type == JSON_STRING && !is_submodule(file->value.str_val, submodules, submodule_count)) {
-                            repo_files = realloc(repo_files, (repo_file_count + 1) * sizeof(char*));
-                            repo_files[repo_file_count] = strdup(file->value.str_val);
-                            repo_file_count++;
-                        }
-                    }
-                }
-            }
-
-            // Build file tree for this repository
-            if (repo_file_count > 0) {
-                tree_node_t* file_tree = build_file_tree(repo_files, repo_file_count);
-                if (file_tree && file_tree->child_count > 0) {
-                    // Print tree nodes (with indentation for the repository)
-                    for (size_t j = 0; j < file_tree->child_count; j++) {
-                        int is_last = (j == file_tree->child_count - 1);
-                        print_tree_node(file_tree->children[j], 0, is_last,
-                                      "├── ", "└── ", "│   ", 256, 0, 1000,
-                                      &orch->data.pane2_items, &orch->data.pane2_count);
-                    }
-                }
-                cleanup_tree_node(file_tree);
-
-                // Cleanup repo files
-                for (size_t j = 0; j < repo_file_count; j++) {
-                    free(repo_files[j]);
-                }
-                free(repo_files);
-            }
-        }
-    } else {
-        // Original flat view logic
-        // Count total items needed (repository headers + commits + non-submodule files)
-        size_t total_items = 0;
-        for (size_t i = 0; i < repos->value.arr_val->count; i++) {
-            json_value_t* repo = repos->value.arr_val->items[i];
-            if (repo->type != JSON_OBJECT) continue;
-
-            json_value_t* commits = get_nested_value(repo, "unpushed_commits");
-            if (commits && commits->type == JSON_ARRAY) {
-                total_items += 1; // Repository header
-                for (size_t j = 0; j < commits->value.arr_val->count; j++) {
-                    json_value_t* commit = commits->value.arr_val->items[j];
-                    if (commit->type != JSON_OBJECT) continue;
-                    total_items += 1; // Commit info
-                    json_value_t* files = get_nested_value(commit, "files_changed");
-                    if (files && files->type == JSON_ARRAY) {
-                        // Count only non-submodule files
-                        for (size_t k = 0; k < files->value.arr_val->count; k++) {
-                            json_value_t* file = files->value.arr_val->items[k];
-                            if (file->type == JSON_STRING && !is_submodule(file->value.str_val, submodules, submodule_count)) {
-                                total_items++;
-                            }
-                        }
-                    }
-                }
-            }
-        }
-
-        orch->data.pane2_count = total_items;
-        orch->data.pane2_items = calloc(total_items, sizeof(char*));
-
-        // Parse committed not pushed data from each repository
-        size_t item_index = 0;
-        for (size_t i = 0; i < repos->value.arr_val->count; i++) {
-            json_value_t* repo = repos->value.arr_val->items[i];
-            if (repo->type != JSON_OBJECT) continue;
-
-            json_value_t* repo_name = get_nested_value(repo, "name");
-            json_value_t* commits = get_nested_value(repo, "unpushed_commits");
-
-            if (!repo_name || repo_name->type != JSON_STRING) continue;
-            if (!commits || commits->type != JSON_ARRAY) continue;
-
-            // Add repository header - use actual repo name from path if available
-            json_value_t* repo_path = get_nested_value(repo, "path");
-            char header_buffer[512];
-            if (repo_path && repo_path->type == JSON_STRING) {
-                // Extract repo name from path (last component after '/')
-                const char* path = repo_path->value.str_val;
-                const char* repo_name_from_path = strrchr(path, '/');
-                if (repo_name_from_path) {
-                    repo_name_from_path++; // Skip the '/'
-                    snprintf(header_buffer, sizeof(header_buffer), "Repository: %s", repo_name_from_path);
-                } else {
-                    snprintf(header_buffer, sizeof(header_buffer), "Repository: %s", repo_name->value.str_val);
-                }
-            } else {
-                snprintf(header_buffer, sizeof(header_buffer), "Repository: %s", repo_name->value.str_val);
-            }
-            orch->data.pane2_items[item_index++] = strdup(header_buffer);
-
-            // Add each commit and its files
-            for (size_t j = 0; j < commits->value.arr_val->count; j++) {
-                json_value_t* commit = commits->value.arr_val->items[j];
-                if (commit->type != JSON_OBJECT) continue;
-
-                json_value_t* commit_info = get_nested_value(commit, "commit_info");
-                json_value_t* files_changed = get_nested_value(commit, "files_changed");
-
-                // Add commit info
-                if (commit_info && commit_info->type == JSON_STRING) {
-                    char commit_buffer[1024];
-                    // Truncate commit info using glyph-aware approach
-                    const char* info = commit_info->value.str_val;
-                    char* truncated_commit = truncate_string_right_priority(info, 60 - 4); // 4 for "└── "
-                    snprintf(commit_buffer, sizeof(commit_buffer), "└── %s", truncated_commit);
-                    free(truncated_commit);
-                    orch->data.pane2_items[item_index++] = strdup(commit_buffer);
-                }
-
-                // Add files changed (skip submodules)
-                if (files_changed && files_changed->type == JSON_ARRAY) {
-                    for (size_t k = 0; k < files_changed->value.arr_val->count; k++) {
-                        json_value_t* file = files_changed->value.arr_val->items[k];
-                        if (file->type == JSON_STRING && !is_submodule(file->value.str_val, submodules, submodule_count)) {
-                        // For FLAT view, just show the filename without tree prefixes
-                        orch->data.pane2_items[item_index++] = strdup(file->value.str_val);
-                        }
-                    }
-                }
-            }
-        }
+// Row index of a pane; TREE view rows are generated into scratch and buffer
+// Returns: the row, or NULL past the end
+const pane_row_t* pane_row_at(const pane_rows_t* pane, size_t index, pane_row_t* scratch, char* buffer, size_t size) {
+    if (!pane || index >= pane->count) return NULL;
+    if (pane->tree_count == 0) return &pane->rows[index];
+
+    // Last repository whose header is at or before the row
+    size_t lo = 0, hi = pane->tree_count;
+    while (hi - lo > 1) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (pane->trees[mid].first_row <= index) lo = mid;
+        else hi = mid;
     }
-
-    json_free(report);
-    if (submodules_report) json_free(submodules_report);
-
-    // Cleanup submodules array
-    if (submodules) {
-        for (size_t i = 0; i < submodule_count; i++) {
-            free(submodules[i]);
-        }
-        free(submodules);
+    const pane_tree_t* tree = &pane->trees[lo];
+
+    memset(scratch, 0, sizeof(*scratch));
+    scratch->repo_color = tree->repo_color;
+    scratch->color = (uint8_t)color_index_to_ansi(tree->repo_color);
+    if (index == tree->first_row) {
+        scratch->text = tree->header;
+        scratch->display_width = tree->header_width;
+        scratch->kind = PANE_ROW_HEADER;
+    } else {
+        tree_row_text(tree->root, index - tree->first_row - 1, buffer, size);
+        scratch->text = buffer;
+        scratch->byte_mask = pane_filter_byte_mask(buffer);
+        scratch->display_width = get_string_display_width(buffer);
+        scratch->kind = PANE_ROW_ITEM;
     }
+    return scratch;
+}
 
-    return 0;
+// Point panes 1 and 2 at the current model's rows for a view
+void select_pane_view(three_pane_tui_orchestrator_t* orch, view_mode_t view_mode) {
+    pane_model_t* model = orch->data.model;
+    pane_layout_clear(&orch->data.pane1_layout);
+    pane_layout_clear(&orch->data.pane2_layout);
+    orch->data.pane1_rows = model ? &model->dirty_files[view_mode] : NULL;
+    orch->data.pane1_count = model ? model->dirty_files[view_mode].count : 0;
+    orch->data.pane2_rows = model ? &model->unpushed_commits[view_mode] : NULL;
+    orch->data.pane2_count = model ? model->unpushed_commits[view_mode].count : 0;
+
+    // The filter's candidates point into the rows being replaced
+    pane_filter_free(&orch->data.pane1_filter);
+    pane_filter_free(&orch->data.pane2_filter);
+    apply_pane_filters(orch);
 }
 
-// Read and parse dirty-files-report.json for pane 1
-int load_dirty_files_data(three_pane_tui_orchestrator_t* orch, view_mode_t view_mode) {
-    // Clean up old pane1 data first
-    for (size_t i = 0; i < orch->data.pane1_count; i++) {
-        if (orch->data.pane1_items[i]) {
-            free(orch->data.pane1_items[i]);
-        }
-    }
-    free(orch->data.pane1_items);
-    orch->data.pane1_items = NULL;
-    orch->data.pane1_count = 0;
+// active_file_info_t is defined in three-pane-tui.h
 
-    // First, read git-submodules.report to get list of known submodules to filter out
-    char** submodules = NULL;
-    size_t submodule_count = 0;
+#define STREAM_ACTIVE_WINDOW_SECONDS 30
+#define STREAM_READ_CHUNK_SIZE 65536
+#define STREAM_WINDOW_INITIAL_CAPACITY 64
 
-    json_value_t* submodules_report = json_parse_file("git-submodules.report");
-    if (submodules_report && submodules_report->type == JSON_OBJECT) {
-        json_value_t* repos = get_nested_value(submodules_report, "repositories");
-        if (repos && repos->type == JSON_ARRAY) {
-            // Count non-root repositories (submodules)
-            for (size_t i = 0; i < repos->value.arr_val->count; i++) {
-                json_value_t* repo = repos->value.arr_val->items[i];
-                if (repo->type != JSON_OBJECT) continue;
-                json_value_t* name = get_nested_value(repo, "name");
-                if (name && name->type == JSON_STRING && strcmp(name->value.str_val, "root") != 0) {
-                    submodule_count++;
-                }
-            }
+void stream_reader_init(stream_reader_t* stream) {
+    memset(stream, 0, sizeof(*stream));
+    stream->fd = -1;
+}
 
-            // Allocate and populate submodules array
-            submodules = calloc(submodule_count, sizeof(char*));
-            size_t sub_idx = 0;
-            for (size_t i = 0; i < repos->value.arr_val->count; i++) {
-                json_value_t* repo = repos->value.arr_val->items[i];
-                if (repo->type != JSON_OBJECT) continue;
-                json_value_t* name = get_nested_value(repo, "name");
-                if (name && name->type == JSON_STRING && strcmp(name->value.str_val, "root") != 0) {
-                    submodules[sub_idx++] = strdup(name->value.str_val);
-                }
-            }
-        }
+// Forget the open file and every event read from it
+static void stream_reader_reset(stream_reader_t* stream) {
+    if (stream->fd >= 0) close(stream->fd);
+    stream->fd = -1;
+    stream->offset = 0;
+    for (size_t i = stream->head; i < stream->count; i++) {
+        free(stream->window[i].path);
     }
+    stream->head = 0;
+    stream->count = 0;
+}
 
-    json_value_t* report = json_parse_file("dirty-files-report.json");
-    if (!report || report->type != JSON_OBJECT) {
-        fprintf(stderr, "Failed to load dirty-files-report.json\n");
+// Make sure the reader follows the file currently at the stream path,
+// starting over when it was rotated (a different file) or truncated
+// Returns: 0 if there is a file to read, -1 otherwise
+static int stream_reader_follow(stream_reader_t* stream) {
+    struct stat st;
+    if (stat(FILE_CHANGES_STREAM_FILE, &st) != 0) {
+        stream_reader_reset(stream);
         return -1;
     }
 
-    // Get repositories array
-    json_value_t* repos = get_nested_value(report, "repositories");
-    if (!repos || repos->type != JSON_ARRAY) {
-        fprintf(stderr, "No repositories found in dirty-files report\n");
-        json_free(report);
-        return -1;
+    if (stream->fd >= 0 && (st.st_dev != stream->dev || st.st_ino != stream->ino || st.st_size < stream->offset)) {
+        stream_reader_reset(stream);
     }
+    if (stream->fd < 0) {
+        stream->fd = open(FILE_CHANGES_STREAM_FILE, O_RDONLY | O_CLOEXEC);
+        if (stream->fd < 0 || fstat(stream->fd, &st) != 0) {
+            stream_reader_reset(stream);
+            return -1;
+        }
+        stream->dev = st.st_dev;
+        stream->ino = st.st_ino;
+    }
+    return 0;
+}
 
-    // For tree view, collect all files per repository and build trees
-    if (view_mode == VIEW_TREE) {
-        orch->data.pane1_count = 0;
-        orch->data.pane1_items = NULL;
-
-        // Process each repository with dirty files
-        for (size_t i = 0; i < repos->value.arr_val->count; i++) {
-            json_value_t* repo = repos->value.arr_val->items[i];
-            if (repo->type != JSON_OBJECT) continue;
-
-            json_value_t* repo_name = get_nested_value(repo, "name");
-            json_value_t* files = get_nested_value(repo, "dirty_files");
-
-            if (!repo_name || repo_name->type != JSON_STRING) continue;
-            if (!files || files->type != JSON_ARRAY || files->value.arr_val->count == 0) continue;
-
-            // Get repository name
-            json_value_t* repo_path = get_nested_value(repo, "path");
-            const char* display_name = repo_name->value.str_val;
-            if (repo_path && repo_path->type == JSON_STRING) {
-                const char* path = repo_path->value.str_val;
-                const char* repo_name_from_path = strrchr(path, '/');
-                if (repo_name_from_path) {
-                    display_name = repo_name_from_path + 1;
-                }
-            }
-
-            // Add repository header
-            char header_buffer[512];
-            snprintf(header_buffer, sizeof(header_buffer), "Repository: %s", display_name);
-            orch->data.pane1_items = realloc(orch->data.pane1_items, (orch->data.pane1_count + 1) * sizeof(char*));
-            orch->data.pane1_items[orch->data.pane1_count] = strdup(header_buffer);
-            orch->data.pane1_count++;
-
-            // Collect all files from this repository
-            char** repo_files = NULL;
-            size_t repo_file_count = 0;
-
-            for (size_t j = 0; j < files->value.arr_val->count; j++) {
-                json_value_t* file = files->value.arr_val->items[j];
-                if (file->type == JSON_STRING && !is_submodule(file->value.str_val, submodules, submodule_count)) {
-                    repo_files = realloc(repo_files, (repo_file_count + 1) * sizeof(char*));
-                    repo_files[repo_file_count] = strdup(file->value.str_val);
-                    repo_file_count++;
+// Append one stream line's event to the window
+static void stream_reader_add_line(stream_reader_t* stream, const char* line) {
+    json_value_t* json = json_parse_string(line);
+    if (json && json->type == JSON_OBJECT) {
+        json_value_t* path_val = get_nested_value(json, "path");
+        json_value_t* timestamp_val = get_nested_value(json, "timestamp");
+
+        if (path_val && path_val->type == JSON_STRING &&
+            timestamp_val && timestamp_val->type == JSON_NUMBER) {
+            time_t timestamp = (time_t)timestamp_val->value.num_val;
+            if (time(NULL) - timestamp < STREAM_ACTIVE_WINDOW_SECONDS) {
+                // Reuse the expired prefix before growing
+                if (stream->count == stream->capacity && stream->head > 0) {
+                    memmove(stream->window, stream->window + stream->head,
+                            (stream->count - stream->head) * sizeof(active_file_info_t));
+                    stream->count -= stream->head;
+                    stream->head = 0;
                 }
-            }
-
-            // Build file tree for this repository
-            if (repo_file_count > 0) {
-                tree_node_t* file_tree = build_file_tree(repo_files, repo_file_count);
-                if (file_tree && file_tree->child_count > 0) {
-                    // Print tree nodes (with indentation for the repository)
-                    for (size_t j = 0; j < file_tree->child_count; j++) {
-                        int is_last = (j == file_tree->child_count - 1);
-                        print_tree_node(file_tree->children[j], 0, is_last,
-                                      "├── ", "└── ", "│   ", 256, 0, 1000,
-                                      &orch->data.pane1_items, &orch->data.pane1_count);
+                if (stream->count == stream->capacity) {
+                    size_t new_capacity = stream->capacity ? stream->capacity * 2 : STREAM_WINDOW_INITIAL_CAPACITY;
+                    active_file_info_t* window = realloc(stream->window, new_capacity * sizeof(active_file_info_t));
+                    if (!window) {
+                        json_free(json);
+                        return;
                     }
+                    stream->window = window;
+                    stream->capacity = new_capacity;
                 }
-                cleanup_tree_node(file_tree);
 
-                // Cleanup repo files
-                for (size_t j = 0; j < repo_file_count; j++) {
-                    free(repo_files[j]);
-                }
-                free(repo_files);
-            }
-        }
-    } else {
-        // Flat view mode - group files by repository with headers
-        // Count total items needed (repository headers + files per repository)
-        size_t total_items = 0;
-        for (size_t i = 0; i < repos->value.arr_val->count; i++) {
-            json_value_t* repo = repos->value.arr_val->items[i];
-            if (repo->type != JSON_OBJECT) continue;
-
-            json_value_t* files = get_nested_value(repo, "dirty_files");
-            if (files && files->type == JSON_ARRAY && files->value.arr_val->count > 0) {
-                total_items += 1; // Repository header
-                total_items += files->value.arr_val->count; // File items
-            }
-        }
-
-        // Allocate space for all items
-        orch->data.pane1_count = total_items;
-        orch->data.pane1_items = calloc(total_items, sizeof(char*));
-
-        // Parse dirty files from each repository, grouped by repository
-        size_t item_index = 0;
-        for (size_t i = 0; i < repos->value.arr_val->count; i++) {
-            json_value_t* repo = repos->value.arr_val->items[i];
-            if (repo->type != JSON_OBJECT) continue;
-
-            json_value_t* repo_name = get_nested_value(repo, "name");
-            json_value_t* files = get_nested_value(repo, "dirty_files");
-
-            if (!files || files->type != JSON_ARRAY || files->value.arr_val->count == 0) continue;
-
-            // Get repository name
-            json_value_t* repo_path = get_nested_value(repo, "path");
-            const char* display_name = repo_name && repo_name->type == JSON_STRING ? repo_name->value.str_val : "unknown";
-            if (repo_path && repo_path->type == JSON_STRING) {
-                const char* path = repo_path->value.str_val;
-                const char* repo_name_from_path = strrchr(path, '/');
-                if (repo_name_from_path) {
-                    display_name = repo_name_from_path + 1;
-                }
-            }
-
-            // Add repository header
-            char header_buffer[512];
-            snprintf(header_buffer, sizeof(header_buffer), "Repository: %s", display_name);
-            orch->data.pane1_items[item_index++] = strdup(header_buffer);
-
-            // Add each dirty file (plain filename, no repo prefix) - skip submodules
-            for (size_t j = 0; j < files->value.arr_val->count; j++) {
-                json_value_t* file = files->value.arr_val->items[j];
-                if (file->type == JSON_STRING && item_index < total_items && !is_submodule(file->value.str_val, submodules, submodule_count)) {
-                    // Store just the filename without repository prefix
-                    orch->data.pane1_items[item_index++] = strdup(file->value.str_val);
-                }
+                active_file_info_t* info = &stream->window[stream->count];
+                info->path = strdup(path_val->value.str_val);
+                info->last_updated = timestamp;
+                if (info->path) stream->count++;
             }
         }
     }
+    if (json) json_free(json);
+}
 
-    json_free(report);
+// Read the lines appended since the last call; a trailing line without its
+// newline yet is left for the next call
+static void stream_reader_read_appended(stream_reader_t* stream) {
+    char* chunk = malloc(STREAM_READ_CHUNK_SIZE + 1);
+    if (!chunk) return;
+
+    ssize_t n;
+    while ((n = pread(stream->fd, chunk, STREAM_READ_CHUNK_SIZE, stream->offset)) > 0) {
+        chunk[n] = '\0';
+        char* line = chunk;
+        char* newline;
+        while ((newline = memchr(line, '\n', chunk + n - line)) != NULL) {
+            *newline = '\0';
+            stream_reader_add_line(stream, line);
+            line = newline + 1;
+        }
 
-    // Cleanup submodules array
-    if (submodules_report) json_free(submodules_report);
-    if (submodules) {
-        for (size_t i = 0; i < submodule_count; i++) {
-            free(submodules[i]);
+        size_t consumed = line - chunk;
+        if (consumed == 0) {
+            if (n < STREAM_READ_CHUNK_SIZE) break;  // Incomplete line, still being written
+            consumed = n;                           // No line is this long; skip it
         }
-        free(submodules);
+        stream->offset += consumed;
     }
-
-    return 0;
+    free(chunk);
 }
 
-// active_file_info_t is defined in three-pane-tui.h
-
 // Load file changes data from file-changes-stream.json and return active files info
-active_file_info_t* load_file_changes_data(size_t* active_count) {
-    FILE* fp = fopen("file-changes-stream.json", "r");
-    if (!fp) {
+// Only the bytes appended since the previous call are read and parsed; events
+// older than the active window are dropped from the front of the window
+active_file_info_t* load_file_changes_data(stream_reader_t* stream, size_t* active_count) {
+    *active_count = 0;
+    if (stream_reader_follow(stream) != 0) {
         // File doesn't exist yet, no active files
-        *active_count = 0;
         return NULL;
     }
+    stream_reader_read_appended(stream);
 
+    // The watcher appends in time order, so expired events sit at the front
     time_t now = time(NULL);
-    size_t count = 0;
-    char line[4096];
-
-    // First pass: count active files (within last 30 seconds)
-    while (fgets(line, sizeof(line), fp)) {
-        // Parse JSON line
-        json_value_t* json = json_parse_string(line);
-        if (json && json->type == JSON_OBJECT) {
-            json_value_t* timestamp_val = get_nested_value(json, "timestamp");
-            if (timestamp_val && timestamp_val->type == JSON_NUMBER) {
-                time_t timestamp = (time_t)timestamp_val->value.num_val;
-                if (now - timestamp < 30) {  // Active within 30 seconds
-                    count++;
-                }
-            }
-        }
-        if (json) json_free(json);
+    while (stream->head < stream->count &&
+           now - stream->window[stream->head].last_updated >= STREAM_ACTIVE_WINDOW_SECONDS) {
+        free(stream->window[stream->head++].path);
     }
-
-    // Reset file pointer to beginning
-    fseek(fp, 0, SEEK_SET);
-
-    active_file_info_t* active_files = NULL;
-    if (count > 0) {
-        active_files = calloc(count, sizeof(active_file_info_t));
-        if (!active_files) {
-            fclose(fp);
-            *active_count = 0;
-            return NULL;
-        }
+    if (stream->head == stream->count) {
+        stream->head = 0;
+        stream->count = 0;
+        return NULL;
     }
 
-    *active_count = 0;
+    active_file_info_t* active_files = calloc(stream->count - stream->head, sizeof(active_file_info_t));
+    if (!active_files) return NULL;
 
-    // Second pass: collect active file information
-    while (fgets(line, sizeof(line), fp)) {
-        // Parse JSON line
-        json_value_t* json = json_parse_string(line);
-        if (json && json->type == JSON_OBJECT) {
-            json_value_t* path_val = get_nested_value(json, "path");
-            json_value_t* timestamp_val = get_nested_value(json, "timestamp");
-
-            if (path_val && path_val->type == JSON_STRING &&
-                timestamp_val && timestamp_val->type == JSON_NUMBER) {
-
-                time_t timestamp = (time_t)timestamp_val->value.num_val;
-                if (now - timestamp < 30) {  // Active within 30 seconds
-                    active_file_info_t* info = &active_files[*active_count];
-                    info->path = strdup(path_val->value.str_val);
-                    info->last_updated = timestamp;
-                    (*active_count)++;
-                }
-            }
-        }
-        if (json) json_free(json);
-    }
+    for (size_t i = stream->head; i < stream->count; i++) {
+        const active_file_info_t* event = &stream->window[i];
+        if (now - event->last_updated >= STREAM_ACTIVE_WINDOW_SECONDS) continue;  // Arrived out of order
 
-    fclose(fp);
+        active_file_info_t* info = &active_files[*active_count];
+        info->path = strdup(event->path);
+        if (!info->path) continue;
+        info->last_updated = event->last_updated;
+        (*active_count)++;
+    }
     return active_files;
-}
\ No newline at end of file
+}
+
+// Close the stream file and free the window
+void stream_reader_close(stream_reader_t* stream) {
+    stream_reader_reset(stream);
+    free(stream->window);
+    stream->window = NULL;
+    stream->capacity = 0;
+}
@@ -0,0 +1,176 @@
+#include "../three-pane-tui.h"
+#include <errno.h>
+#include <poll.h>
+#include <stdint.h>
+#include <sys/inotify.h>
+#include <sys/signalfd.h>
+#include <sys/timerfd.h>
+
+// Event sources for the main loop. Everything the TUI reacts to is a file
+// descriptor, so an idle session sleeps in poll() until something happens.
+
+#define EVENTS_INOTIFY_BUFFER_SIZE 4096
+
+// Set up the signal, timer and stream-file descriptors
+// Returns: 0 on success, -1 on error
+int events_init(tui_events_t* events) {
+    memset(events, 0, sizeof(*events));
+    events->signal_fd = -1;
+    events->timer_fd = -1;
+    events->stream_fd = -1;
+    events->refresh_fd = -1;
+
+    // SIGWINCH and SIGINT are delivered through the signalfd from now on
+    sigset_t mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGWINCH);
+    sigaddset(&mask, SIGINT);
+    if (sigprocmask(SIG_BLOCK, &mask, &events->saved_mask) != 0) {
+        perror("sigprocmask");
+        return -1;
+    }
+
+    events->signal_fd = signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+    events->timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (events->signal_fd < 0 || events->timer_fd < 0) {
+        perror("event descriptors");
+        events_cleanup(events);
+        return -1;
+    }
+
+    // The fallback watcher appends to the stream file; without inotify the
+    // periodic refresh still picks it up
+    events->stream_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (events->stream_fd >= 0 &&
+        inotify_add_watch(events->stream_fd, ".", IN_MODIFY | IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE) < 0) {
+        close(events->stream_fd);
+        events->stream_fd = -1;
+    }
+
+    return 0;
+}
+
+// Arm the periodic tick, or disarm it with an interval of 0
+void events_set_tick(tui_events_t* events, int interval_ms) {
+    if (events->timer_fd < 0 || interval_ms == events->tick_interval_ms) return;
+
+    struct itimerspec spec;
+    memset(&spec, 0, sizeof(spec));
+    spec.it_interval.tv_sec = interval_ms / 1000;
+    spec.it_interval.tv_nsec = (long)(interval_ms % 1000) * 1000000L;
+    spec.it_value = spec.it_interval;
+    if (timerfd_settime(events->timer_fd, 0, &spec, NULL) == 0) {
+        events->tick_interval_ms = interval_ms;
+    }
+}
+
+// Drain the signalfd
+static int events_read_signals(tui_events_t* events) {
+    int ready = 0;
+    struct signalfd_siginfo info;
+    while (read(events->signal_fd, &info, sizeof(info)) == (ssize_t)sizeof(info)) {
+        if (info.ssi_signo == SIGWINCH) ready |= TUI_EVENT_RESIZE;
+        if (info.ssi_signo == SIGINT) ready |= TUI_EVENT_INTERRUPT;
+    }
+    return ready;
+}
+
+// Drain the inotify queue; only writes to the stream file count
+static int events_read_stream(tui_events_t* events) {
+    int ready = 0;
+    char buffer[EVENTS_INOTIFY_BUFFER_SIZE] __attribute__((aligned(__alignof__(struct inotify_event))));
+    ssize_t n;
+    while ((n = read(events->stream_fd, buffer, sizeof(buffer))) > 0) {
+        for (char* p = buffer; p < buffer + n; ) {
+            struct inotify_event* event = (struct inotify_event*)p;
+            if (event->len > 0 && strcmp(event->name, FILE_CHANGES_STREAM_FILE) == 0) {
+                ready |= TUI_EVENT_STREAM;
+            }
+            p += sizeof(struct inotify_event) + event->len;
+        }
+    }
+    return ready;
+}
+
+// Sleep until input, a signal, feed data, a stream write, a published pane
+// model or a tick arrives
+// feed_fd is the inotify-daemon socket, or -1 while disconnected;
+// timeout_ms of -1 waits indefinitely
+// Returns: mask of TUI_EVENT_* flags, 0 on timeout
+int events_wait(tui_events_t* events, int feed_fd, int timeout_ms) {
+    struct pollfd fds[6];
+    int sources[6];
+    nfds_t count = 0;
+
+    fds[count].fd = STDIN_FILENO;
+    sources[count++] = TUI_EVENT_INPUT;
+    fds[count].fd = events->signal_fd;
+    sources[count++] = TUI_EVENT_RESIZE;
+    fds[count].fd = events->timer_fd;
+    sources[count++] = TUI_EVENT_TICK;
+    if (events->stream_fd >= 0) {
+        fds[count].fd = events->stream_fd;
+        sources[count++] = TUI_EVENT_STREAM;
+    }
+    if (events->refresh_fd >= 0) {
+        fds[count].fd = events->refresh_fd;
+        sources[count++] = TUI_EVENT_REFRESH;
+    }
+    if (feed_fd >= 0) {
+        fds[count].fd = feed_fd;
+        sources[count++] = TUI_EVENT_FEED;
+    }
+    for (nfds_t i = 0; i < count; i++) {
+        fds[i].events = POLLIN;
+        fds[i].revents = 0;
+    }
+
+    int n = poll(fds, count, timeout_ms);
+    if (n <= 0) return 0; // Timeout, or EINTR from a signal outside the mask
+
+    int ready = 0;
+    if (fds[0].revents & (POLLHUP | POLLERR | POLLNVAL)) {
+        ready |= TUI_EVENT_INTERRUPT; // The terminal went away
+    }
+    for (nfds_t i = 0; i < count; i++) {
+        if (!(fds[i].revents & (POLLIN | POLLHUP | POLLERR))) continue;
+        switch (sources[i]) {
+            case TUI_EVENT_RESIZE:
+                ready |= events_read_signals(events);
+                break;
+            case TUI_EVENT_TICK: {
+                uint64_t expirations;
+                if (read(events->timer_fd, &expirations, sizeof(expirations)) == (ssize_t)sizeof(expirations)) {
+                    ready |= TUI_EVENT_TICK;
+                }
+                break;
+            }
+            case TUI_EVENT_REFRESH: {
+                uint64_t published;
+                if (read(events->refresh_fd, &published, sizeof(published)) == (ssize_t)sizeof(published)) {
+                    ready |= TUI_EVENT_REFRESH;
+                }
+                break;
+            }
+            case TUI_EVENT_STREAM:
+                ready |= events_read_stream(events);
+                break;
+            default:
+                // stdin and the feed socket are read by their own handlers
+                ready |= sources[i];
+                break;
+        }
+    }
+    return ready;
+}
+
+// Close the descriptors and restore the signal mask
+void events_cleanup(tui_events_t* events) {
+    if (events->signal_fd >= 0) close(events->signal_fd);
+    if (events->timer_fd >= 0) close(events->timer_fd);
+    if (events->stream_fd >= 0) close(events->stream_fd);
+    events->signal_fd = -1;
+    events->timer_fd = -1;
+    events->stream_fd = -1;
+    sigprocmask(SIG_SETMASK, &events->saved_mask, NULL);
+}
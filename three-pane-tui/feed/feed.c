@@ -0,0 +1,373 @@
+#include "../three-pane-tui.h"
+#include <errno.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#define FEED_BUFFER_SIZE (INOTIFY_RECORD_MAX * 8)
+#define FEED_ACTIVE_WINDOW_SECONDS 30
+#define FEED_RECONNECT_INTERVAL_MS 1000
+#define FEED_LAUNCH_INTERVAL_SECONDS 5
+
+// Initialize an unconnected feed client
+void feed_init(feed_client_t* feed) {
+    if (!feed) return;
+    memset(feed, 0, sizeof(*feed));
+    feed->fd = -1;
+    feed->shm.fd = -1;
+    feed->session_start = time(NULL);
+}
+
+// Drop the shared-memory mapping; the socket table takes over
+static void feed_unmap_shm(feed_client_t* feed) {
+    inotify_shm_close(&feed->shm);
+    feed->shm_snapshot_valid = 0;
+}
+
+// Map the daemon's shared-memory snapshot if it publishes one
+static void feed_map_shm(feed_client_t* feed) {
+    if (feed->shm.base) return;
+    if (!feed->shm_snapshot.records && inotify_shm_snapshot_init(&feed->shm_snapshot) != 0) return;
+    if (inotify_shm_open_reader(&feed->shm) != 0) return;
+    feed->shm_snapshot_valid = 0;
+}
+
+// Drop the live table
+static void feed_clear_entries(feed_client_t* feed) {
+    for (size_t i = 0; i < feed->entry_count; i++) {
+        free(feed->entries[i].path);
+    }
+    feed->entry_count = 0;
+}
+
+// Close the connection and forget all received state
+void feed_close(feed_client_t* feed) {
+    if (!feed) return;
+
+    if (feed->fd >= 0) {
+        close(feed->fd);
+        feed->fd = -1;
+    }
+    feed_unmap_shm(feed);
+    inotify_shm_snapshot_free(&feed->shm_snapshot);
+    feed_clear_entries(feed);
+    free(feed->entries);
+    feed->entries = NULL;
+    feed->entry_capacity = 0;
+    free(feed->buffer);
+    feed->buffer = NULL;
+    feed->buffer_len = 0;
+    feed->in_snapshot = 0;
+    feed->initial_snapshot_done = 0;
+}
+
+// Connect to the daemon socket and subscribe
+// Returns: 0 on success, -1 if the daemon is not reachable
+int feed_connect(feed_client_t* feed) {
+    if (!feed) return -1;
+    if (feed->fd >= 0) return 0;
+
+    // Rate limit connection attempts while the daemon is down
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    long since_last_ms = (now.tv_sec - feed->last_connect_attempt.tv_sec) * 1000 +
+                         (now.tv_nsec - feed->last_connect_attempt.tv_nsec) / 1000000;
+    if (feed->last_connect_attempt.tv_sec != 0 && since_last_ms < FEED_RECONNECT_INTERVAL_MS) {
+        return -1;
+    }
+    feed->last_connect_attempt = now;
+
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (inotify_socket_path(addr.sun_path, sizeof(addr.sun_path)) != 0) return -1;
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+
+    if (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+
+    // Hold a session reference on the shared daemon for as long as we are connected
+    const char* command = INOTIFY_CMD_ATTACH "\n" INOTIFY_CMD_SUBSCRIBE "\n";
+    if (send(fd, command, strlen(command), MSG_NOSIGNAL) != (ssize_t)strlen(command)) {
+        close(fd);
+        return -1;
+    }
+
+    int flags = fcntl(fd, F_GETFL, 0);
+    fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+
+    if (!feed->buffer) {
+        feed->buffer = malloc(FEED_BUFFER_SIZE);
+        if (!feed->buffer) {
+            close(fd);
+            return -1;
+        }
+    }
+
+    feed->fd = fd;
+    feed->buffer_len = 0;
+    feed->in_snapshot = 0;
+    feed->initial_snapshot_done = 0;
+    feed_clear_entries(feed);
+    feed_map_shm(feed);
+    return 0;
+}
+
+// Attach to the workspace's shared inotify-daemon, starting it if no session has
+// Returns: 0 once connected, -1 while the daemon is not (yet) reachable
+int feed_ensure_daemon(feed_client_t* feed) {
+    if (!feed) return -1;
+    if (feed_connect(feed) == 0) return 0;
+
+    // The daemon's workspace lock makes concurrent launches from several sessions harmless
+    time_t now = time(NULL);
+    if (now - feed->last_daemon_launch < FEED_LAUNCH_INTERVAL_SECONDS) return -1;
+    feed->last_daemon_launch = now;
+
+    if (access("./inotify-watcher/inotify-daemon", X_OK) == 0) {
+        if (run_command("cd inotify-watcher && ./inotify-daemon --exit-when-idle > /dev/null 2>&1") == 0) {
+            fprintf(stderr, "Shared inotify-daemon launched\n");
+        }
+        return -1;
+    }
+
+    // No shared daemon available - fall back to this session's own stream watcher
+    if (!feed->fallback_watcher_launched &&
+        run_command("./file-changes-watcher/file-changes-watcher > /dev/null 2>&1") == 0) {
+        feed->fallback_watcher_launched = 1;
+        fprintf(stderr, "File-changes-watcher daemon launched\n");
+    }
+    return -1;
+}
+
+// Whether the client currently holds a live subscription
+int feed_is_connected(const feed_client_t* feed) {
+    return feed && feed->fd >= 0;
+}
+
+// Find an entry by display path
+static feed_entry_t* feed_find_entry(feed_client_t* feed, const char* path) {
+    for (size_t i = 0; i < feed->entry_count; i++) {
+        if (strcmp(feed->entries[i].path, path) == 0) {
+            return &feed->entries[i];
+        }
+    }
+    return NULL;
+}
+
+// Apply a change record: C <event> <first> <last> <repository> <path>
+// Returns: 1 if the live table changed, 0 otherwise
+static int feed_apply_change(feed_client_t* feed, char* fields) {
+    char* parts[5];
+    for (int i = 0; i < 5; i++) {
+        parts[i] = fields;
+        if (i < 4) {
+            char* tab = strchr(fields, '\t');
+            if (!tab) return 0;
+            *tab = '\0';
+            fields = tab + 1;
+        }
+    }
+
+    time_t last_updated = (time_t)strtol(parts[2], NULL, 10);
+    if (time(NULL) - last_updated >= FEED_ACTIVE_WINDOW_SECONDS) {
+        return 0; // Too old to animate
+    }
+
+    char display_path[4096];
+    snprintf(display_path, sizeof(display_path), "%s/%s", parts[3], parts[4]);
+
+    feed_entry_t* entry = feed_find_entry(feed, display_path);
+    if (entry) {
+        entry->stale = 0;
+        if (entry->last_updated == last_updated) return 0;
+        entry->last_updated = last_updated;
+        entry->from_initial_snapshot = 0; // Touched during this session
+        return 1;
+    }
+
+    if (feed->entry_count >= feed->entry_capacity) {
+        size_t new_capacity = feed->entry_capacity == 0 ? 32 : feed->entry_capacity * 2;
+        feed_entry_t* new_entries = realloc(feed->entries, new_capacity * sizeof(feed_entry_t));
+        if (!new_entries) return 0;
+        feed->entries = new_entries;
+        feed->entry_capacity = new_capacity;
+    }
+
+    entry = &feed->entries[feed->entry_count];
+    entry->path = strdup(display_path);
+    if (!entry->path) return 0;
+    entry->last_updated = last_updated;
+    entry->from_initial_snapshot = !feed->initial_snapshot_done;
+    entry->stale = 0;
+    feed->entry_count++;
+    return 1;
+}
+
+// Drop entries a finished snapshot no longer contains
+static void feed_drop_stale_entries(feed_client_t* feed) {
+    size_t write_idx = 0;
+    for (size_t i = 0; i < feed->entry_count; i++) {
+        if (feed->entries[i].stale) {
+            free(feed->entries[i].path);
+        } else {
+            feed->entries[write_idx++] = feed->entries[i];
+        }
+    }
+    feed->entry_count = write_idx;
+}
+
+// Handle one complete record line
+static int feed_handle_line(feed_client_t* feed, char* line) {
+    switch (line[0]) {
+        case INOTIFY_RECORD_SNAPSHOT_BEGIN:
+            // Everything not repeated by the snapshot is gone
+            for (size_t i = 0; i < feed->entry_count; i++) {
+                feed->entries[i].stale = 1;
+            }
+            feed->in_snapshot = 1;
+            return 0;
+        case INOTIFY_RECORD_SNAPSHOT_END:
+            feed_drop_stale_entries(feed);
+            feed->in_snapshot = 0;
+            feed->initial_snapshot_done = 1;
+            return 1;
+        case INOTIFY_RECORD_CHANGE:
+            if (line[1] != '\t') return 0;
+            return feed_apply_change(feed, line + 2);
+        default:
+            // Hello and resync markers carry no table data
+            return 0;
+    }
+}
+
+// Read everything the daemon has sent and apply it to the live table
+// Returns: number of table changes, -1 if the connection was lost
+int feed_process(feed_client_t* feed) {
+    if (!feed || feed->fd < 0) return -1;
+
+    int changes = 0;
+    for (;;) {
+        ssize_t n = read(feed->fd, feed->buffer + feed->buffer_len, FEED_BUFFER_SIZE - feed->buffer_len - 1);
+        if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+            close(feed->fd);
+            feed->fd = -1;
+            feed_unmap_shm(feed); // The daemon is gone; a new one creates a new region
+            return -1;
+        }
+        if (n < 0) break;
+
+        feed->buffer_len += (size_t)n;
+        feed->buffer[feed->buffer_len] = '\0';
+
+        char* line = feed->buffer;
+        char* newline;
+        while ((newline = memchr(line, '\n', feed->buffer_len - (size_t)(line - feed->buffer))) != NULL) {
+            *newline = '\0';
+            changes += feed_handle_line(feed, line);
+            line = newline + 1;
+        }
+
+        // Keep the partial record for the next read
+        size_t remaining = feed->buffer_len - (size_t)(line - feed->buffer);
+        if (remaining >= FEED_BUFFER_SIZE - 1) {
+            remaining = 0; // Oversized record, resynchronise on the next newline
+        }
+        memmove(feed->buffer, line, remaining);
+        feed->buffer_len = remaining;
+    }
+
+    // Only report changes once the table is consistent
+    return feed->in_snapshot ? 0 : changes;
+}
+
+// Build the active file list straight from the shared-memory snapshot
+// Returns: 0 on success, -1 if the region could not be read
+static int feed_get_shm_active_files(feed_client_t* feed, active_file_info_t** result, size_t* active_count) {
+    if (inotify_shm_is_closed(&feed->shm)) {
+        feed_unmap_shm(feed);
+        return -1;
+    }
+
+    // Copy only when the daemon published something new
+    uint64_t sequence = inotify_shm_sequence(&feed->shm);
+    if (!feed->shm_snapshot_valid || sequence != feed->shm_snapshot.sequence) {
+        if (inotify_shm_read(&feed->shm, &feed->shm_snapshot) != 0) return -1;
+        feed->shm_snapshot_valid = 1;
+    }
+
+    inotify_shm_snapshot_t* snapshot = &feed->shm_snapshot;
+    time_t now = time(NULL);
+
+    active_file_info_t* active_files = calloc(snapshot->record_count ? snapshot->record_count : 1, sizeof(active_file_info_t));
+    if (!active_files) return -1;
+
+    for (uint32_t i = 0; i < snapshot->record_count; i++) {
+        const inotify_shm_record_t* record = &snapshot->records[i];
+        time_t last_updated = (time_t)record->last_updated;
+        if (last_updated < feed->session_start) continue; // Already changed before this session
+        if (now - last_updated >= FEED_ACTIVE_WINDOW_SECONDS) continue;
+
+        char display_path[4096];
+        snprintf(display_path, sizeof(display_path), "%s/%s",
+                 snapshot->strings + record->repository_offset, snapshot->strings + record->path_offset);
+
+        active_file_info_t* info = &active_files[*active_count];
+        info->path = strdup(display_path);
+        if (!info->path) continue;
+        info->last_updated = last_updated;
+        (*active_count)++;
+    }
+
+    *result = active_files;
+    return 0;
+}
+
+// Return the files changed during this session that are still active
+active_file_info_t* feed_get_active_files(feed_client_t* feed, size_t* active_count) {
+    *active_count = 0;
+    if (!feed) return NULL;
+
+    // Prefer the shared-memory snapshot: no syscalls, no parsing
+    if (feed->shm.base) {
+        active_file_info_t* active_files = NULL;
+        if (feed_get_shm_active_files(feed, &active_files, active_count) == 0) {
+            return active_files;
+        }
+        *active_count = 0;
+    }
+
+    if (feed->entry_count == 0) return NULL;
+
+    time_t now = time(NULL);
+
+    // Expire entries that left the active window
+    size_t write_idx = 0;
+    for (size_t i = 0; i < feed->entry_count; i++) {
+        if (now - feed->entries[i].last_updated >= FEED_ACTIVE_WINDOW_SECONDS) {
+            free(feed->entries[i].path);
+        } else {
+            feed->entries[write_idx++] = feed->entries[i];
+        }
+    }
+    feed->entry_count = write_idx;
+
+    active_file_info_t* active_files = calloc(feed->entry_count ? feed->entry_count : 1, sizeof(active_file_info_t));
+    if (!active_files) return NULL;
+
+    for (size_t i = 0; i < feed->entry_count; i++) {
+        feed_entry_t* entry = &feed->entries[i];
+        if (entry->from_initial_snapshot) continue; // Already dirty before this session
+
+        active_file_info_t* info = &active_files[*active_count];
+        info->path = strdup(entry->path);
+        if (!info->path) continue;
+        info->last_updated = entry->last_updated;
+        (*active_count)++;
+    }
+
+    return active_files;
+}
@@ -0,0 +1,234 @@
+#include "../three-pane-tui.h"
+
+// "/" filter for panes 1 and 2: a case-insensitive subsequence match of the
+// query against each item row's text. Repository headers are kept above the
+// items that match under them.
+
+#define PANE_FILTER_NO_HEADER UINT32_MAX
+
+#define ONES 0x0101010101010101ULL
+#define HIGHS 0x8080808080808080ULL
+
+static inline unsigned char fold_byte(unsigned char c) {
+    return (unsigned char)(c | ((unsigned)(c - 'A') < 26u) << 5);
+}
+
+static inline uint64_t byte_bit(unsigned char c) {
+    return (uint64_t)1 << (fold_byte(c) & 63);
+}
+
+// Returns: offset of the first byte at or after start that folds to c
+// (c already folded), or length if there is none. Eight bytes are compared
+// at a time: for a letter, setting bit 5 of every byte folds exactly its
+// uppercase form onto it, so one zero-byte test covers both cases.
+static size_t find_folded(const char* text, size_t start, size_t length, unsigned char c) {
+    int letter = c >= 'a' && c <= 'z';
+    uint64_t fold = letter ? ONES * 0x20 : 0;
+    uint64_t pattern = ONES * c;
+
+    size_t i = start;
+    for (; i + 8 <= length; i += 8) {
+        uint64_t word;
+        memcpy(&word, text + i, sizeof(word));
+        uint64_t x = (word | fold) ^ pattern;
+        if ((x - ONES) & ~x & HIGHS) break;  // Some byte of x is zero
+    }
+    for (; i < length; i++) {
+        if (fold_byte((unsigned char)text[i]) == c) return i;
+    }
+    return length;
+}
+
+// Bit (lowercase byte & 63) set for every byte of text; a query byte whose
+// bit is clear cannot match
+uint64_t pane_filter_byte_mask(const char* text) {
+    uint64_t mask = 0;
+    for (const unsigned char* p = (const unsigned char*)text; *p; p++) {
+        mask |= byte_bit(*p);
+    }
+    return mask;
+}
+
+// Drop every match set from depth onwards
+static void pane_filter_pop(pane_filter_t* filter, size_t depth) {
+    while (filter->depth > depth) {
+        filter->depth--;
+        free(filter->levels[filter->depth]);
+        filter->levels[filter->depth] = NULL;
+        filter->level_counts[filter->depth] = 0;
+    }
+}
+
+// Forget the candidates along with the rows they came from
+static void pane_filter_clear(pane_filter_t* filter) {
+    pane_filter_pop(filter, 0);
+    free(filter->candidates);
+    filter->candidates = NULL;
+    filter->candidate_count = 0;
+    filter->candidates_built = 0;
+    free(filter->shown);
+    filter->shown = NULL;
+    filter->shown_count = 0;
+}
+
+// Collect the pane's item rows with their byte masks, once per rows; the
+// TREE view's were collected with its rows
+// Returns: 0 on success, -1 on allocation failure
+static int pane_filter_build_candidates(pane_filter_t* filter) {
+    if (filter->candidates_built) return 0;
+
+    const pane_rows_t* rows = filter->rows;
+    size_t count = rows ? rows->count : 0;
+    filter->candidates = malloc((count ? count : 1) * sizeof(pane_filter_candidate_t));
+    filter->shown = malloc((count ? count : 1) * sizeof(uint32_t));
+    if (!filter->candidates || !filter->shown) return -1;
+
+    if (rows && rows->tree_count > 0) {
+        memcpy(filter->candidates, rows->candidates, rows->candidate_count * sizeof(pane_filter_candidate_t));
+        filter->candidate_count = rows->candidate_count;
+        filter->candidates_built = 1;
+        return 0;
+    }
+
+    uint32_t header = PANE_FILTER_NO_HEADER;
+    for (size_t i = 0; i < count; i++) {
+        const pane_row_t* row = &rows->rows[i];
+        if (!row->text) continue;
+        if (row->kind == PANE_ROW_HEADER) {
+            header = (uint32_t)i;
+            continue;
+        }
+
+        pane_filter_candidate_t* candidate = &filter->candidates[filter->candidate_count++];
+        candidate->text = row->text;
+        candidate->byte_mask = row->byte_mask;
+        candidate->length = (uint32_t)strlen(row->text);
+        candidate->row = (uint32_t)i;
+        candidate->header = header;
+    }
+    filter->candidates_built = 1;
+    return 0;
+}
+
+// Match one more query byte: only the previous byte's matches are searched,
+// each from where its match ended, since the leftmost match of a prefix
+// leaves the most room for the rest of the query
+// Returns: 0 on success, -1 on allocation failure
+static int pane_filter_push(pane_filter_t* filter, unsigned char c) {
+    size_t depth = filter->depth;
+    size_t previous_count = depth > 0 ? filter->level_counts[depth - 1] : filter->candidate_count;
+    const pane_filter_match_t* previous = depth > 0 ? filter->levels[depth - 1] : NULL;
+
+    pane_filter_match_t* matches = malloc((previous_count ? previous_count : 1) * sizeof(pane_filter_match_t));
+    if (!matches) return -1;
+
+    uint64_t bit = byte_bit(c);
+    size_t count = 0;
+    for (size_t i = 0; i < previous_count; i++) {
+        uint32_t index = previous ? previous[i].candidate : (uint32_t)i;
+        const pane_filter_candidate_t* candidate = &filter->candidates[index];
+        if (!(candidate->byte_mask & bit)) continue;
+
+        size_t found = find_folded(candidate->text, previous ? previous[i].end : 0, candidate->length, c);
+        if (found == candidate->length) continue;
+
+        matches[count].candidate = index;
+        matches[count].end = (uint32_t)(found + 1);
+        count++;
+    }
+
+    filter->query[depth] = (char)c;
+    filter->levels[depth] = matches;
+    filter->level_counts[depth] = count;
+    filter->depth++;
+    return 0;
+}
+
+// Collect the candidates for rows ahead of the first query byte
+// Returns: 0 on success, -1 on allocation failure
+int pane_filter_prepare(pane_filter_t* filter, const pane_rows_t* rows) {
+    if (filter->rows != rows) {
+        pane_filter_clear(filter);
+        filter->rows = rows;
+    }
+    if (pane_filter_build_candidates(filter) != 0) {
+        pane_filter_clear(filter);
+        return -1;
+    }
+    return 0;
+}
+
+// Narrow a pane's rows to those matching the query. Rows are only rescanned
+// when they changed; a query that extends or shortens the previous one
+// reuses the match sets they share.
+// Returns: number of rows to draw (all rows for an empty query)
+size_t pane_filter_update(pane_filter_t* filter, const pane_rows_t* rows, const char* query, size_t len) {
+    if (len > PANE_FILTER_QUERY_MAX) len = PANE_FILTER_QUERY_MAX;
+
+    filter->active = 0;
+    if (len == 0) {
+        if (filter->rows != rows) pane_filter_clear(filter);
+        filter->rows = rows;
+        pane_filter_pop(filter, 0);
+        return rows ? rows->count : 0;
+    }
+    if (pane_filter_prepare(filter, rows) != 0) return rows ? rows->count : 0;
+    filter->active = 1;
+
+    // Keep the match sets of the prefix this query shares with the last one
+    size_t common = 0;
+    while (common < filter->depth && common < len &&
+           filter->query[common] == (char)fold_byte((unsigned char)query[common])) {
+        common++;
+    }
+    pane_filter_pop(filter, common);
+    while (filter->depth < len) {
+        if (pane_filter_push(filter, fold_byte((unsigned char)query[filter->depth])) != 0) break;
+    }
+    if (filter->depth == 0) {
+        filter->active = 0;
+        return rows ? rows->count : 0;
+    }
+
+    // Rows to draw: each match below its repository header, in pane order
+    const pane_filter_match_t* matches = filter->levels[filter->depth - 1];
+    size_t match_count = filter->level_counts[filter->depth - 1];
+    uint32_t last_header = PANE_FILTER_NO_HEADER;
+    filter->shown_count = 0;
+    for (size_t i = 0; i < match_count; i++) {
+        const pane_filter_candidate_t* candidate = &filter->candidates[matches[i].candidate];
+        if (candidate->header != PANE_FILTER_NO_HEADER && candidate->header != last_header) {
+            filter->shown[filter->shown_count++] = candidate->header;
+            last_header = candidate->header;
+        }
+        filter->shown[filter->shown_count++] = candidate->row;
+    }
+    return filter->shown_count;
+}
+
+// Map a drawn row to its pane row
+size_t pane_filter_row(const pane_filter_t* filter, size_t index) {
+    if (!filter->active) return index;
+    return index < filter->shown_count ? filter->shown[index] : SIZE_MAX;
+}
+
+void pane_filter_free(pane_filter_t* filter) {
+    pane_filter_clear(filter);
+    filter->rows = NULL;
+    filter->active = 0;
+}
+
+// Apply the current "/" query to panes 1 and 2 and size them to what it shows;
+// while it is being typed the candidates are collected up front, so the first
+// keystroke only has to match
+void apply_pane_filters(three_pane_tui_orchestrator_t* orch) {
+    three_pane_data_t* data = &orch->data;
+    if (data->filter_editing) {
+        pane_filter_prepare(&data->pane1_filter, data->pane1_rows);
+        pane_filter_prepare(&data->pane2_filter, data->pane2_rows);
+    }
+    data->pane1_count = pane_filter_update(&data->pane1_filter, data->pane1_rows,
+                                           data->filter_query, data->filter_query_len);
+    data->pane2_count = pane_filter_update(&data->pane2_filter, data->pane2_rows,
+                                           data->filter_query, data->filter_query_len);
+}
@@ -0,0 +1,837 @@
+#include "../three-pane-tui.h"
+
+// Headless rendering: the normal drawing code runs against an in-memory
+// virtual terminal instead of a TTY, driven by a script of scrolls, resizes,
+// view toggles, filter queries and animation ticks over synthetic or
+// recorded pane data. Each frame's render time and output bytes are
+// measured, plus heap allocations in the three-pane-tui-bench build, and the
+// final screen can be dumped as text for golden comparisons.
+//
+//   three-pane-tui --headless [--size WxH] [--files N] [--repos N] [--commits N]
+//                  [--animations N] [--data FILE] [--script STEPS] [--repeat N]
+//                  [--view flat|tree] [--dump FILE]
+//   three-pane-tui --headless --record FILE
+//
+// Script steps are comma separated:
+//   repaint          full redraw
+//   scroll:P:N       scroll pane P by N rows, one row per frame (negative is up)
+//   resize:WxH       resize the virtual terminal
+//   toggle           switch between the FLAT and TREE views
+//   tick:N           N pane 3 animation frames at animation_fps
+//   filter:TEXT      type TEXT into the "/" filter, one frame per byte;
+//                    an empty TEXT clears the filter
+//
+// Recorded data (--data, written from the live repositories by --record) is
+// one tab-separated record per line:
+//   dirty <repo path> <file>       a dirty file
+//   commit <repo path> <subject>   an unpushed commit
+//   file <repo path> <file>        a file of the repository's last commit
+//   submodule <name>               a submodule, left out of the file lists
+
+#define HEADLESS_DEFAULT_WIDTH 120
+#define HEADLESS_DEFAULT_HEIGHT 40
+#define HEADLESS_DEFAULT_FILES 20000
+#define HEADLESS_DEFAULT_REPOS 8
+#define HEADLESS_DEFAULT_COMMITS 200
+#define HEADLESS_DEFAULT_ANIMATIONS 12
+#define HEADLESS_DEFAULT_SCRIPT "repaint,scroll:1:60,scroll:1:-60,scroll:2:30,toggle,scroll:1:60,toggle," \
+                                "tick:60,filter:src,filter:,resize:100x30,tick:30,resize:160x50,repaint"
+#define HEADLESS_MAX_DIMENSION 1000
+#define HEADLESS_VTERM_TAIL 0xFFFFFFFFu  // Right half of a wide glyph
+
+// Allocations are counted only in the three-pane-tui-bench build, which links
+// with -Wl,--wrap for each of these so every allocation the program's own
+// code makes passes through a counter; elsewhere the allocator is untouched
+static uint64_t allocation_count;
+
+#ifdef TPT_COUNT_ALLOCATIONS
+#define ALLOCATIONS_COUNTED 1
+
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t count, size_t size);
+void* __real_realloc(void* ptr, size_t size);
+char* __real_strdup(const char* s);
+char* __real_strndup(const char* s, size_t n);
+
+void* __wrap_malloc(size_t size) {
+    __atomic_add_fetch(&allocation_count, 1, __ATOMIC_RELAXED);
+    return __real_malloc(size);
+}
+
+void* __wrap_calloc(size_t count, size_t size) {
+    __atomic_add_fetch(&allocation_count, 1, __ATOMIC_RELAXED);
+    return __real_calloc(count, size);
+}
+
+void* __wrap_realloc(void* ptr, size_t size) {
+    __atomic_add_fetch(&allocation_count, 1, __ATOMIC_RELAXED);
+    return __real_realloc(ptr, size);
+}
+
+char* __wrap_strdup(const char* s) {
+    __atomic_add_fetch(&allocation_count, 1, __ATOMIC_RELAXED);
+    return __real_strdup(s);
+}
+
+char* __wrap_strndup(const char* s, size_t n) {
+    __atomic_add_fetch(&allocation_count, 1, __ATOMIC_RELAXED);
+    return __real_strndup(s, n);
+}
+#else
+#define ALLOCATIONS_COUNTED 0
+#endif
+
+// Virtual terminal: a grid of code points that understands the sequences
+// the screen module writes (cursor position and forward, erase, SGR)
+typedef struct {
+    uint32_t* cells;
+    int width;
+    int height;
+    int row;            // Cursor, 1-based; col == width + 1 is a pending wrap
+    int col;
+    int after_joiner;
+} vterm_t;
+
+typedef enum {
+    STEP_REPAINT,
+    STEP_SCROLL,
+    STEP_RESIZE,
+    STEP_TOGGLE,
+    STEP_TICK,
+    STEP_FILTER,
+    STEP_KIND_COUNT
+} step_kind_t;
+
+static const char* const step_names[STEP_KIND_COUNT] = {
+    "repaint", "scroll", "resize", "toggle", "tick", "filter"
+};
+
+typedef struct {
+    uint64_t ns;
+    size_t bytes;
+    uint64_t allocations;
+    uint8_t kind;       // step_kind_t
+} headless_frame_t;
+
+typedef struct {
+    three_pane_tui_orchestrator_t* orch;
+    vterm_t vterm;
+    char* output;       // Frame output, fed to the virtual terminal after timing
+    size_t output_len;
+    size_t output_capacity;
+    headless_frame_t* frames;
+    size_t frame_count;
+    size_t frame_capacity;
+    int width;
+    int height;
+    int64_t animation_ms;  // Virtual time since the animations started
+} headless_run_t;
+
+static void vterm_resize(vterm_t* vterm, int width, int height) {
+    free(vterm->cells);
+    vterm->cells = malloc((size_t)width * (size_t)height * sizeof(uint32_t));
+    vterm->width = vterm->cells ? width : 0;
+    vterm->height = vterm->cells ? height : 0;
+    for (size_t i = 0; i < (size_t)vterm->width * (size_t)vterm->height; i++) {
+        vterm->cells[i] = ' ';
+    }
+    vterm->row = vterm->col = 1;
+}
+
+static void vterm_erase(vterm_t* vterm, int from_row, int from_col, int to_row, int to_col) {
+    for (int row = from_row; row <= to_row; row++) {
+        int first = row == from_row ? from_col : 1;
+        int last = row == to_row ? to_col : vterm->width;
+        for (int col = first; col <= last; col++) {
+            vterm->cells[(size_t)(row - 1) * vterm->width + (col - 1)] = ' ';
+        }
+    }
+}
+
+static void vterm_put(vterm_t* vterm, uint32_t cp) {
+    int width = glyph_width(cp, &vterm->after_joiner);
+    if (width <= 0 || vterm->width == 0) return; // Combining marks stay with the glyph before them
+
+    if (vterm->col + width - 1 > vterm->width) {
+        vterm->col = 1;
+        if (vterm->row < vterm->height) vterm->row++;
+    }
+    uint32_t* cell = &vterm->cells[(size_t)(vterm->row - 1) * vterm->width + (vterm->col - 1)];
+    cell[0] = cp;
+    if (width == 2) cell[1] = HEADLESS_VTERM_TAIL;
+    vterm->col += width;
+}
+
+static void vterm_csi(vterm_t* vterm, char final, const int* params, int count) {
+    int first = count > 0 ? params[0] : 0;
+    switch (final) {
+        case 'H':
+        case 'f':
+            vterm->row = first > 0 ? first : 1;
+            vterm->col = count > 1 && params[1] > 0 ? params[1] : 1;
+            if (vterm->row > vterm->height) vterm->row = vterm->height;
+            if (vterm->col > vterm->width) vterm->col = vterm->width;
+            break;
+        case 'C':
+            vterm->col += first > 0 ? first : 1;
+            if (vterm->col > vterm->width) vterm->col = vterm->width;
+            break;
+        case 'J':
+            if (first == 2 || first == 3) vterm_erase(vterm, 1, 1, vterm->height, vterm->width);
+            else if (first == 0) vterm_erase(vterm, vterm->row, vterm->col, vterm->height, vterm->width);
+            break;
+        case 'K':
+            vterm_erase(vterm, vterm->row, first == 0 ? vterm->col : 1,
+                        vterm->row, first == 1 ? vterm->col : vterm->width);
+            break;
+        default:
+            break; // SGR and private modes don't change the text
+    }
+}
+
+// Apply terminal output; frames arrive whole, so sequences never straddle calls
+static void vterm_feed(vterm_t* vterm, const char* data, size_t len) {
+    size_t i = 0;
+    while (i < len) {
+        if (data[i] == '\033' && i + 1 < len && data[i + 1] == '[') {
+            i += 2;
+            if (i < len && data[i] == '?') i++;
+            int params[8];
+            int count = 0;
+            int value = 0, has_value = 0;
+            while (i < len && ((data[i] >= '0' && data[i] <= '9') || data[i] == ';')) {
+                if (data[i] == ';') {
+                    if (count < 8) params[count++] = value;
+                    value = has_value = 0;
+                } else {
+                    value = value * 10 + (data[i] - '0');
+                    has_value = 1;
+                }
+                i++;
+            }
+            if (has_value && count < 8) params[count++] = value;
+            if (i < len) vterm_csi(vterm, data[i++], params, count);
+            continue;
+        }
+
+        uint32_t cp;
+        size_t n = utf8_decode(data + i, len - i, &cp);
+        if (cp >= ' ') vterm_put(vterm, cp);
+        i += n;
+    }
+}
+
+// Write the screen as text, one line per row without trailing blanks
+static void vterm_dump(const vterm_t* vterm, FILE* fp) {
+    for (int row = 0; row < vterm->height; row++) {
+        const uint32_t* cells = &vterm->cells[(size_t)row * vterm->width];
+        int last = vterm->width;
+        while (last > 0 && cells[last - 1] == ' ') last--;
+        for (int col = 0; col < last; col++) {
+            uint32_t cp = cells[col];
+            if (cp == HEADLESS_VTERM_TAIL) continue;
+            char bytes[4];
+            size_t n = utf8_encode(cp, bytes);
+            fwrite(bytes, 1, n, fp);
+        }
+        fputc('\n', fp);
+    }
+}
+
+// Screen sink: keep the frame's bytes until its timing is taken
+static void headless_capture(const char* data, size_t len, void* context) {
+    headless_run_t* run = context;
+    if (run->output_len + len > run->output_capacity) {
+        size_t capacity = run->output_capacity ? run->output_capacity : 65536;
+        while (capacity < run->output_len + len) capacity *= 2;
+        char* output = realloc(run->output, capacity);
+        if (!output) return;
+        run->output = output;
+        run->output_capacity = capacity;
+    }
+    memcpy(run->output + run->output_len, data, len);
+    run->output_len += len;
+}
+
+// Data for panes 1 and 2, as the collectors would have produced it
+typedef struct {
+    dirty_collection_t* dirty;
+    unpushed_collection_t* unpushed;
+    char** submodules;
+    size_t submodule_count;
+    size_t submodule_capacity;
+} headless_data_t;
+
+static void data_add_dirty_file(dirty_repo_t* repo, const char* file) {
+    if (repo->file_count >= repo->file_capacity) {
+        size_t capacity = repo->file_capacity ? repo->file_capacity * 2 : 16;
+        char** files = realloc(repo->dirty_files, capacity * sizeof(char*));
+        if (!files) return;
+        repo->dirty_files = files;
+        repo->file_capacity = capacity;
+    }
+    repo->dirty_files[repo->file_count] = strdup(file);
+    if (repo->dirty_files[repo->file_count]) repo->file_count++;
+}
+
+static void data_add_commit(unpushed_repo_t* repo, const char* subject) {
+    if (repo->commit_count >= repo->commit_capacity) {
+        size_t capacity = repo->commit_capacity ? repo->commit_capacity * 2 : 8;
+        char** commits = realloc(repo->unpushed_commits, capacity * sizeof(char*));
+        if (commits) repo->unpushed_commits = commits;
+        char*** files = realloc(repo->commit_files, capacity * sizeof(char**));
+        if (files) repo->commit_files = files;
+        size_t* counts = realloc(repo->commit_file_counts, capacity * sizeof(size_t));
+        if (counts) repo->commit_file_counts = counts;
+        if (!commits || !files || !counts) return;
+        repo->commit_capacity = capacity;
+    }
+    char* copy = strdup(subject);
+    if (!copy) return;
+    repo->unpushed_commits[repo->commit_count] = copy;
+    repo->commit_files[repo->commit_count] = NULL;
+    repo->commit_file_counts[repo->commit_count] = 0;
+    repo->commit_count++;
+}
+
+static void data_add_commit_file(unpushed_repo_t* repo, const char* file) {
+    if (repo->commit_count == 0) return;
+    size_t commit = repo->commit_count - 1;
+    size_t count = repo->commit_file_counts[commit];
+    char** files = realloc(repo->commit_files[commit], (count + 1) * sizeof(char*));
+    if (!files) return;
+    repo->commit_files[commit] = files;
+    files[count] = strdup(file);
+    if (files[count]) repo->commit_file_counts[commit]++;
+}
+
+// Repository of the collections by path, added to both if it is new
+// Returns: index of the repository in both collections, or -1 on failure
+static long data_repo(headless_data_t* data, const char* path) {
+    for (size_t i = data->dirty->count; i > 0; i--) {
+        if (strcmp(data->dirty->repos[i - 1].repo_path, path) == 0) return (long)(i - 1);
+    }
+    const char* name = strrchr(path, '/');
+    name = name && name[1] ? name + 1 : path;
+    size_t count = data->dirty->count;
+    add_dirty_repo(data->dirty, path, name);
+    add_unpushed_repo(data->unpushed, path, name);
+    if (data->dirty->count != count + 1 || data->unpushed->count != count + 1) return -1;
+    return (long)count;
+}
+
+static void data_add_submodule(headless_data_t* data, const char* name) {
+    if (data->submodule_count == data->submodule_capacity) {
+        size_t capacity = data->submodule_capacity ? data->submodule_capacity * 2 : 16;
+        char** submodules = realloc(data->submodules, capacity * sizeof(char*));
+        if (!submodules) return;
+        data->submodules = submodules;
+        data->submodule_capacity = capacity;
+    }
+    data->submodules[data->submodule_count] = strdup(name);
+    if (data->submodules[data->submodule_count]) data->submodule_count++;
+}
+
+static void data_free(headless_data_t* data) {
+    dirty_collection_cleanup(data->dirty);
+    unpushed_collection_cleanup(data->unpushed);
+    for (size_t i = 0; i < data->submodule_count; i++) {
+        free(data->submodules[i]);
+    }
+    free(data->submodules);
+    memset(data, 0, sizeof(*data));
+}
+
+// Load recorded pane data
+// Returns: 0 on success, -1 if the file could not be read
+static int data_load(headless_data_t* data, const char* filename) {
+    FILE* fp = fopen(filename, "r");
+    if (!fp) {
+        perror(filename);
+        return -1;
+    }
+
+    char line[4096];
+    while (fgets(line, sizeof(line), fp)) {
+        line[strcspn(line, "\n")] = '\0';
+        char* kind = line;
+        char* repo = strchr(kind, '\t');
+        if (!repo) continue;
+        *repo++ = '\0';
+
+        if (strcmp(kind, "submodule") == 0) {
+            data_add_submodule(data, repo);
+            continue;
+        }
+        char* value = strchr(repo, '\t');
+        if (!value) continue;
+        *value++ = '\0';
+
+        long index = data_repo(data, repo);
+        if (index < 0) continue;
+        if (strcmp(kind, "dirty") == 0) {
+            data_add_dirty_file(&data->dirty->repos[index], value);
+        } else if (strcmp(kind, "commit") == 0) {
+            data_add_commit(&data->unpushed->repos[index], value);
+        } else if (strcmp(kind, "file") == 0) {
+            data_add_commit_file(&data->unpushed->repos[index], value);
+        }
+    }
+    fclose(fp);
+    return 0;
+}
+
+// Write what the collectors find in the live repositories as recorded data
+// Returns: 0 on success, -1 on error
+static int data_record(const char* filename) {
+    dirty_collection_t* dirty;
+    unpushed_collection_t* unpushed;
+    char** submodules;
+    size_t submodule_count;
+    if (collect_pane_data(&dirty, &unpushed, &submodules, &submodule_count) != 0) return -1;
+
+    FILE* fp = fopen(filename, "w");
+    if (fp) {
+        for (size_t i = 0; i < submodule_count; i++) {
+            fprintf(fp, "submodule\t%s\n", submodules[i]);
+        }
+        for (size_t i = 0; i < dirty->count; i++) {
+            const dirty_repo_t* repo = &dirty->repos[i];
+            for (size_t j = 0; j < repo->file_count; j++) {
+                fprintf(fp, "dirty\t%s\t%s\n", repo->repo_path, repo->dirty_files[j]);
+            }
+        }
+        for (size_t i = 0; i < unpushed->count; i++) {
+            const unpushed_repo_t* repo = &unpushed->repos[i];
+            for (size_t j = 0; j < repo->commit_count; j++) {
+                fprintf(fp, "commit\t%s\t%s\n", repo->repo_path, repo->unpushed_commits[j]);
+                for (size_t k = 0; k < repo->commit_file_counts[j]; k++) {
+                    fprintf(fp, "file\t%s\t%s\n", repo->repo_path, repo->commit_files[j][k]);
+                }
+            }
+        }
+        fclose(fp);
+    } else {
+        perror(filename);
+    }
+
+    dirty_collection_cleanup(dirty);
+    unpushed_collection_cleanup(unpushed);
+    for (size_t i = 0; i < submodule_count; i++) {
+        free(submodules[i]);
+    }
+    free(submodules);
+    return fp ? 0 : -1;
+}
+
+// xorshift64: the same synthetic data on every run
+static uint64_t synthetic_next(uint64_t* state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+// A plausible source path; a few have wide or emoji names
+static void synthetic_path(uint64_t* state, size_t serial, char* buffer, size_t size) {
+    static const char* const dirs[] = {
+        "src", "lib", "include", "tests", "docs", "tools", "vendor", "core", "ui", "net",
+        "storage", "platform", "internal", "cmd", "scripts", "assets", "文档", "テスト"
+    };
+    static const char* const stems[] = {
+        "main", "config", "parser", "handler", "buffer", "client", "server", "cache",
+        "index", "render", "session", "worker", "schema", "util", "説明", "rocket🚀"
+    };
+    static const char* const extensions[] = { ".c", ".h", ".md", ".json", ".txt", ".py" };
+
+    size_t len = 0;
+    int depth = 1 + (int)(synthetic_next(state) % 4);
+    for (int i = 0; i < depth && len < size; i++) {
+        len += snprintf(buffer + len, size - len, "%s/",
+                        dirs[synthetic_next(state) % (sizeof(dirs) / sizeof(dirs[0]))]);
+    }
+    if (len < size) {
+        snprintf(buffer + len, size - len, "%s_%zu%s",
+                 stems[synthetic_next(state) % (sizeof(stems) / sizeof(stems[0]))], serial,
+                 extensions[synthetic_next(state) % (sizeof(extensions) / sizeof(extensions[0]))]);
+    }
+}
+
+static void data_generate(headless_data_t* data, size_t files, size_t repos, size_t commits) {
+    uint64_t state = 0x9E3779B97F4A7C15ULL;
+    char path[512];
+    char repo[64];
+    if (repos == 0) repos = 1;
+
+    for (size_t i = 0; i < files; i++) {
+        snprintf(repo, sizeof(repo), "/synthetic/repo-%zu", i % repos);
+        long index = data_repo(data, repo);
+        if (index < 0) continue;
+        synthetic_path(&state, i, path, sizeof(path));
+        data_add_dirty_file(&data->dirty->repos[index], path);
+    }
+    for (size_t i = 0; i < commits; i++) {
+        snprintf(repo, sizeof(repo), "/synthetic/repo-%zu", i % repos);
+        long index = data_repo(data, repo);
+        if (index < 0) continue;
+        char subject[128];
+        snprintf(subject, sizeof(subject), "%08llx Synthetic change %zu",
+                 (unsigned long long)(synthetic_next(&state) & 0xFFFFFFFFu), i);
+        data_add_commit(&data->unpushed->repos[index], subject);
+        size_t commit_files = 1 + synthetic_next(&state) % 8;
+        for (size_t j = 0; j < commit_files; j++) {
+            synthetic_path(&state, files + i * 8 + j, path, sizeof(path));
+            data_add_commit_file(&data->unpushed->repos[index], path);
+        }
+    }
+}
+
+// Pane 3 animations for the tick steps, never expiring during the run
+static void add_synthetic_animations(three_pane_tui_orchestrator_t* orch, size_t count, int pane_width) {
+    uint64_t state = 0xD1B54A32D192ED03ULL;
+    char path[512];
+    for (size_t i = 0; i < count; i++) {
+        synthetic_path(&state, i, path, sizeof(path));
+        animation_state_t* anim = create_animation_state(path, ANIM_SCROLL_LEFT_RIGHT, pane_width);
+        if (!anim) continue;
+        anim->end_time = anim->start_time + 24 * 60 * 60;
+        if (animation_set_add(&orch->data.animations, anim) != 0) cleanup_animation_state(anim);
+    }
+}
+
+// Size the virtual terminal and the panes' scroll ranges
+static void headless_resize(headless_run_t* run, int width, int height) {
+    run->width = width;
+    run->height = height;
+    set_terminal_size_override(width, height);
+    vterm_resize(&run->vterm, width, height);
+    int pane_height = height - 5;
+    update_scroll_state(&run->orch->data.pane1_scroll, pane_height, run->orch->data.pane1_count);
+    update_scroll_state(&run->orch->data.pane2_scroll, pane_height, run->orch->data.pane2_count);
+}
+
+static uint64_t elapsed_ns(const struct timespec* start, const struct timespec* end) {
+    return (uint64_t)(end->tv_sec - start->tv_sec) * 1000000000ULL + (uint64_t)(end->tv_nsec - start->tv_nsec);
+}
+
+// A frame starts when its input is applied
+static void frame_begin(struct timespec* start, uint64_t* allocations) {
+    *allocations = __atomic_load_n(&allocation_count, __ATOMIC_RELAXED);
+    clock_gettime(CLOCK_MONOTONIC, start);
+}
+
+// ...and ends when its output is written; the virtual terminal applies it after
+static void frame_end(headless_run_t* run, step_kind_t kind, const struct timespec* start, uint64_t allocations) {
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    uint64_t frame_allocations = __atomic_load_n(&allocation_count, __ATOMIC_RELAXED) - allocations;
+
+    if (run->frame_count == run->frame_capacity) {
+        size_t capacity = run->frame_capacity ? run->frame_capacity * 2 : 256;
+        headless_frame_t* frames = realloc(run->frames, capacity * sizeof(headless_frame_t));
+        if (frames) {
+            run->frames = frames;
+            run->frame_capacity = capacity;
+        }
+    }
+    if (run->frame_count < run->frame_capacity) {
+        headless_frame_t* frame = &run->frames[run->frame_count++];
+        frame->ns = elapsed_ns(start, &end);
+        frame->bytes = run->output_len;
+        frame->allocations = frame_allocations;
+        frame->kind = (uint8_t)kind;
+    }
+
+    vterm_feed(&run->vterm, run->output, run->output_len);
+    run->output_len = 0;
+}
+
+// Apply the "/" filter query and redraw, as typing it would
+static void filter_frame(headless_run_t* run) {
+    three_pane_data_t* data = &run->orch->data;
+    int pane_height = run->height - 5;
+    apply_pane_filters(run->orch);
+    data->pane1_scroll.scroll_position = 0;
+    data->pane2_scroll.scroll_position = 0;
+    update_scroll_state(&data->pane1_scroll, pane_height, data->pane1_count);
+    update_scroll_state(&data->pane2_scroll, pane_height, data->pane2_count);
+    draw_tui_overlay(run->orch);
+}
+
+// Run one script step
+// Returns: 0 on success, -1 on a malformed step
+static int run_step(headless_run_t* run, const char* step) {
+    three_pane_tui_orchestrator_t* orch = run->orch;
+    struct timespec start;
+    uint64_t allocations;
+
+    if (strcmp(step, "repaint") == 0) {
+        frame_begin(&start, &allocations);
+        screen_invalidate();
+        draw_tui_overlay(orch);
+        frame_end(run, STEP_REPAINT, &start, allocations);
+    } else if (strncmp(step, "scroll:", 7) == 0) {
+        int pane, rows;
+        if (sscanf(step + 7, "%d:%d", &pane, &rows) != 2 || pane < 1 || pane > 2) return -1;
+        pane_scroll_state_t* scroll = pane == 1 ? &orch->data.pane1_scroll : &orch->data.pane2_scroll;
+        for (int i = 0; i < abs(rows); i++) {
+            frame_begin(&start, &allocations);
+            update_pane_scroll(scroll, rows < 0 ? -1 : 1, 1);
+            draw_tui_overlay(orch);
+            frame_end(run, STEP_SCROLL, &start, allocations);
+        }
+    } else if (strncmp(step, "resize:", 7) == 0) {
+        int width, height;
+        if (sscanf(step + 7, "%dx%d", &width, &height) != 2 || width < 1 || height < 1 ||
+            width > HEADLESS_MAX_DIMENSION || height > HEADLESS_MAX_DIMENSION) {
+            return -1;
+        }
+        frame_begin(&start, &allocations);
+        headless_resize(run, width, height);
+        draw_tui_overlay(orch);
+        frame_end(run, STEP_RESIZE, &start, allocations);
+    } else if (strcmp(step, "toggle") == 0) {
+        frame_begin(&start, &allocations);
+        orch->current_view = orch->current_view == VIEW_FLAT ? VIEW_TREE : VIEW_FLAT;
+        select_pane_view(orch, orch->current_view);
+        int pane_height = run->height - 5;
+        update_scroll_state(&orch->data.pane1_scroll, pane_height, orch->data.pane1_count);
+        update_scroll_state(&orch->data.pane2_scroll, pane_height, orch->data.pane2_count);
+        draw_tui_overlay(orch);
+        frame_end(run, STEP_TOGGLE, &start, allocations);
+    } else if (strncmp(step, "tick:", 5) == 0) {
+        int ticks = atoi(step + 5);
+        int fps = orch->config.animation_fps > 0 ? orch->config.animation_fps : 1;
+        int pane_width = run->width / 3;
+        size_t visible = (size_t)(run->height > 5 ? run->height - 5 : 0);
+        for (int i = 0; i < ticks; i++) {
+            frame_begin(&start, &allocations);
+            run->animation_ms += 1000 / fps;
+            animation_set_t* animations = &orch->data.animations;
+            for (size_t j = 0; j < animations->count && j < visible; j++) {
+                animation_state_t* anim = animations->order[j];
+                struct timespec now = anim->started;
+                now.tv_sec += run->animation_ms / 1000;
+                now.tv_nsec += (run->animation_ms % 1000) * 1000000L;
+                if (now.tv_nsec >= 1000000000L) {
+                    now.tv_sec++;
+                    now.tv_nsec -= 1000000000L;
+                }
+                update_animation_state(anim, pane_width, &now, fps);
+            }
+            draw_animation_frame(orch);
+            frame_end(run, STEP_TICK, &start, allocations);
+        }
+    } else if (strncmp(step, "filter:", 7) == 0) {
+        three_pane_data_t* data = &orch->data;
+        const char* text = step + 7;
+        if (!*text) {
+            frame_begin(&start, &allocations);
+            data->filter_editing = 0;
+            data->filter_query_len = 0;
+            filter_frame(run);
+            frame_end(run, STEP_FILTER, &start, allocations);
+        }
+        data->filter_editing = 1;
+        data->filter_query_len = 0;
+        for (const char* p = text; *p && data->filter_query_len < PANE_FILTER_QUERY_MAX; p++) {
+            frame_begin(&start, &allocations);
+            data->filter_query[data->filter_query_len++] = *p;
+            filter_frame(run);
+            frame_end(run, STEP_FILTER, &start, allocations);
+        }
+        data->filter_editing = 0;
+    } else {
+        return -1;
+    }
+    return 0;
+}
+
+static int compare_u64(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*)a, y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+// Print frame time percentiles, output and allocations for the frames of one
+// step kind, or of all of them for STEP_KIND_COUNT
+static void report_frames(const headless_run_t* run, step_kind_t kind, FILE* fp) {
+    uint64_t* times = malloc((run->frame_count ? run->frame_count : 1) * sizeof(uint64_t));
+    if (!times) return;
+
+    size_t count = 0;
+    uint64_t bytes = 0, max_bytes = 0, allocations = 0, max_allocations = 0;
+    for (size_t i = 0; i < run->frame_count; i++) {
+        const headless_frame_t* frame = &run->frames[i];
+        if (kind != STEP_KIND_COUNT && frame->kind != kind) continue;
+        times[count++] = frame->ns;
+        bytes += frame->bytes;
+        if (frame->bytes > max_bytes) max_bytes = frame->bytes;
+        allocations += frame->allocations;
+        if (frame->allocations > max_allocations) max_allocations = frame->allocations;
+    }
+    if (count > 0) {
+        qsort(times, count, sizeof(uint64_t), compare_u64);
+        fprintf(fp, "HEADLESS: %-8s %6zu frames, p50 %.3f ms, p90 %.3f ms, p99 %.3f ms, max %.3f ms, "
+               "%.0f bytes/frame (max %llu)",
+               kind == STEP_KIND_COUNT ? "all" : step_names[kind], count,
+               times[count / 2] / 1e6, times[count * 90 / 100] / 1e6, times[count * 99 / 100] / 1e6,
+               times[count - 1] / 1e6, (double)bytes / count, (unsigned long long)max_bytes);
+        if (ALLOCATIONS_COUNTED) {
+            fprintf(fp, ", %.1f allocations/frame (max %llu)",
+                    (double)allocations / count, (unsigned long long)max_allocations);
+        }
+        fputc('\n', fp);
+    }
+    free(times);
+}
+
+static void headless_usage(void) {
+    fprintf(stderr,
+            "Usage: three-pane-tui --headless [--size WxH] [--files N] [--repos N] [--commits N]\n"
+            "                      [--animations N] [--data FILE] [--script STEPS] [--repeat N]\n"
+            "                      [--view flat|tree] [--dump FILE]\n"
+            "       three-pane-tui --headless --record FILE\n");
+}
+
+// Run the headless renderer with the options after --headless
+// Returns: process exit status
+int three_pane_tui_headless(const char* module_path, int argc, char** argv) {
+    int width = HEADLESS_DEFAULT_WIDTH, height = HEADLESS_DEFAULT_HEIGHT;
+    size_t files = HEADLESS_DEFAULT_FILES, repos = HEADLESS_DEFAULT_REPOS, commits = HEADLESS_DEFAULT_COMMITS;
+    size_t animations = HEADLESS_DEFAULT_ANIMATIONS;
+    const char* data_file = NULL;
+    const char* record_file = NULL;
+    const char* script = HEADLESS_DEFAULT_SCRIPT;
+    const char* dump_file = NULL;
+    int repeat = 1;
+    view_mode_t view = VIEW_FLAT;
+
+    for (int i = 0; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : NULL;
+        if (!value) {
+            headless_usage();
+            return 1;
+        }
+        i++;
+        if (strcmp(arg, "--size") == 0) {
+            if (sscanf(value, "%dx%d", &width, &height) != 2 || width < 1 || height < 1 ||
+                width > HEADLESS_MAX_DIMENSION || height > HEADLESS_MAX_DIMENSION) {
+                headless_usage();
+                return 1;
+            }
+        } else if (strcmp(arg, "--files") == 0) {
+            files = strtoul(value, NULL, 10);
+        } else if (strcmp(arg, "--repos") == 0) {
+            repos = strtoul(value, NULL, 10);
+        } else if (strcmp(arg, "--commits") == 0) {
+            commits = strtoul(value, NULL, 10);
+        } else if (strcmp(arg, "--animations") == 0) {
+            animations = strtoul(value, NULL, 10);
+        } else if (strcmp(arg, "--data") == 0) {
+            data_file = value;
+        } else if (strcmp(arg, "--record") == 0) {
+            record_file = value;
+        } else if (strcmp(arg, "--script") == 0) {
+            script = value;
+        } else if (strcmp(arg, "--repeat") == 0) {
+            repeat = atoi(value);
+        } else if (strcmp(arg, "--view") == 0) {
+            view = strcmp(value, "tree") == 0 ? VIEW_TREE : VIEW_FLAT;
+        } else if (strcmp(arg, "--dump") == 0) {
+            dump_file = value;
+        } else {
+            headless_usage();
+            return 1;
+        }
+    }
+
+    if (record_file) return data_record(record_file) == 0 ? 0 : 1;
+
+    // Configuration and styles as usual, but no feed, stream or terminal
+    three_pane_tui_orchestrator_t* orch = calloc(1, sizeof(three_pane_tui_orchestrator_t));
+    if (!orch) return 1;
+    orch->module_path = strdup(module_path);
+    feed_init(&orch->data.feed);
+    stream_reader_init(&orch->data.stream);
+    if (!orch->module_path || load_config(orch) != 0) {
+        three_pane_tui_cleanup(orch);
+        return 1;
+    }
+
+    headless_data_t data;
+    memset(&data, 0, sizeof(data));
+    data.dirty = dirty_collection_init();
+    data.unpushed = unpushed_collection_init();
+    int status = 1;
+    if (data.dirty && data.unpushed && (!data_file || data_load(&data, data_file) == 0)) {
+        if (!data_file) data_generate(&data, files, repos, commits);
+
+        pane_tree_cache_t trees;
+        memset(&trees, 0, sizeof(trees));
+        struct timespec start, end;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        orch->data.model = build_pane_model_from(data.dirty, data.unpushed, data.submodules, data.submodule_count,
+                                                 &orch->config.styles, &trees);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        tree_cache_free(&trees.dirty_files);
+        tree_cache_free(&trees.unpushed_commits);
+        orch->current_view = view;
+        select_pane_view(orch, view);
+        add_synthetic_animations(orch, animations, width / 3);
+        // A screen dump to stdout keeps stdout for itself
+        FILE* report = dump_file && strcmp(dump_file, "-") == 0 ? stderr : stdout;
+        fprintf(report, "HEADLESS: %zu rows in pane 1, %zu in pane 2, model built in %.3f ms\n",
+               orch->data.pane1_count, orch->data.pane2_count, elapsed_ns(&start, &end) / 1e6);
+
+        headless_run_t run;
+        memset(&run, 0, sizeof(run));
+        run.orch = orch;
+        screen_set_sink(headless_capture, &run);
+        headless_resize(&run, width, height);
+
+        status = 0;
+        char* steps = strdup(script);
+        for (int pass = 0; steps && pass < repeat && status == 0; pass++) {
+            strcpy(steps, script);
+            char* saveptr = NULL;
+            for (char* step = strtok_r(steps, ",", &saveptr); step; step = strtok_r(NULL, ",", &saveptr)) {
+                if (run_step(&run, step) != 0) {
+                    fprintf(stderr, "Invalid headless step: %s\n", step);
+                    status = 1;
+                    break;
+                }
+            }
+        }
+        free(steps);
+
+        for (int kind = 0; kind < STEP_KIND_COUNT; kind++) {
+            report_frames(&run, (step_kind_t)kind, report);
+        }
+        report_frames(&run, STEP_KIND_COUNT, report);
+        if (!ALLOCATIONS_COUNTED) {
+            fprintf(report, "HEADLESS: allocations are counted by the three-pane-tui-bench build\n");
+        }
+
+        if (dump_file) {
+            FILE* fp = strcmp(dump_file, "-") == 0 ? stdout : fopen(dump_file, "w");
+            if (fp) {
+                vterm_dump(&run.vterm, fp);
+                if (fp != stdout) fclose(fp);
+            } else {
+                perror(dump_file);
+                status = 1;
+            }
+        }
+
+        screen_cleanup();
+        set_terminal_size_override(0, 0);
+        free(run.vterm.cells);
+        free(run.output);
+        free(run.frames);
+    }
+
+    data_free(&data);
+    three_pane_tui_cleanup(orch);
+    return status;
+}
@@ -0,0 +1,370 @@
+#include "../three-pane-tui.h"
+#include <errno.h>
+#include <sys/uio.h>
+
+// Terminal input decoder. Each wakeup reads everything stdin has into a ring
+// buffer with one readv(), then decodes keys, UTF-8, CSI and SS3 sequences,
+// SGR and X10 mouse reports and bracketed pastes from it. A sequence cut off
+// by the end of a read stays in the ring until the rest arrives; only an ESC
+// that nothing follows for TUI_INPUT_ESCAPE_TIMEOUT_MS is taken as the
+// Escape key. Wheel reports at one cell are summed into a single event, so a
+// fast scroll costs one event per wakeup rather than one per notch.
+
+#define RING_MASK (TUI_INPUT_RING_SIZE - 1)
+#define CSI_MAX_LENGTH 64       // Longer CSI sequences are dropped as garbage
+#define CSI_MAX_PARAMS 8
+
+#define ESC 0x1B
+
+static const char paste_end[] = "\033[201~";
+#define PASTE_END_LENGTH (sizeof(paste_end) - 1)
+
+static inline unsigned char ring_at(const tui_input_t* input, size_t offset) {
+    return input->ring[(input->head + offset) & RING_MASK];
+}
+
+static inline size_t ring_used(const tui_input_t* input) {
+    return input->tail - input->head;
+}
+
+void input_init(tui_input_t* input, int fd) {
+    memset(input, 0, sizeof(*input));
+    input->fd = fd;
+}
+
+// Add a decoded event to the batch; a wheel report at the cell of the
+// wheel event before it only adds to that event's delta
+static void input_emit(tui_input_t* input, const tui_input_event_t* event) {
+    input->decoded++;
+    if (event->type == TUI_INPUT_WHEEL && input->event_count > 0) {
+        tui_input_event_t* last = &input->events[input->event_count - 1];
+        if (last->type == TUI_INPUT_WHEEL && last->x == event->x && last->y == event->y &&
+            last->modifiers == event->modifiers) {
+            last->delta += event->delta;
+            return;
+        }
+    }
+    input->events[input->event_count++] = *event;
+}
+
+static void emit_key(tui_input_t* input, uint32_t key, uint8_t modifiers) {
+    tui_input_event_t event;
+    memset(&event, 0, sizeof(event));
+    event.type = TUI_INPUT_KEY;
+    event.key = key;
+    event.modifiers = modifiers;
+    input_emit(input, &event);
+}
+
+// Mouse report with xterm's button byte: low bits are the button (3 is a
+// release in X10 reports), 4/8/16 are shift/alt/ctrl, 32 marks a drag and
+// 64 the wheel
+static void emit_mouse(tui_input_t* input, int code, int x, int y, int released) {
+    tui_input_event_t event;
+    memset(&event, 0, sizeof(event));
+    event.modifiers = (uint8_t)(((code & 4) ? TUI_MOD_SHIFT : 0) | ((code & 8) ? TUI_MOD_ALT : 0) |
+                                ((code & 16) ? TUI_MOD_CTRL : 0));
+    event.x = x;
+    event.y = y;
+    if (code & 64) {
+        if (code & 2) return; // Horizontal wheel
+        event.type = TUI_INPUT_WHEEL;
+        event.delta = (code & 1) ? 1 : -1;
+    } else {
+        event.type = TUI_INPUT_MOUSE;
+        event.button = code & 3;
+        event.pressed = !released && !(code & 32) && event.button != 3;
+    }
+    input_emit(input, &event);
+}
+
+// Bytes in the UTF-8 sequence a lead byte starts (1 for anything invalid,
+// which utf8_decode() turns into U+FFFD)
+static size_t utf8_length(unsigned char lead) {
+    if ((lead & 0xE0) == 0xC0) return 2;
+    if ((lead & 0xF0) == 0xE0) return 3;
+    if ((lead & 0xF8) == 0xF0) return 4;
+    return 1;
+}
+
+// Decode the code point at offset
+// Returns: bytes it takes, or 0 if it is cut off and more may still arrive
+static size_t decode_char(const tui_input_t* input, size_t offset, size_t used, int final, uint32_t* cp) {
+    char bytes[4];
+    size_t length = utf8_length(ring_at(input, offset));
+    if (offset + length > used) {
+        if (!final) return 0;
+        length = used - offset;
+    }
+    for (size_t i = 0; i < length; i++) {
+        bytes[i] = (char)ring_at(input, offset + i);
+    }
+    return utf8_decode(bytes, length, cp);
+}
+
+// Keys of CSI and SS3 sequences ending in a letter
+static uint32_t letter_key(unsigned char final) {
+    switch (final) {
+        case 'A': return TUI_KEY_UP;
+        case 'B': return TUI_KEY_DOWN;
+        case 'C': return TUI_KEY_RIGHT;
+        case 'D': return TUI_KEY_LEFT;
+        case 'H': return TUI_KEY_HOME;
+        case 'F': return TUI_KEY_END;
+        case 'P': return TUI_KEY_F1;
+        case 'Q': return TUI_KEY_F1 + 1;
+        case 'R': return TUI_KEY_F1 + 2;
+        case 'S': return TUI_KEY_F1 + 3;
+        default: return 0;
+    }
+}
+
+// Keys of ESC[<n>~ sequences
+static uint32_t tilde_key(int code) {
+    switch (code) {
+        case 1: case 7: return TUI_KEY_HOME;
+        case 2: return TUI_KEY_INSERT;
+        case 3: return TUI_KEY_DELETE;
+        case 4: case 8: return TUI_KEY_END;
+        case 5: return TUI_KEY_PAGE_UP;
+        case 6: return TUI_KEY_PAGE_DOWN;
+        default: break;
+    }
+    if (code >= 11 && code <= 15) return TUI_KEY_F1 + (uint32_t)(code - 11);
+    if (code >= 17 && code <= 21) return TUI_KEY_F1 + 5 + (uint32_t)(code - 17);
+    if (code == 23 || code == 24) return TUI_KEY_F1 + 10 + (uint32_t)(code - 23);
+    return 0;
+}
+
+// Start a bracketed paste
+static void begin_paste(tui_input_t* input) {
+    if (!input->paste) input->paste = malloc(TUI_INPUT_PASTE_MAX);
+    input->in_paste = 1;
+    input->paste_start = input->paste_len;
+}
+
+// Decode the CSI sequence at the head of the ring (ESC [ already seen)
+// Returns: bytes it takes, or 0 if it is cut off and more may still arrive
+static size_t decode_csi(tui_input_t* input, size_t used, int final) {
+    // X10 mouse report: ESC [ M and three bytes of button and position + 32
+    if (used >= 3 && ring_at(input, 2) == 'M') {
+        if (used < 6) return final ? used : 0;
+        emit_mouse(input, ring_at(input, 3) - 32, ring_at(input, 4) - 32, ring_at(input, 5) - 32, 0);
+        return 6;
+    }
+
+    // Parameter bytes, intermediate bytes, then one final byte
+    size_t end = 2;
+    while (end < used) {
+        unsigned char c = ring_at(input, end);
+        if (c >= 0x40 && c <= 0x7E) break;
+        if (c < 0x20 || c > 0x3F) return end; // Not a CSI sequence after all; drop what was read
+        end++;
+        if (end > CSI_MAX_LENGTH) return end;
+    }
+    if (end == used) return final ? used : 0;
+
+    // A leading <, =, > or ? marks a private sequence
+    unsigned char private_mark = end > 2 ? ring_at(input, 2) : 0;
+    if (private_mark < 0x3C || private_mark > 0x3F) private_mark = 0;
+    int params[CSI_MAX_PARAMS];
+    int count = 0;
+    int value = 0, has_value = 0;
+    for (size_t i = private_mark ? 3 : 2; i < end; i++) {
+        unsigned char c = ring_at(input, i);
+        if (c >= '0' && c <= '9') {
+            if (value < 100000) value = value * 10 + (c - '0');
+            has_value = 1;
+        } else if (c == ';' || c == ':') {
+            if (count < CSI_MAX_PARAMS) params[count++] = value;
+            value = has_value = 0;
+        }
+    }
+    if ((has_value || count > 0) && count < CSI_MAX_PARAMS) params[count++] = value;
+
+    unsigned char last = ring_at(input, end);
+    uint8_t modifiers = count >= 2 && params[1] > 1 ? (uint8_t)((params[1] - 1) & 0x07) : 0;
+    if (private_mark == '<') {
+        // SGR mouse report: ESC [ < button ; x ; y M (press) or m (release)
+        if ((last == 'M' || last == 'm') && count == 3) {
+            emit_mouse(input, params[0], params[1], params[2], last == 'm');
+        }
+    } else if (private_mark) {
+        // Other private replies (mode and device attribute reports) carry no input
+    } else if (last == '~') {
+        int code = count > 0 ? params[0] : 0;
+        if (code == 200) {
+            begin_paste(input);
+        } else if (tilde_key(code)) {
+            emit_key(input, tilde_key(code), modifiers);
+        }
+    } else if (last == 'Z') {
+        emit_key(input, '\t', TUI_MOD_SHIFT);
+    } else if (letter_key(last)) {
+        emit_key(input, letter_key(last), modifiers);
+    }
+    return end + 1;
+}
+
+// Decode the token at the head of the ring; with final set, nothing more is
+// coming and a cut-off sequence is decoded from what there is
+// Returns: bytes it takes, or 0 if it is cut off and more may still arrive
+static size_t decode_token(tui_input_t* input, size_t used, int final) {
+    unsigned char c = ring_at(input, 0);
+    uint32_t cp;
+    if (c != ESC) {
+        size_t length = decode_char(input, 0, used, final, &cp);
+        if (length > 0) emit_key(input, cp, 0);
+        return length;
+    }
+
+    if (used == 1) {
+        if (final) emit_key(input, ESC, 0);
+        return final ? 1 : 0;
+    }
+
+    unsigned char next = ring_at(input, 1);
+    if (next == '[') return decode_csi(input, used, final);
+    if (next == 'O') {
+        // SS3: ESC O and one letter, sent for arrows and F1-F4 in application mode
+        if (used < 3) {
+            if (final) emit_key(input, 'O', TUI_MOD_ALT);
+            return final ? used : 0;
+        }
+        uint32_t key = letter_key(ring_at(input, 2));
+        if (key) emit_key(input, key, 0);
+        return 3;
+    }
+    if (next == ESC) {
+        emit_key(input, ESC, 0);
+        return 1;
+    }
+
+    // ESC before a character is Alt held with it
+    size_t length = decode_char(input, 1, used, final, &cp);
+    if (length > 0) emit_key(input, cp, TUI_MOD_ALT);
+    return length > 0 ? 1 + length : 0;
+}
+
+// Copy pasted bytes from the ring until the end marker
+// Returns: bytes taken, which leaves the ring empty or at a possible
+// marker that is cut off
+static size_t decode_paste(tui_input_t* input, size_t used) {
+    size_t taken = 0;
+    while (taken < used) {
+        unsigned char c = ring_at(input, taken);
+        if (c == ESC) {
+            size_t matched = 0;
+            while (matched < PASTE_END_LENGTH && taken + matched < used &&
+                   ring_at(input, taken + matched) == (unsigned char)paste_end[matched]) {
+                matched++;
+            }
+            if (matched == PASTE_END_LENGTH) {
+                tui_input_event_t event;
+                memset(&event, 0, sizeof(event));
+                event.type = TUI_INPUT_PASTE;
+                event.text = input->paste ? input->paste + input->paste_start : "";
+                event.text_len = input->paste ? input->paste_len - input->paste_start : 0;
+                input_emit(input, &event);
+                input->in_paste = 0;
+                return taken + PASTE_END_LENGTH;
+            }
+            if (taken + matched == used) return taken; // Maybe the marker, cut off
+        }
+        if (input->paste && input->paste_len < TUI_INPUT_PASTE_MAX) {
+            input->paste[input->paste_len++] = (char)c;
+        }
+        taken++;
+    }
+    return taken;
+}
+
+// Decode the ring into the event batch until it is full or the ring ends
+static void input_decode(tui_input_t* input, int final) {
+    int cut_off = 0;
+    while (input->head != input->tail && input->event_count < TUI_INPUT_MAX_EVENTS) {
+        size_t used = ring_used(input);
+        size_t taken = input->in_paste ? decode_paste(input, used) : decode_token(input, used, final);
+        if (taken == 0) {
+            cut_off = !input->in_paste;
+            break;
+        }
+        input->head += taken;
+    }
+
+    if (!cut_off) {
+        input->incomplete = 0;
+    } else if (!input->incomplete) {
+        input->incomplete = 1;
+        clock_gettime(CLOCK_MONOTONIC, &input->incomplete_since);
+    }
+}
+
+// Start a new batch; paste text of the last one is no longer referenced
+static void input_begin_batch(tui_input_t* input) {
+    input->event_count = 0;
+    if (!input->in_paste) input->paste_len = 0;
+}
+
+// Read what stdin has and decode it. Call again while it returns a full
+// batch (TUI_INPUT_MAX_EVENTS); the rest is still in the ring.
+// Returns: number of events in input->events
+size_t input_read(tui_input_t* input) {
+    input_begin_batch(input);
+    input_decode(input, 0);
+
+    while (input->event_count < TUI_INPUT_MAX_EVENTS) {
+        size_t free_space = TUI_INPUT_RING_SIZE - ring_used(input);
+        if (free_space == 0) {
+            // Only an overlong sequence fills the ring without decoding
+            input_decode(input, 1);
+            continue;
+        }
+
+        // The free space is at most two runs around the end of the ring
+        size_t start = input->tail & RING_MASK;
+        size_t first = TUI_INPUT_RING_SIZE - start;
+        if (first > free_space) first = free_space;
+        struct iovec iov[2];
+        iov[0].iov_base = input->ring + start;
+        iov[0].iov_len = first;
+        iov[1].iov_base = input->ring;
+        iov[1].iov_len = free_space - first;
+
+        ssize_t n = readv(input->fd, iov, iov[1].iov_len > 0 ? 2 : 1);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        input->reads++;
+        input->bytes += (uint64_t)n;
+        input->tail += (size_t)n;
+        input_decode(input, 0);
+        if ((size_t)n < free_space) break; // Drained
+    }
+    return input->event_count;
+}
+
+// Milliseconds until a cut-off sequence is decoded as it stands
+// Returns: -1 when nothing is waiting
+int input_timeout_ms(const tui_input_t* input, const struct timespec* now) {
+    if (!input->incomplete) return -1;
+    long elapsed_ms = (now->tv_sec - input->incomplete_since.tv_sec) * 1000 +
+                      (now->tv_nsec - input->incomplete_since.tv_nsec) / 1000000;
+    return elapsed_ms >= TUI_INPUT_ESCAPE_TIMEOUT_MS ? 0 : (int)(TUI_INPUT_ESCAPE_TIMEOUT_MS - elapsed_ms);
+}
+
+// Decode a cut-off sequence once its timeout has passed: a lone ESC becomes
+// the Escape key
+// Returns: number of events in input->events
+size_t input_expire(tui_input_t* input, const struct timespec* now) {
+    input_begin_batch(input);
+    if (input_timeout_ms(input, now) != 0) return 0;
+    input_decode(input, 1);
+    return input->event_count;
+}
+
+void input_cleanup(tui_input_t* input) {
+    free(input->paste);
+    input->paste = NULL;
+    input->paste_len = 0;
+    input->in_paste = 0;
+}
@@ -11,6 +11,9 @@ volatile sig_atomic_t redraw_needed = 0;
 volatile sig_atomic_t interrupt_received = 0;
 
 // Load configuration from index.json
+#define DEFAULT_ANIMATION_FPS 10
+#define MAX_ANIMATION_FPS 60
+
 int load_config(three_pane_tui_orchestrator_t* orch) {
     // Load JSON config
     json_value_t* config = json_parse_file("index.json");
@@ -28,6 +31,16 @@ int load_config(three_pane_tui_orchestrator_t* orch) {
     orch->config.default_view = VIEW_FLAT;
     orch->current_view = orch->config.default_view;
 
+    // Get animation_fps from config.animation_fps
+    json_value_t* animation_fps_val = get_nested_value(config, "config.animation_fps");
+    if (animation_fps_val && animation_fps_val->type == JSON_NUMBER) {
+        orch->config.animation_fps = (int)animation_fps_val->value.num_val;
+    } else {
+        orch->config.animation_fps = DEFAULT_ANIMATION_FPS;
+    }
+    if (orch->config.animation_fps < 1) orch->config.animation_fps = 1;
+    if (orch->config.animation_fps > MAX_ANIMATION_FPS) orch->config.animation_fps = MAX_ANIMATION_FPS;
+
     // Load styles
     if (load_styles(&orch->config.styles, orch->module_path) != 0) {
         fprintf(stderr, "Failed to load styles\n");
@@ -42,13 +55,7 @@ int load_config(three_pane_tui_orchestrator_t* orch) {
 // Check if a file was present at startup
 int was_startup_file(three_pane_tui_orchestrator_t* orch, const char* filepath) {
     if (!orch || !filepath) return 0;
-
-    for (size_t i = 0; i < orch->data.startup_file_count; i++) {
-        if (strcmp(orch->data.startup_files[i], filepath) == 0) {
-            return 1;
-        }
-    }
-    return 0;
+    return path_set_contains(&orch->data.startup_files, filepath);
 }
 
 // Initialize orchestrator
@@ -71,12 +78,8 @@ three_pane_tui_orchestrator_t* three_pane_tui_init(const char* module_path) {
         return NULL;
     }
 
-    // Load dirty files data for pane 1 (left pane)
-    if (load_dirty_files_data(orch, orch->current_view) != 0) {
-        fprintf(stderr, "Warning: Failed to load dirty files data, using empty pane\n");
-    }
-
-    // Initialize pane1 and pane2 scroll state (after data is loaded)
+    // Panes 1 and 2 start empty; the refresh worker fills them once main() starts it
+    // Initialize pane1 and pane2 scroll state
     orch->data.pane1_scroll.scroll_position = 0;
     orch->data.pane1_scroll.total_items = orch->data.pane1_count;
     orch->data.pane2_scroll.scroll_position = 0;
@@ -86,22 +89,18 @@ three_pane_tui_orchestrator_t* three_pane_tui_init(const char* module_path) {
     // Initialize scroll animation state
     memset(&orch->data.scroll_animation, 0, sizeof(scroll_animation_t));
 
-    if (load_committed_not_pushed_data(orch, orch->current_view) != 0) {
-        fprintf(stderr, "Warning: Failed to load committed-not-pushed data, using fallback\n");
-        // Could add fallback data here if needed
-    }
+    // Attach to the shared inotify-daemon, starting it on demand
+    feed_init(&orch->data.feed);
+    feed_ensure_daemon(&orch->data.feed);
 
     // Capture files that are currently dirty at startup (don't animate these)
+    stream_reader_init(&orch->data.stream);
     size_t startup_count = 0;
-    active_file_info_t* startup_files = load_file_changes_data(&startup_count);
+    active_file_info_t* startup_files = load_file_changes_data(&orch->data.stream, &startup_count);
 
     if (startup_files && startup_count > 0) {
-        orch->data.startup_files = calloc(startup_count, sizeof(char*));
-        if (orch->data.startup_files) {
-            orch->data.startup_file_count = startup_count;
-            for (size_t i = 0; i < startup_count; i++) {
-                orch->data.startup_files[i] = strdup(startup_files[i].path);
-            }
+        for (size_t i = 0; i < startup_count; i++) {
+            path_set_add(&orch->data.startup_files, startup_files[i].path);
         }
 
         // Cleanup temporary array
@@ -116,8 +115,11 @@ three_pane_tui_orchestrator_t* three_pane_tui_init(const char* module_path) {
 
 // Cleanup orchestrator
 void three_pane_tui_cleanup(three_pane_tui_orchestrator_t* orch) {
-    // Kill any file-changes-watcher daemon processes
-    system("pkill -f file-changes-watcher > /dev/null 2>&1");
+    // Kill the file-changes-watcher fallback if this session started one;
+    // the shared inotify-daemon is detached by closing the feed and exits on its own
+    if (orch && orch->data.feed.fallback_watcher_launched) {
+        system("pkill -f file-changes-watcher > /dev/null 2>&1");
+    }
 
     if (orch) {
         // Cleanup config
@@ -127,28 +129,21 @@ void three_pane_tui_cleanup(three_pane_tui_orchestrator_t* orch) {
         free(orch->config.pane2_title);
         free(orch->config.pane3_title);
 
-        // Cleanup data
-        for (size_t i = 0; i < orch->data.pane1_count; i++) {
-            free(orch->data.pane1_items[i]);
-        }
-        free(orch->data.pane1_items);
-
-        for (size_t i = 0; i < orch->data.pane2_count; i++) {
-            free(orch->data.pane2_items[i]);
-        }
-        free(orch->data.pane2_items);
+        // Cleanup data (pane 1 and 2 rows belong to the model)
+        pane_layout_clear(&orch->data.pane1_layout);
+        pane_layout_clear(&orch->data.pane2_layout);
+        pane_filter_free(&orch->data.pane1_filter);
+        pane_filter_free(&orch->data.pane2_filter);
+        pane_model_free(orch->data.model);
 
         // Cleanup active animations (replaces pane3_items)
-        for (size_t i = 0; i < orch->data.active_animation_count; i++) {
-            cleanup_animation_state(orch->data.active_animations[i]);
-        }
-        free(orch->data.active_animations);
+        animation_set_free(&orch->data.animations);
+
+        feed_close(&orch->data.feed);
+        stream_reader_close(&orch->data.stream);
 
         // Cleanup startup files
-        for (size_t i = 0; i < orch->data.startup_file_count; i++) {
-            free(orch->data.startup_files[i]);
-        }
-        free(orch->data.startup_files);
+        path_set_free(&orch->data.startup_files);
 
         free(orch->module_path);
         free(orch);
@@ -338,6 +333,74 @@ void cancel_scroll_animation(three_pane_tui_orchestrator_t* orch) {
     }
 }
 
+// Main loop timing: git data is refreshed soon after the feed reports changes,
+// and otherwise only often enough to notice commits and pushes, which happen
+// under .git where inotify-daemon does not look
+#define REFRESH_MIN_INTERVAL_MS 200
+#define REFRESH_IDLE_INTERVAL_MS 2000
+#define REFRESH_DISCONNECTED_INTERVAL_MS 1000  // Also paces reconnecting to the daemon
+#define SCROLL_ANIMATION_TICK_MS 16
+#define SYNC_OUTPUT_QUERY_TIMEOUT_MS 200       // Terminals that ignore both queries cost this once at startup
+
+static long elapsed_ms_between(const struct timespec* start, const struct timespec* end) {
+    return (end->tv_sec - start->tv_sec) * 1000 + (end->tv_nsec - start->tv_nsec) / 1000000;
+}
+
+// Frame output totals from the screen module over the given session time
+static void log_frame_stats(double seconds) {
+    screen_stats_t stats;
+    screen_get_stats(&stats);
+    double frames = stats.frames ? (double)stats.frames : 1.0;
+    fprintf(stderr, "PERF: FRAMES: %llu (%llu full repaints, %.1f frames/sec), %.0f bytes/frame, %.2f writes/frame, "
+            "%.3f ms render/frame, last frame %zu bytes in %.3f ms\n",
+            (unsigned long long)stats.frames, (unsigned long long)stats.full_repaints,
+            seconds > 0 ? (double)stats.frames / seconds : 0.0,
+            (double)stats.bytes / frames, (double)stats.writes / frames, (double)stats.render_ns / frames / 1e6,
+            stats.last_frame_bytes, (double)stats.last_render_ns / 1e6);
+}
+
+// Log lines on the terminal itself land on top of the frame; repaint it fully next time
+static void note_terminal_log(void) {
+    if (isatty(STDERR_FILENO)) screen_invalidate();
+}
+
+// Reconcile pane 3 animations with the currently active files
+// Returns: 1 if animations were added or removed
+static int sync_active_animations(three_pane_tui_orchestrator_t* orch, active_file_info_t* active_files,
+                                  size_t active_file_count, int pane_width) {
+    animation_set_t* animations = &orch->data.animations;
+    int changed = animation_set_expire(animations, time(NULL)) > 0;
+
+    // Update existing animations and add new ones
+    for (size_t i = 0; i < active_file_count; i++) {
+        active_file_info_t* file_info = &active_files[i];
+
+        // Check if we already have an animation for this file
+        animation_state_t* anim = animation_set_find(animations, file_info->path);
+        if (anim) {
+            // Update existing animation - reset the timer
+            animation_set_reschedule(animations, anim, file_info->last_updated + 30);
+            continue;
+        }
+
+        // If not found, create new animation (skip files that were dirty at startup)
+        if (was_startup_file(orch, file_info->path)) continue;
+        animation_state_t* new_anim = create_animation_state(file_info->path, ANIM_SCROLL_LEFT_RIGHT, pane_width);
+        if (new_anim) {
+            // Set timing for runtime animations
+            new_anim->start_time = file_info->last_updated;
+            new_anim->end_time = file_info->last_updated + 30;
+
+            if (animation_set_add(animations, new_anim) == 0) {
+                changed = 1;
+            } else {
+                cleanup_animation_state(new_anim);
+            }
+        }
+    }
+    return changed;
+}
+
 // Execute the three-pane-tui module
 int three_pane_tui_execute(three_pane_tui_orchestrator_t* orch) {
     // TEMPORARILY DISABLE TTY CHECK TO SEE ACTUAL CRASH
@@ -354,7 +417,8 @@ int three_pane_tui_execute(three_pane_tui_orchestrator_t* orch) {
     clock_gettime(CLOCK_MONOTONIC, &last_button_click);
     clock_gettime(CLOCK_MONOTONIC, &last_git_check);
 
-    // Set up signal handlers
+    // Set up signal handlers; SIGWINCH and SIGINT normally arrive through the
+    // event loop's signalfd and only reach these while run_command() unblocks them
     struct sigaction sa;
 
     // Window resize handler
@@ -379,6 +443,31 @@ int three_pane_tui_execute(three_pane_tui_orchestrator_t* orch) {
     sigaction(SIGILL, &sa, NULL);   // Illegal instruction
     sigaction(SIGFPE, &sa, NULL);   // Floating point exception
 
+    // Sleep on stdin, signals, the feed socket, the stream file and animation ticks
+    tui_events_t events;
+    if (events_init(&events) != 0) {
+        fprintf(stderr, "Error: Failed to set up the event loop\n");
+        return 1;
+    }
+
+    // Keys, mouse reports and pastes are decoded from stdin in batches
+    tui_input_t input;
+    input_init(&input, STDIN_FILENO);
+
+    // Git collection for panes 1 and 2 runs off this thread
+    refresh_worker_t refresh;
+    if (refresh_worker_start(&refresh, &orch->config.styles) == 0) {
+        events.refresh_fd = refresh.ready_fd;
+    } else {
+        fprintf(stderr, "Warning: No refresh worker, collecting git data once\n");
+        pane_tree_cache_t trees;
+        memset(&trees, 0, sizeof(trees));
+        orch->data.model = build_pane_model(&orch->config.styles, &trees);
+        tree_cache_free(&trees.dirty_files);
+        tree_cache_free(&trees.unpushed_commits);
+        select_pane_view(orch, orch->current_view);
+    }
+
     // Save current terminal state
     struct termios old_tio, new_tio;
     tcgetattr(STDIN_FILENO, &old_tio);
@@ -396,6 +485,11 @@ int three_pane_tui_execute(three_pane_tui_orchestrator_t* orch) {
     if (enable_mouse_reporting() != 0) {
         fprintf(stderr, "Warning: Failed to enable mouse reporting\n");
     }
+    enable_bracketed_paste();
+
+    // Wrap frames in synchronized updates where the terminal supports them
+    int sync_output = screen_detect_sync_output(SYNC_OUTPUT_QUERY_TIMEOUT_MS);
+    fprintf(stderr, "PERF: Synchronized output (DEC 2026): %s\n", sync_output ? "on" : "off");
 
     // Hide cursor and save position
     hide_cursor();
@@ -409,7 +503,10 @@ int three_pane_tui_execute(three_pane_tui_orchestrator_t* orch) {
 
     double initial_draw_time = (initial_draw_end.tv_sec - initial_draw_start.tv_sec) +
                               (initial_draw_end.tv_nsec - initial_draw_start.tv_nsec) / 1e9;
-    fprintf(stderr, "PERF: INITIAL DRAW: %.3f seconds\n", initial_draw_time);
+    screen_stats_t frame_stats;
+    screen_get_stats(&frame_stats);
+    fprintf(stderr, "PERF: INITIAL DRAW: %.3f seconds, %zu bytes\n", initial_draw_time, frame_stats.last_frame_bytes);
+    note_terminal_log();
 
     // Main input loop
     int running = 1;
@@ -419,6 +516,8 @@ int three_pane_tui_execute(three_pane_tui_orchestrator_t* orch) {
     // Minimum size check to prevent crashes
     if (width < 20 || height < 10) {
         printf("Terminal too small. Minimum size: 20x10\n");
+        refresh_worker_stop(&refresh);
+        events_cleanup(&events);
         return 1;
     }
 
@@ -437,10 +536,39 @@ int three_pane_tui_execute(three_pane_tui_orchestrator_t* orch) {
     clock_gettime(CLOCK_MONOTONIC, &loop_start_time);
     clock_gettime(CLOCK_MONOTONIC, &last_log_time);
 
+    int animation_frame_ms = 1000 / orch->config.animation_fps;
+    int refresh_pending = 0;  // The feed reported changes since the last git refresh
+
     while (running) {
+        // Tick only while something moves
+        if (is_scroll_animation_active(orch)) {
+            events_set_tick(&events, SCROLL_ANIMATION_TICK_MS);
+        } else if (orch->data.animations.count > 0) {
+            events_set_tick(&events, animation_frame_ms);
+        } else {
+            events_set_tick(&events, 0);
+        }
+
+        // Sleep until the next git refresh is due unless something happens first
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        long refresh_interval_ms = refresh_pending ? REFRESH_MIN_INTERVAL_MS
+                                 : feed_is_connected(&orch->data.feed) ? REFRESH_IDLE_INTERVAL_MS
+                                 : REFRESH_DISCONNECTED_INTERVAL_MS;
+        long until_refresh_ms = refresh_interval_ms - elapsed_ms_between(&last_git_check, &now);
+        int timeout_ms = until_refresh_ms > 0 ? (int)until_refresh_ms : 0;
+        int input_timeout = input_timeout_ms(&input, &now);
+        if (input_timeout >= 0 && input_timeout < timeout_ms) {
+            timeout_ms = input_timeout; // An ESC may be the Escape key
+        }
+        if (redraw_needed || interrupt_received) {
+            timeout_ms = 0; // Caught by a handler during run_command()
+        }
+
+        int ready = events_wait(&events, orch->data.feed.fd, timeout_ms);
         iteration_count++;
-        struct timespec iteration_start;
-        clock_gettime(CLOCK_MONOTONIC, &iteration_start);
+        if (ready & TUI_EVENT_RESIZE) redraw_needed = 1;
+        if (ready & TUI_EVENT_INTERRUPT) interrupt_received = 1;
 
         // Check for interrupt signal (Ctrl+C)
         if (interrupt_received) {
@@ -451,20 +579,22 @@ int three_pane_tui_execute(three_pane_tui_orchestrator_t* orch) {
         // Debug output for first few iterations
         if (iteration_count <= 3) {
             fprintf(stderr, "DEBUG: Main loop iteration %d starting\n", iteration_count);
+            note_terminal_log();
         }
 
-        // Periodic debug output (every 1000 iterations)
+        // Periodic debug output (every 1000 wakeups)
         if (iteration_count % 1000 == 0) {
-            struct timespec now;
             clock_gettime(CLOCK_MONOTONIC, &now);
             double time_since_start = (now.tv_sec - loop_start_time.tv_sec) +
                                      (now.tv_nsec - loop_start_time.tv_nsec) / 1e9;
             double time_since_last_log = (now.tv_sec - last_log_time.tv_sec) +
                                         (now.tv_nsec - last_log_time.tv_nsec) / 1e9;
 
-            fprintf(stderr, "PERF: Iteration %d (%.2fs total, %.2fs since last log), animations: %zu, width: %d, height: %d\n",
+            fprintf(stderr, "PERF: Iteration %d (%.2fs total, %.2fs since last log), animations: %zu (%zu not shown), width: %d, height: %d\n",
                    iteration_count, time_since_start, time_since_last_log,
-                   orch->data.active_animation_count, width, height);
+                   orch->data.animations.count, orch->data.animations.hidden, width, height);
+            log_frame_stats(time_since_start);
+            note_terminal_log();
 
             clock_gettime(CLOCK_MONOTONIC, &last_log_time);
         }
@@ -488,39 +618,45 @@ int three_pane_tui_execute(three_pane_tui_orchestrator_t* orch) {
             draw_tui_overlay(orch);
         }
 
-        // Check if 200ms have elapsed since last git data refresh
-        struct timespec now;
-        clock_gettime(CLOCK_MONOTONIC, &now);
-        long elapsed_ms = (now.tv_sec - last_git_check.tv_sec) * 1000 +
-                         (now.tv_nsec - last_git_check.tv_nsec) / 1000000;
-
-        if (elapsed_ms >= 200) {  // 200ms refresh interval
-            // Refresh git data by re-running all components
-            int dirty_files_result = system("./dirty-files/dirty-files > /dev/null 2>&1");
-            int committed_not_pushed_result = system("./committed-not-pushed/committed-not-pushed > /dev/null 2>&1");
-
-            // Only launch file-changes-watcher daemon if not already running
-            static int daemon_launched = 0;
-            if (!daemon_launched) {
-                int daemon_result = system("./file-changes-watcher/file-changes-watcher > /dev/null 2>&1");
-                if (daemon_result == 0) {
-                    daemon_launched = 1;
-                    fprintf(stderr, "File-changes-watcher daemon launched\n");
+        // Apply pushed changes from inotify-daemon as soon as they arrive
+        if ((ready & TUI_EVENT_FEED) && feed_is_connected(&orch->data.feed)) {
+            int feed_changes = feed_process(&orch->data.feed);
+            if (feed_changes > 0) {
+                refresh_pending = 1; // Dirty and committed state may have moved too
+                size_t active_file_count = 0;
+                active_file_info_t* active_files = feed_get_active_files(&orch->data.feed, &active_file_count);
+                sync_active_animations(orch, active_files, active_file_count, pane_width);
+                for (size_t i = 0; i < active_file_count; i++) {
+                    free(active_files[i].path);
                 }
+                free(active_files);
+                draw_tui_overlay(orch);
             }
+        }
 
-            // Reload data for each pane that succeeded (always attempt all)
-            int data_changed = 0;
-            if (dirty_files_result == 0 && load_dirty_files_data(orch, orch->current_view) == 0) {
-                data_changed = 1;
-            }
-            if (committed_not_pushed_result == 0 && load_committed_not_pushed_data(orch, orch->current_view) == 0) {
-                data_changed = 1;
+        // The fallback watcher appended to the stream file
+        if ((ready & TUI_EVENT_STREAM) && !feed_is_connected(&orch->data.feed)) {
+            size_t active_file_count = 0;
+            active_file_info_t* active_files = load_file_changes_data(&orch->data.stream, &active_file_count);
+            if (active_files) {
+                sync_active_animations(orch, active_files, active_file_count, pane_width);
+                for (size_t i = 0; i < active_file_count; i++) {
+                    free(active_files[i].path);
+                }
+                free(active_files);
+                draw_tui_overlay(orch);
             }
-            // Note: file-changes-watcher data is loaded below in animation management, no separate load function needed
+            refresh_pending = 1;
+        }
+
+        // Adopt the newest pane model from the refresh worker
+        if (ready & TUI_EVENT_REFRESH) {
+            pane_model_t* model = refresh_worker_take(&refresh);
+            if (model) {
+                pane_model_free(orch->data.model);
+                orch->data.model = model;
+                select_pane_view(orch, orch->current_view);
 
-            // Update UI if any data changed
-            if (data_changed) {
                 // Update scroll states after data refresh
                 get_terminal_size(&width, &height);
                 if (width >= 20 && height >= 10) {
@@ -542,73 +678,28 @@ int three_pane_tui_execute(three_pane_tui_orchestrator_t* orch) {
                 }
                 draw_tui_overlay(orch);
             }
+        }
 
-            // Manage animation states for active file changes
-            size_t active_file_count = 0;
-            active_file_info_t* active_files = load_file_changes_data(&active_file_count);
-
-            if (active_files) {
-                time_t now = time(NULL);
-
-                // Remove expired animations (safely handle rapid updates)
-                size_t write_idx = 0;
-                for (size_t i = 0; i < orch->data.active_animation_count && i < 1000; i++) { // Safety limit
-                    animation_state_t* anim = orch->data.active_animations[i];
-                    if (anim && !is_animation_expired(anim, now)) {
-                        // Keep this animation
-                        if (write_idx != i) {
-                            orch->data.active_animations[write_idx] = orch->data.active_animations[i];
-                        }
-                        write_idx++;
-                    } else if (anim) {
-                        // Remove expired animation
-                        cleanup_animation_state(anim);
-                    }
-                }
-                orch->data.active_animation_count = write_idx;
+        // Refresh git data once its interval has elapsed
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        if (elapsed_ms_between(&last_git_check, &now) >= refresh_interval_ms) {
+            // Rebuild git data on the worker; the result arrives as TUI_EVENT_REFRESH
+            refresh_worker_request(&refresh);
 
-                // Update existing animations and add new ones
-                for (size_t i = 0; i < active_file_count; i++) {
-                    active_file_info_t* file_info = &active_files[i];
-                    int found = 0;
-
-                    // Check if we already have an animation for this file
-                    for (size_t j = 0; j < orch->data.active_animation_count; j++) {
-                        animation_state_t* anim = orch->data.active_animations[j];
-                        if (strcmp(anim->filepath, file_info->path) == 0) {
-                            // Update existing animation - reset the timer
-                            anim->end_time = file_info->last_updated + 30;
-                            found = 1;
-                            break;
-                        }
-                    }
+            // Attach to the workspace's shared watcher (started on demand, reference counted)
+            if (!feed_is_connected(&orch->data.feed)) {
+                feed_ensure_daemon(&orch->data.feed);
+            }
 
-                    // If not found, create new animation (skip files that were dirty at startup)
-                    if (!found && !was_startup_file(orch, file_info->path) && orch->data.active_animation_count < 100) { // Safety limit
-                        animation_state_t* new_anim = create_animation_state(file_info->path, ANIM_SCROLL_LEFT_RIGHT, pane_width);
-                        if (new_anim) {
-                            // Set timing for runtime animations
-                            new_anim->start_time = file_info->last_updated;
-                            new_anim->end_time = file_info->last_updated + 30;
-
-                            // Add to animations array (safely)
-                            animation_state_t** new_array = realloc(orch->data.active_animations,
-                                                                 (orch->data.active_animation_count + 1) * sizeof(animation_state_t*));
-                            if (new_array) {
-                                orch->data.active_animations = new_array;
-                                orch->data.active_animations[orch->data.active_animation_count] = new_anim;
-                                orch->data.active_animation_count++;
-                            } else {
-                                cleanup_animation_state(new_anim);
-                            }
-                        }
-                    }
-                }
+            // Manage animation states for active file changes
+            // (the live feed keeps them current between ticks; the stream file is the fallback)
+            size_t active_file_count = 0;
+            active_file_info_t* active_files = feed_is_connected(&orch->data.feed)
+                ? feed_get_active_files(&orch->data.feed, &active_file_count)
+                : load_file_changes_data(&orch->data.stream, &active_file_count);
 
-                // Update scroll positions for all active animations
-                for (size_t i = 0; i < orch->data.active_animation_count; i++) {
-                    update_animation_state(orch->data.active_animations[i], pane_width, now);
-                }
+            if (active_files || feed_is_connected(&orch->data.feed)) {
+                sync_active_animations(orch, active_files, active_file_count, pane_width);
 
                 // Cleanup active files info
                 for (size_t i = 0; i < active_file_count; i++) {
@@ -616,46 +707,126 @@ int three_pane_tui_execute(three_pane_tui_orchestrator_t* orch) {
                 }
                 free(active_files);
             }
+            refresh_pending = 0;
             last_git_check = now;  // Reset timer
         }
 
-        // Update any active scroll animations for smooth transitions
-        update_scroll_animation(orch);
+        // Advance scroll and pane 3 animations on the timer; marquee positions
+        // follow the monotonic clock, and frames where nothing moved are skipped
+        if (ready & TUI_EVENT_TICK) {
+            int scrolling = is_scroll_animation_active(orch);
+            update_scroll_animation(orch);
+
+            int animations_moved = sync_active_animations(orch, NULL, 0, pane_width); // Drop expired animations
+            // Only the animations with a row need to move; the rest pick up
+            // their position from the clock once they get one
+            size_t visible = orch->data.animations.count;
+            if (pane_height > 0 && visible > (size_t)pane_height) visible = (size_t)pane_height;
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            for (size_t i = 0; i < visible; i++) {
+                animations_moved |= update_animation_state(orch->data.animations.order[i], pane_width,
+                                                           &now, orch->config.animation_fps);
+            }
 
-        // Try to read mouse events first (they start with \033)
-        int button, x, y, scroll_delta;
-        if (iteration_count <= 3) {
-            fprintf(stderr, "DEBUG: About to call read_mouse_event\n");
+            if (scrolling) {
+                draw_tui_overlay(orch);
+            } else if (animations_moved) {
+                draw_animation_frame(orch);
+            }
         }
 
-        int mouse_result = read_mouse_event(&button, &x, &y, &scroll_delta);
-
-        if (iteration_count <= 3) {
-            fprintf(stderr, "DEBUG: read_mouse_event returned %d\n", mouse_result);
+        // Decode everything stdin has in one batch; an ESC that nothing
+        // followed is decoded once its timeout has passed
+        size_t input_count;
+        if (ready & TUI_EVENT_INPUT) {
+            input_count = input_read(&input);
+        } else {
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            input_count = input_expire(&input, &now);
         }
 
-        if (mouse_result == 0 && width >= 20 && height >= 10) { // Only process mouse events if terminal is valid size
-            // Only handle button presses, not releases (button == -1 indicates release)
-            if (button == -1) {
-                // Button release - ignore to prevent double-clicking
-                // Do nothing
-            } else {
-                // Button press - handle it
-                // Convert to 1-based coordinates and validate bounds
-                int click_x = x - 1;
-                int click_y = y - 1;
-
-                // Bounds check to prevent crashes
-                if (click_x < 0 || click_x >= width || click_y < 0 || click_y >= height) {
-                    continue; // Invalid coordinates, skip this event
-                }
+        int input_redraw = 0;
+        while (input_count > 0 && running) {
+            for (size_t i = 0; i < input_count && running; i++) {
+                tui_input_event_t* event = &input.events[i];
+
+                if (orch->data.filter_editing &&
+                    (event->type == TUI_INPUT_KEY || event->type == TUI_INPUT_PASTE)) {
+                    // Typing a "/" filter query; panes 1 and 2 narrow with every key
+                    three_pane_data_t* data = &orch->data;
+                    size_t len_before = data->filter_query_len;
+                    uint32_t c = event->key;
+                    if (event->type == TUI_INPUT_PASTE) {
+                        // Pasted text joins the query, minus line breaks and other controls
+                        for (size_t j = 0; j < event->text_len && data->filter_query_len < PANE_FILTER_QUERY_MAX; j++) {
+                            unsigned char byte = (unsigned char)event->text[j];
+                            if (byte >= ' ' && byte != 127) data->filter_query[data->filter_query_len++] = (char)byte;
+                        }
+                    } else if (event->modifiers & TUI_MOD_ALT) {
+                        // Alt combinations don't edit the query
+                    } else if (c == '\r' || c == '\n') {
+                        data->filter_editing = 0;
+                    } else if (c == 27) { // Escape drops the filter
+                        data->filter_editing = 0;
+                        data->filter_query_len = 0;
+                    } else if (c == 127 || c == '\b') {
+                        if (data->filter_query_len > 0) {
+                            // Remove the last character, not just its last byte
+                            do {
+                                data->filter_query_len--;
+                            } while (data->filter_query_len > 0 &&
+                                     ((unsigned char)data->filter_query[data->filter_query_len] & 0xC0) == 0x80);
+                        } else {
+                            data->filter_editing = 0;
+                        }
+                    } else if (c == 21) { // Ctrl+U clears the query
+                        data->filter_query_len = 0;
+                    } else if (c >= ' ' && c < TUI_KEY_UP) {
+                        char bytes[4];
+                        size_t n = utf8_encode(c, bytes);
+                        if (data->filter_query_len + n <= PANE_FILTER_QUERY_MAX) {
+                            memcpy(data->filter_query + data->filter_query_len, bytes, n);
+                            data->filter_query_len += n;
+                        }
+                    }
 
-                // Check if click is in footer (last row)
-                if (click_y == height - 1) {
-                    // Check if click is on the toggle button (around columns 22-32 for "[FLAT]" or "[TREE]")
-                    if (click_x >= 22 && click_x <= 32) {
+                    if (data->filter_query_len != len_before) {
+                        apply_pane_filters(orch);
+                        data->pane1_scroll.scroll_position = 0;
+                        data->pane2_scroll.scroll_position = 0;
+                        update_scroll_state(&data->pane1_scroll, pane_height, data->pane1_count);
+                        update_scroll_state(&data->pane2_scroll, pane_height, data->pane2_count);
+                    }
+                    input_redraw = 1;
+                } else if (event->type == TUI_INPUT_KEY) {
+                    if (event->modifiers & TUI_MOD_ALT) continue;
+                    uint32_t c = event->key;
+                    // Check for exit keys
+                    if (c == 'q' || c == 'Q' || c == 27) { // 27 is Escape
+                        running = 0;
+                    } else if (c == '/') {
+                        // Start a new filter query
+                        orch->data.filter_editing = 1;
+                        orch->data.filter_query_len = 0;
+                        apply_pane_filters(orch);
+                        update_scroll_state(&orch->data.pane1_scroll, pane_height, orch->data.pane1_count);
+                        update_scroll_state(&orch->data.pane2_scroll, pane_height, orch->data.pane2_count);
+                        input_redraw = 1;
+                    }
+                } else if (event->type == TUI_INPUT_MOUSE) {
+                    // Only handle button presses; releases and drags would click twice
+                    if (!event->pressed || width < 20 || height < 10) continue;
+
+                    // Convert to 0-based coordinates and validate bounds
+                    int click_x = event->x - 1;
+                    int click_y = event->y - 1;
+                    if (click_x < 0 || click_x >= width || click_y < 0 || click_y >= height) {
+                        continue; // Invalid coordinates, skip this event
+                    }
+
+                    // Check if click is on the footer's toggle button (around columns 22-32 for "[FLAT]" or "[TREE]")
+                    if (click_y == height - 1 && click_x >= 22 && click_x <= 32) {
                         // Check cooldown (1 second minimum between clicks)
-                        struct timespec now;
                         clock_gettime(CLOCK_MONOTONIC, &now);
                         long elapsed_ms = (now.tv_sec - last_button_click.tv_sec) * 1000 +
                                         (now.tv_nsec - last_button_click.tv_nsec) / 1000000;
@@ -666,138 +837,126 @@ int three_pane_tui_execute(three_pane_tui_orchestrator_t* orch) {
 
                             orch->current_view = (orch->current_view == VIEW_FLAT) ? VIEW_TREE : VIEW_FLAT;
 
-                            // Reload data with new view mode for both panes
-                            if (load_dirty_files_data(orch, orch->current_view) == 0 &&
-                                load_committed_not_pushed_data(orch, orch->current_view) == 0) {
-                                // Update scroll states to reflect new data count after view change (pane3 uses animations)
-                                get_terminal_size(&width, &height);
-                                if (width >= 20 && height >= 10) {
-                                    pane_width = width / 3;
-                                    if (pane_width < 1) pane_width = 1;
-                                    pane_height = height - 5;
-                                    update_scroll_state(&orch->data.pane1_scroll, pane_height, orch->data.pane1_count);
-                                    update_scroll_state(&orch->data.pane2_scroll, pane_height, orch->data.pane2_count);
-                                }
-                                draw_tui_overlay(orch);
+                            // Both views are already rendered in the current model
+                            select_pane_view(orch, orch->current_view);
+
+                            // Update scroll states to reflect new data count after view change (pane3 uses animations)
+                            get_terminal_size(&width, &height);
+                            if (width >= 20 && height >= 10) {
+                                pane_width = width / 3;
+                                if (pane_width < 1) pane_width = 1;
+                                pane_height = height - 5;
+                                update_scroll_state(&orch->data.pane1_scroll, pane_height, orch->data.pane1_count);
+                                update_scroll_state(&orch->data.pane2_scroll, pane_height, orch->data.pane2_count);
                             }
+                            input_redraw = 1;
                         }
                     }
-                } else {
-                // Handle pane scrolling (not in footer)
-                int pane_index = get_pane_at_position(click_x, click_y, pane_width, width, pane_height);
-                if (pane_index > 0 && pane_index <= 3) {
+                } else if (event->type == TUI_INPUT_WHEEL) {
+                    if (width < 20 || height < 10) continue;
+                    int wheel_x = event->x - 1;
+                    int wheel_y = event->y - 1;
+                    if (wheel_x < 0 || wheel_x >= width || wheel_y < 0 || wheel_y >= height - 1) {
+                        continue; // Outside the panes
+                    }
+
+                    // The rest of this batch's wheel burst over the same pane is one scroll
+                    int pane_index = get_pane_at_position(wheel_x, wheel_y, pane_width, width, pane_height);
+                    int scroll_delta = event->delta;
+                    while (i + 1 < input_count && input.events[i + 1].type == TUI_INPUT_WHEEL &&
+                           get_pane_at_position(input.events[i + 1].x - 1, input.events[i + 1].y - 1,
+                                                pane_width, width, pane_height) == pane_index) {
+                        scroll_delta += input.events[++i].delta;
+                    }
+
                     pane_scroll_state_t* scroll_state = NULL;
                     switch (pane_index) {
                         case 1: scroll_state = &orch->data.pane1_scroll; break;
                         case 2: scroll_state = &orch->data.pane2_scroll; break;
-                        case 3: scroll_state = NULL; break; // Pane 3 uses animations, no scroll state
+                        default: break; // Pane 3 uses animations, no scroll state
                     }
-                    if (scroll_state) {
-                        // CRITICAL FIX: Throttle scroll updates to prevent rapid accumulation
-                        static struct timespec last_scroll_update = {0, 0};
-                        static int accumulated_scroll_delta = 0;
-                        static int current_fast_scroll_pane = 0;
+                    if (!scroll_state || scroll_delta == 0) continue;
 
-                        struct timespec now;
-                        clock_gettime(CLOCK_MONOTONIC, &now);
-                        long elapsed_ms = (now.tv_sec - last_scroll_update.tv_sec) * 1000 +
-                                         (now.tv_nsec - last_scroll_update.tv_nsec) / 1000000;
-
-                        // Only update scroll if at least 10ms have passed (prevents rapid accumulation)
-                        if (elapsed_ms >= 10) {
-                            // Record scroll event for hybrid detection
-                            record_scroll_event(scroll_delta);
-
-                            // Check if we're at scroll boundaries to prevent stuttering
-                            bool at_boundary = is_at_scroll_boundary(scroll_state, scroll_delta);
-                            if (at_boundary) {
-                                // At boundary - don't process scroll to prevent stuttering
-                                last_scroll_update = now;
-                            } else {
-                                // Not at boundary - process scroll normally
-                                // Use hybrid detection for fast scrolling
-                                bool is_fast_scrolling = is_fast_scrolling_detected();
-
-                                if (is_fast_scrolling) {
-                                // Fast scrolling: accumulate scroll deltas instead of immediate updates
-                                accumulated_scroll_delta += scroll_delta * 4; // Always use 4x for fast scrolling
-                                current_fast_scroll_pane = pane_index;
-
-                                // Cancel any existing scroll animation
-                                cancel_scroll_animation(orch);
-
-                                // Throttle redraws during fast scrolling (200ms vs 50ms for slow)
-                                struct timespec now_redraw;
-                                clock_gettime(CLOCK_MONOTONIC, &now_redraw);
-                                long elapsed_ms_redraw = (now_redraw.tv_sec - last_redraw.tv_sec) * 1000 +
-                                                        (now_redraw.tv_nsec - last_redraw.tv_nsec) / 1000000;
-
-                                if (elapsed_ms_redraw >= 200) { // Longer throttle for fast scrolling
-                                    // Calculate target position based on accumulated delta
-                                    int target_position = scroll_state->scroll_position + accumulated_scroll_delta;
-
-                                    // Clamp target to valid range
-                                    if (target_position < 0) target_position = 0;
-                                    if (target_position > scroll_state->max_scroll) target_position = scroll_state->max_scroll;
-
-                                    // Start smooth scroll animation to target position
-                                    start_scroll_animation(orch, pane_index, target_position);
-
-                                    // Reset accumulated delta
-                                    accumulated_scroll_delta = 0;
-
-                                    draw_tui_overlay(orch);
-                                    last_redraw = now_redraw;
-                                }
-                            } else {
-                                // Slow scrolling: immediate updates with normal redraws
-
-                                // Cancel any ongoing fast scroll animation
-                                if (current_fast_scroll_pane == pane_index) {
-                                    cancel_scroll_animation(orch);
-                                    accumulated_scroll_delta = 0;
-                                    current_fast_scroll_pane = 0;
-                                }
-
-                                // Immediate scroll update
-                                update_pane_scroll(scroll_state, scroll_delta, 1);
-
-                                // Immediate redraw for snappy feel
-                                struct timespec now_redraw;
-                                clock_gettime(CLOCK_MONOTONIC, &now_redraw);
-                                long elapsed_ms_redraw = (now_redraw.tv_sec - last_redraw.tv_sec) * 1000 +
-                                                        (now_redraw.tv_nsec - last_redraw.tv_nsec) / 1000000;
-
-                                if (elapsed_ms_redraw >= 50) { // Normal 50ms throttle for slow scrolling
-                                    draw_tui_overlay(orch);
-                                    last_redraw = now_redraw;
-                                }
-                                }
-                            }
+                    static int accumulated_scroll_delta = 0;
+                    static int current_fast_scroll_pane = 0;
+                    int direction = scroll_delta > 0 ? 1 : -1;
+                    int notches = abs(scroll_delta);
+
+                    // Record scroll events for hybrid detection, one per wheel notch
+                    for (int n = 0; n < notches && n < SCROLL_HISTORY_SIZE; n++) {
+                        record_scroll_event(direction);
+                    }
+
+                    // At a boundary - don't process scroll to prevent stuttering
+                    if (is_at_scroll_boundary(scroll_state, direction)) continue;
+
+                    // Use hybrid detection for fast scrolling
+                    if (is_fast_scrolling_detected()) {
+                        // Fast scrolling: accumulate scroll deltas instead of immediate updates
+                        accumulated_scroll_delta += scroll_delta * 4; // Always use 4x for fast scrolling
+                        current_fast_scroll_pane = pane_index;
+
+                        // Cancel any existing scroll animation
+                        cancel_scroll_animation(orch);
+
+                        // Throttle redraws during fast scrolling (200ms vs 50ms for slow)
+                        struct timespec now_redraw;
+                        clock_gettime(CLOCK_MONOTONIC, &now_redraw);
+                        long elapsed_ms_redraw = (now_redraw.tv_sec - last_redraw.tv_sec) * 1000 +
+                                                (now_redraw.tv_nsec - last_redraw.tv_nsec) / 1000000;
+
+                        if (elapsed_ms_redraw >= 200) { // Longer throttle for fast scrolling
+                            // Calculate target position based on accumulated delta
+                            int target_position = scroll_state->scroll_position + accumulated_scroll_delta;
+
+                            // Clamp target to valid range
+                            if (target_position < 0) target_position = 0;
+                            if (target_position > scroll_state->max_scroll) target_position = scroll_state->max_scroll;
+
+                            // Start smooth scroll animation to target position
+                            start_scroll_animation(orch, pane_index, target_position);
+
+                            // Reset accumulated delta
+                            accumulated_scroll_delta = 0;
+
+                            draw_tui_overlay(orch);
+                            last_redraw = now_redraw;
                         }
+                    } else {
+                        // Slow scrolling: immediate updates with normal redraws
+
+                        // Cancel any ongoing fast scroll animation
+                        if (current_fast_scroll_pane == pane_index) {
+                            cancel_scroll_animation(orch);
+                            accumulated_scroll_delta = 0;
+                            current_fast_scroll_pane = 0;
+                        }
+
+                        // Immediate scroll update
+                        update_pane_scroll(scroll_state, direction, notches);
 
-                        last_scroll_update = now;
+                        // Immediate redraw for snappy feel
+                        struct timespec now_redraw;
+                        clock_gettime(CLOCK_MONOTONIC, &now_redraw);
+                        long elapsed_ms_redraw = (now_redraw.tv_sec - last_redraw.tv_sec) * 1000 +
+                                                (now_redraw.tv_nsec - last_redraw.tv_nsec) / 1000000;
+
+                        if (elapsed_ms_redraw >= 50) { // Normal 50ms throttle for slow scrolling
+                            draw_tui_overlay(orch);
+                            last_redraw = now_redraw;
+                        }
                     }
                 }
             }
-            }
-        } else if (mouse_result == -3) {
-            // Incomplete mouse event, ignore and continue
-            // This prevents crashes from partial mouse event data
-        } else {
-            // No mouse event or invalid data, check for keyboard input
-            int c = read_char_timeout();
-            if (c >= 0) {
-                // Check for exit keys
-                if (c == 'q' || c == 'Q' || c == 27) { // 27 is Escape
-                    running = 0;
-                }
-            }
+
+            // A full batch leaves more input in the ring
+            input_count = input_count == TUI_INPUT_MAX_EVENTS ? input_read(&input) : 0;
         }
 
-        // Small delay to prevent busy waiting
-        struct timespec delay = {0, 10000000}; // 10ms
-        nanosleep(&delay, NULL);
+        // Keys, clicks and pastes of the batch are drawn together
+        if (input_redraw && running) {
+            draw_tui_overlay(orch);
+        }
     }
 
     // Final performance summary
@@ -806,16 +965,25 @@ int three_pane_tui_execute(three_pane_tui_orchestrator_t* orch) {
     double total_session_time = (session_end_time.tv_sec - loop_start_time.tv_sec) +
                                (session_end_time.tv_nsec - loop_start_time.tv_nsec) / 1e9;
 
-    fprintf(stderr, "PERF: SESSION SUMMARY: %.2f seconds, %d iterations (%.1f iter/sec)\n",
+    fprintf(stderr, "PERF: SESSION SUMMARY: %.2f seconds, %d wakeups (%.1f wakeups/sec)\n",
              total_session_time, iteration_count, iteration_count / total_session_time);
+    log_frame_stats(total_session_time);
+    fprintf(stderr, "PERF: INPUT: %llu reads, %llu bytes, %llu events decoded\n",
+            (unsigned long long)input.reads, (unsigned long long)input.bytes, (unsigned long long)input.decoded);
+
+    refresh_worker_stop(&refresh);
+    events_cleanup(&events);
 
     // Cleanup: restore terminal state
+    screen_cleanup();
     clear_screen();
     restore_cursor_position();
     show_cursor();
 
-    // Disable mouse reporting
+    // Disable mouse reporting and bracketed paste
     disable_mouse_reporting();
+    disable_bracketed_paste();
+    input_cleanup(&input);
 
     // Restore blocking mode
     fcntl(STDIN_FILENO, F_SETFL, flags);
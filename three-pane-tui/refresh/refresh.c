@@ -0,0 +1,111 @@
+#include "../three-pane-tui.h"
+#include <errno.h>
+#include <poll.h>
+#include <stdint.h>
+#include <sys/eventfd.h>
+
+// Background refresh: git collection for panes 1 and 2 runs on its own thread.
+// Each run builds a complete pane model and publishes it with an atomic
+// exchange; the UI thread takes the newest one whenever ready_fd fires, so a
+// slow scan never stalls input or drawing. Requests made while a scan is
+// running coalesce into one follow-up scan. The worker keeps the TREE view
+// tries between scans so each scan only applies what changed. The collectors
+// start git with default signal state, so Ctrl+C reaches a hung git, and a
+// scan still running when the UI quits is cancelled rather than waited for.
+
+static void notify_fd(int fd) {
+    uint64_t one = 1;
+    ssize_t written = write(fd, &one, sizeof(one));
+    (void)written; // An eventfd only fails to accept a write at its maximum count
+}
+
+static void* refresh_thread(void* arg) {
+    refresh_worker_t* worker = arg;
+    pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, NULL);
+    struct pollfd fds[2] = {
+        { .fd = worker->request_fd, .events = POLLIN },
+        { .fd = worker->stop_fd, .events = POLLIN },
+    };
+
+    for (;;) {
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (fds[1].revents) break;
+
+        uint64_t requests;
+        if (read(worker->request_fd, &requests, sizeof(requests)) != (ssize_t)sizeof(requests)) continue;
+
+        // Only a scan can be cancelled: it waits on git at cancellation
+        // points (pipe reads, waitpid) and updates the tries without any
+        pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, NULL);
+        pane_model_t* model = build_pane_model(worker->styles, &worker->trees);
+        pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, NULL);
+        if (!model) continue;
+
+        // Replace anything the UI thread has not taken yet
+        pane_model_t* stale = __atomic_exchange_n(&worker->published, model, __ATOMIC_ACQ_REL);
+        pane_model_free(stale);
+        notify_fd(worker->ready_fd);
+    }
+    return NULL;
+}
+
+// Start the worker; it scans once as soon as it starts
+// Returns: 0 on success, -1 on error
+int refresh_worker_start(refresh_worker_t* worker, const style_config_t* styles) {
+    memset(worker, 0, sizeof(*worker));
+    worker->styles = styles;
+    worker->request_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    worker->ready_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    worker->stop_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (worker->request_fd < 0 || worker->ready_fd < 0 || worker->stop_fd < 0) {
+        perror("eventfd");
+        refresh_worker_stop(worker);
+        return -1;
+    }
+
+    // Signals stay with the UI thread's signalfd
+    sigset_t all, old;
+    sigfillset(&all);
+    pthread_sigmask(SIG_SETMASK, &all, &old);
+    int rc = pthread_create(&worker->thread, NULL, refresh_thread, worker);
+    pthread_sigmask(SIG_SETMASK, &old, NULL);
+    if (rc != 0) {
+        fprintf(stderr, "pthread_create: %s\n", strerror(rc));
+        refresh_worker_stop(worker);
+        return -1;
+    }
+    worker->running = 1;
+
+    refresh_worker_request(worker);
+    return 0;
+}
+
+// Ask for a new scan; never blocks
+void refresh_worker_request(refresh_worker_t* worker) {
+    if (worker->running) notify_fd(worker->request_fd);
+}
+
+// Take the newest published model, if any; the caller owns it
+pane_model_t* refresh_worker_take(refresh_worker_t* worker) {
+    return __atomic_exchange_n(&worker->published, NULL, __ATOMIC_ACQ_REL);
+}
+
+// Stop the worker; a scan in progress is cancelled, not waited for
+void refresh_worker_stop(refresh_worker_t* worker) {
+    if (worker->running) {
+        notify_fd(worker->stop_fd);
+        pthread_cancel(worker->thread);
+        pthread_join(worker->thread, NULL);
+        worker->running = 0;
+    }
+    if (worker->request_fd >= 0) close(worker->request_fd);
+    if (worker->ready_fd >= 0) close(worker->ready_fd);
+    if (worker->stop_fd >= 0) close(worker->stop_fd);
+    worker->request_fd = worker->ready_fd = worker->stop_fd = -1;
+    pane_model_free(refresh_worker_take(worker));
+    tree_cache_free(&worker->trees.dirty_files);
+    tree_cache_free(&worker->trees.unpushed_commits);
+}
@@ -0,0 +1,524 @@
+#define _XOPEN_SOURCE 700
+#include "../three-pane-tui.h"
+#include <errno.h>
+#include <poll.h>
+#include <stdarg.h>
+#include <stdint.h>
+
+// Cell-grid framebuffer. Drawing code writes glyphs into the back buffer
+// through a pen (position, colors, bold); screen_end_frame() compares it with
+// what the terminal already shows and writes only the cells that changed,
+// with the cursor moves and SGR changes needed to get there. Escape sequences
+// are assembled from precomputed tables into one buffer, and each frame
+// reaches the terminal with a single write(), inside a synchronized update
+// (DEC mode 2026) when the terminal reports support for it.
+
+#define SCREEN_GLYPH_TAIL 0xFFFFFFFFu  // Right half of a wide glyph
+#define SCREEN_OUTPUT_INITIAL_CAPACITY 16384
+#define SCREEN_ATTR_BOLD 0x01
+#define SCREEN_NUMBER_TABLE_SIZE 1000       // Rows, columns and SGR codes below this come from the table
+#define SCREEN_SYNC_BEGIN "\033[?2026h"
+#define SCREEN_SYNC_END "\033[?2026l"
+
+typedef struct {
+    uint32_t glyph;   // Unicode code point, SCREEN_GLYPH_TAIL for the right half of a wide glyph
+    uint8_t fg;       // SGR foreground code, 0 for the terminal default
+    uint8_t bg;       // SGR background code, 0 for the terminal default
+    uint8_t attrs;    // SCREEN_ATTR_* bits
+} screen_cell_t;
+
+typedef struct {
+    screen_cell_t* front;   // What the terminal shows
+    screen_cell_t* back;    // Frame being drawn
+    int width;
+    int height;
+    int front_valid;        // 0 until the terminal is known to match front
+    int diff_first_row;     // Rows screen_end_frame() compares
+    int diff_last_row;
+
+    // Pen used by the drawing functions (1-based like move_cursor())
+    int pen_row;
+    int pen_col;
+    uint8_t pen_fg;
+    uint8_t pen_bg;
+    uint8_t pen_attrs;
+    uint32_t utf8_code;
+    int utf8_pending;       // Continuation bytes still expected
+    int after_joiner;       // Last glyph was a zero width joiner
+
+    // Terminal attributes as of the last byte written
+    uint8_t term_fg;
+    uint8_t term_bg;
+    uint8_t term_attrs;
+
+    char* out;
+    size_t out_len;
+    size_t out_capacity;
+
+    int sync_output;        // Terminal supports DEC 2026 synchronized updates
+    screen_sink_t sink;     // Takes frame output instead of stdout when set
+    void* sink_context;
+
+    struct timespec frame_start;
+    screen_stats_t stats;
+} screen_t;
+
+static screen_t g_screen;
+
+// Decimal text for every number below SCREEN_NUMBER_TABLE_SIZE
+static char number_text[SCREEN_NUMBER_TABLE_SIZE][4];
+static uint8_t number_length[SCREEN_NUMBER_TABLE_SIZE];
+static int number_table_ready;
+
+static void init_number_table(void) {
+    for (int n = 0; n < SCREEN_NUMBER_TABLE_SIZE; n++) {
+        number_length[n] = (uint8_t)snprintf(number_text[n], sizeof(number_text[n]), "%d", n);
+    }
+    number_table_ready = 1;
+}
+
+static const screen_cell_t blank_cell = { ' ', 0, 0, 0 };
+
+static int cell_equal(const screen_cell_t* a, const screen_cell_t* b) {
+    return a->glyph == b->glyph && a->fg == b->fg && a->bg == b->bg && a->attrs == b->attrs;
+}
+
+static void out_reserve(size_t extra) {
+    if (g_screen.out_len + extra <= g_screen.out_capacity) return;
+    size_t capacity = g_screen.out_capacity ? g_screen.out_capacity : SCREEN_OUTPUT_INITIAL_CAPACITY;
+    while (capacity < g_screen.out_len + extra) capacity *= 2;
+    char* out = realloc(g_screen.out, capacity);
+    if (!out) return;
+    g_screen.out = out;
+    g_screen.out_capacity = capacity;
+}
+
+static void out_append(const char* data, size_t len) {
+    out_reserve(len);
+    if (g_screen.out_len + len > g_screen.out_capacity) return;
+    memcpy(g_screen.out + g_screen.out_len, data, len);
+    g_screen.out_len += len;
+}
+
+static void out_number(int n) {
+    if (n >= 0 && n < SCREEN_NUMBER_TABLE_SIZE) {
+        out_append(number_text[n], number_length[n]);
+        return;
+    }
+    char buffer[16];
+    int len = snprintf(buffer, sizeof(buffer), "%d", n);
+    if (len > 0) out_append(buffer, (size_t)len);
+}
+
+// CUP to an absolute position
+static void out_cursor_position(int row, int col) {
+    out_append("\033[", 2);
+    out_number(row);
+    out_append(";", 1);
+    out_number(col);
+    out_append("H", 1);
+}
+
+// CUF along the current row
+static void out_cursor_forward(int columns) {
+    out_append("\033[", 2);
+    out_number(columns);
+    out_append("C", 1);
+}
+
+static void out_utf8(uint32_t cp) {
+    char buffer[4];
+    size_t len;
+    if (cp < 0x80) {
+        buffer[0] = (char)cp;
+        len = 1;
+    } else if (cp < 0x800) {
+        buffer[0] = (char)(0xC0 | (cp >> 6));
+        buffer[1] = (char)(0x80 | (cp & 0x3F));
+        len = 2;
+    } else if (cp < 0x10000) {
+        buffer[0] = (char)(0xE0 | (cp >> 12));
+        buffer[1] = (char)(0x80 | ((cp >> 6) & 0x3F));
+        buffer[2] = (char)(0x80 | (cp & 0x3F));
+        len = 3;
+    } else {
+        buffer[0] = (char)(0xF0 | (cp >> 18));
+        buffer[1] = (char)(0x80 | ((cp >> 12) & 0x3F));
+        buffer[2] = (char)(0x80 | ((cp >> 6) & 0x3F));
+        buffer[3] = (char)(0x80 | (cp & 0x3F));
+        len = 4;
+    }
+    out_append(buffer, len);
+}
+
+static screen_cell_t* back_cell(int row, int col) {
+    return &g_screen.back[(size_t)(row - 1) * (size_t)g_screen.width + (size_t)(col - 1)];
+}
+
+// Store one glyph at the pen and advance it; glyphs past the right edge are clipped
+static void put_glyph(uint32_t cp) {
+    // Same widths as get_string_display_width(), so measured text lines up
+    int width = glyph_width(cp, &g_screen.after_joiner);
+    if (width <= 0) return; // Control and combining characters and joined emoji take no cell
+    if (cp == '\t') cp = ' ';
+
+    int row = g_screen.pen_row, col = g_screen.pen_col;
+    g_screen.pen_col += width;
+    if (row < 1 || row > g_screen.height || col < 1 || col + width - 1 > g_screen.width) return;
+
+    // Never leave half of a wide glyph behind
+    screen_cell_t* cell = back_cell(row, col);
+    if (cell->glyph == SCREEN_GLYPH_TAIL && col > 1) *(cell - 1) = blank_cell;
+    if (col + width <= g_screen.width && (cell + width)->glyph == SCREEN_GLYPH_TAIL) *(cell + width) = blank_cell;
+
+    cell->glyph = cp;
+    cell->fg = g_screen.pen_fg;
+    cell->bg = g_screen.pen_bg;
+    cell->attrs = g_screen.pen_attrs;
+    if (width == 2) {
+        cell[1] = *cell;
+        cell[1].glyph = SCREEN_GLYPH_TAIL;
+    }
+}
+
+// Feed one byte of UTF-8 text through the pen's decoder
+static void put_byte(unsigned char c) {
+    if (g_screen.utf8_pending > 0 && (c & 0xC0) == 0x80) {
+        g_screen.utf8_code = (g_screen.utf8_code << 6) | (c & 0x3F);
+        if (--g_screen.utf8_pending == 0) put_glyph(g_screen.utf8_code);
+        return;
+    }
+    g_screen.utf8_pending = 0;
+    if (c < 0x80) {
+        put_glyph(c);
+    } else if ((c & 0xE0) == 0xC0) {
+        g_screen.utf8_code = c & 0x1F;
+        g_screen.utf8_pending = 1;
+    } else if ((c & 0xF0) == 0xE0) {
+        g_screen.utf8_code = c & 0x0F;
+        g_screen.utf8_pending = 2;
+    } else if ((c & 0xF8) == 0xF0) {
+        g_screen.utf8_code = c & 0x07;
+        g_screen.utf8_pending = 3;
+    } else {
+        put_glyph(0xFFFD); // Stray continuation or invalid lead byte
+    }
+}
+
+// Start a frame: size the buffers to the terminal and blank the back buffer
+void screen_begin_frame(int width, int height) {
+    clock_gettime(CLOCK_MONOTONIC, &g_screen.frame_start);
+
+    if (width != g_screen.width || height != g_screen.height || !g_screen.back) {
+        size_t cells = (size_t)width * (size_t)height;
+        screen_cell_t* front = realloc(g_screen.front, cells * sizeof(screen_cell_t));
+        if (front) g_screen.front = front;
+        screen_cell_t* back = front ? realloc(g_screen.back, cells * sizeof(screen_cell_t)) : NULL;
+        if (back) g_screen.back = back;
+        if (!front || !back) {
+            g_screen.width = g_screen.height = 0;
+            return;
+        }
+        g_screen.width = width;
+        g_screen.height = height;
+        g_screen.front_valid = 0; // The terminal reflowed; repaint everything
+    }
+
+    screen_clear();
+    screen_reset_attrs();
+    g_screen.pen_row = g_screen.pen_col = 1;
+    g_screen.diff_first_row = 1;
+    g_screen.diff_last_row = height;
+}
+
+// Start a frame that changes only rows first_row..last_row of what the
+// terminal shows; the back buffer starts as a copy of the front buffer
+// Returns: 0 on success, -1 if the terminal changed and a full frame is needed
+int screen_begin_update(int width, int height, int first_row, int last_row) {
+    if (!g_screen.front_valid || !g_screen.back || width != g_screen.width || height != g_screen.height) {
+        return -1;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &g_screen.frame_start);
+
+    memcpy(g_screen.back, g_screen.front, (size_t)width * (size_t)height * sizeof(screen_cell_t));
+    screen_reset_attrs();
+    g_screen.pen_row = g_screen.pen_col = 1;
+    g_screen.diff_first_row = first_row < 1 ? 1 : first_row;
+    g_screen.diff_last_row = last_row > height ? height : last_row;
+    return 0;
+}
+
+// Forget what the terminal shows so the next frame repaints everything
+void screen_invalidate(void) {
+    g_screen.front_valid = 0;
+}
+
+void screen_clear(void) {
+    size_t cells = (size_t)g_screen.width * (size_t)g_screen.height;
+    for (size_t i = 0; i < cells; i++) {
+        g_screen.back[i] = blank_cell;
+    }
+}
+
+// Blank a rectangle of the back buffer, clipped to the screen
+void screen_clear_area(int row, int col, int rows, int cols) {
+    for (int r = row < 1 ? 1 : row; r < row + rows && r <= g_screen.height; r++) {
+        for (int c = col < 1 ? 1 : col; c < col + cols && c <= g_screen.width; c++) {
+            *back_cell(r, c) = blank_cell;
+        }
+    }
+}
+
+void screen_move(int row, int col) {
+    g_screen.pen_row = row;
+    g_screen.pen_col = col;
+    g_screen.utf8_pending = 0;
+    g_screen.after_joiner = 0;
+}
+
+// Accepts the same SGR color codes as set_color(): 30-37/90-97 set the
+// foreground, 40-47/100-107 the background
+void screen_set_color(int color_code) {
+    if ((color_code >= 40 && color_code <= 47) || (color_code >= 100 && color_code <= 107)) {
+        g_screen.pen_bg = (uint8_t)color_code;
+    } else if (color_code == 1) {
+        g_screen.pen_attrs |= SCREEN_ATTR_BOLD;
+    } else if (color_code == 0) {
+        screen_reset_attrs();
+    } else if (color_code > 0 && color_code < 256) {
+        g_screen.pen_fg = (uint8_t)color_code;
+    }
+}
+
+void screen_set_bold(void) {
+    g_screen.pen_attrs |= SCREEN_ATTR_BOLD;
+}
+
+void screen_reset_attrs(void) {
+    g_screen.pen_fg = 0;
+    g_screen.pen_bg = 0;
+    g_screen.pen_attrs = 0;
+}
+
+void screen_puts(const char* text) {
+    if (!g_screen.back || !text) return;
+    for (const unsigned char* p = (const unsigned char*)text; *p; p++) {
+        put_byte(*p);
+    }
+}
+
+void screen_putc(char c) {
+    if (g_screen.back) put_byte((unsigned char)c);
+}
+
+void screen_printf(const char* format, ...) {
+    char buffer[1024];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+    screen_puts(buffer);
+}
+
+// Emit the SGR sequence that takes the terminal from its current attributes to a cell's
+static void emit_sgr(const screen_cell_t* cell) {
+    if (cell->fg == g_screen.term_fg && cell->bg == g_screen.term_bg && cell->attrs == g_screen.term_attrs) return;
+
+    // Turning anything off needs a reset; otherwise only the changes are sent
+    int reset = (g_screen.term_attrs & ~cell->attrs) ||
+                (g_screen.term_fg && !cell->fg) || (g_screen.term_bg && !cell->bg);
+    int first = 1;
+    out_append("\033[", 2);
+    if (reset) {
+        out_append("0", 1);
+        first = 0;
+    }
+    if ((cell->attrs & SCREEN_ATTR_BOLD) && (reset || !(g_screen.term_attrs & SCREEN_ATTR_BOLD))) {
+        if (!first) out_append(";", 1);
+        out_append("1", 1);
+        first = 0;
+    }
+    if (cell->fg && (reset || cell->fg != g_screen.term_fg)) {
+        if (!first) out_append(";", 1);
+        out_number(cell->fg);
+        first = 0;
+    }
+    if (cell->bg && (reset || cell->bg != g_screen.term_bg)) {
+        if (!first) out_append(";", 1);
+        out_number(cell->bg);
+    }
+    out_append("m", 1);
+
+    g_screen.term_fg = cell->fg;
+    g_screen.term_bg = cell->bg;
+    g_screen.term_attrs = cell->attrs;
+}
+
+// Write the whole buffer to the terminal; stdout shares stdin's O_NONBLOCK
+// Returns: bytes written
+static size_t write_frame(const char* data, size_t len) {
+    if (g_screen.sink) {
+        g_screen.sink(data, len, g_screen.sink_context);
+        g_screen.stats.writes++;
+        return len;
+    }
+
+    size_t done = 0;
+    while (done < len) {
+        ssize_t n = write(STDOUT_FILENO, data + done, len - done);
+        g_screen.stats.writes++;
+        if (n > 0) {
+            done += (size_t)n;
+        } else if (n < 0 && errno == EAGAIN) {
+            struct pollfd pfd = { .fd = STDOUT_FILENO, .events = POLLOUT };
+            poll(&pfd, 1, 100);
+        } else if (!(n < 0 && errno == EINTR)) {
+            break;
+        }
+    }
+    return done;
+}
+
+// Diff the back buffer against the front buffer and write the changes
+// Returns: bytes written to the terminal
+size_t screen_end_frame(void) {
+    if (!g_screen.back) return 0;
+    if (!number_table_ready) init_number_table();
+    g_screen.out_len = 0;
+    if (g_screen.sync_output) out_append(SCREEN_SYNC_BEGIN, sizeof(SCREEN_SYNC_BEGIN) - 1);
+    size_t header_len = g_screen.out_len;
+
+    int full = !g_screen.front_valid;
+    if (full) {
+        out_append("\033[0m\033[2J", 8);
+        g_screen.term_fg = g_screen.term_bg = g_screen.term_attrs = 0;
+    }
+
+    int cursor_row = -1, cursor_col = -1; // Unknown until the first move
+    int first_row = full ? 1 : g_screen.diff_first_row;
+    int last_row = full ? g_screen.height : g_screen.diff_last_row;
+    for (int row = first_row; row <= last_row; row++) {
+        for (int col = 1; col <= g_screen.width; col++) {
+            screen_cell_t* back = back_cell(row, col);
+            screen_cell_t* front = &g_screen.front[back - g_screen.back];
+            if (full ? cell_equal(back, &blank_cell) : cell_equal(back, front)) continue;
+
+            // A changed right half is redrawn from its left half
+            if (back->glyph == SCREEN_GLYPH_TAIL) {
+                if (col == 1) continue;
+                col--;
+                back--;
+            }
+
+            if (cursor_row != row || cursor_col != col) {
+                if (cursor_row == row && cursor_col < col && col - cursor_col < 1000) {
+                    out_cursor_forward(col - cursor_col);
+                } else {
+                    out_cursor_position(row, col);
+                }
+            }
+            emit_sgr(back);
+            out_utf8(back->glyph);
+
+            int width = (col < g_screen.width && back[1].glyph == SCREEN_GLYPH_TAIL) ? 2 : 1;
+            col += width - 1;
+            cursor_row = row;
+            cursor_col = col + 1;
+            if (cursor_col > g_screen.width) cursor_row = -1; // Pending wrap: position unknown
+        }
+    }
+    if (g_screen.term_fg || g_screen.term_bg || g_screen.term_attrs) {
+        out_append("\033[0m", 4);
+        g_screen.term_fg = g_screen.term_bg = g_screen.term_attrs = 0;
+    }
+
+    // The back buffer is what the terminal shows now
+    screen_cell_t* shown = g_screen.back;
+    g_screen.back = g_screen.front;
+    g_screen.front = shown;
+    g_screen.front_valid = 1;
+
+    size_t written = 0;
+    if (g_screen.out_len > header_len) {
+        if (g_screen.sync_output) out_append(SCREEN_SYNC_END, sizeof(SCREEN_SYNC_END) - 1);
+        fflush(stdout); // Anything printed outside a frame goes first
+        written = write_frame(g_screen.out, g_screen.out_len);
+    }
+
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    uint64_t render_ns = (uint64_t)(end.tv_sec - g_screen.frame_start.tv_sec) * 1000000000ULL +
+                         (uint64_t)(end.tv_nsec - g_screen.frame_start.tv_nsec);
+    g_screen.stats.frames++;
+    if (full) g_screen.stats.full_repaints++;
+    g_screen.stats.bytes += written;
+    g_screen.stats.render_ns += render_ns;
+    g_screen.stats.last_frame_bytes = written;
+    g_screen.stats.last_render_ns = render_ns;
+    return written;
+}
+
+// Whether a primary device attributes reply (ESC [ ? digits/; c) has arrived
+static int has_device_attributes(const char* reply) {
+    for (const char* p = strstr(reply, "\033[?"); p; p = strstr(p + 1, "\033[?")) {
+        const char* q = p + 3;
+        while ((*q >= '0' && *q <= '9') || *q == ';') q++;
+        if (*q == 'c') return 1;
+    }
+    return 0;
+}
+
+// Ask the terminal whether it supports synchronized updates (DECRQM for mode
+// 2026). Primary device attributes are requested right after it: every
+// terminal answers those, so the wait ends even when the mode query is ignored.
+// stdin must already be in raw mode.
+// Returns: 1 if synchronized updates will be used, 0 otherwise
+int screen_detect_sync_output(int timeout_ms) {
+    static const char query[] = "\033[?2026$p\033[c";
+    fflush(stdout);
+    if (write(STDOUT_FILENO, query, sizeof(query) - 1) != (ssize_t)(sizeof(query) - 1)) return 0;
+
+    char reply[256];
+    size_t len = 0;
+    reply[0] = '\0';
+    struct timespec start, now;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (;;) {
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        long elapsed_ms = (now.tv_sec - start.tv_sec) * 1000 + (now.tv_nsec - start.tv_nsec) / 1000000;
+        if (elapsed_ms >= timeout_ms) break;
+
+        struct pollfd pfd = { .fd = STDIN_FILENO, .events = POLLIN };
+        if (poll(&pfd, 1, (int)(timeout_ms - elapsed_ms)) <= 0) break;
+        ssize_t n = read(STDIN_FILENO, reply + len, sizeof(reply) - 1 - len);
+        if (n <= 0) break;
+        len += (size_t)n;
+        reply[len] = '\0';
+
+        // The mode report, if any, arrives before the device attributes
+        if (has_device_attributes(reply) || len >= sizeof(reply) - 1) break;
+    }
+
+    // DECRPM: ESC [ ? 2026 ; Ps $ y, where 1 (set) and 2 (reset) mean supported
+    char* report = strstr(reply, "\033[?2026;");
+    int mode = report ? atoi(report + strlen("\033[?2026;")) : 0;
+    g_screen.sync_output = (mode == 1 || mode == 2);
+    return g_screen.sync_output;
+}
+
+void screen_get_stats(screen_stats_t* stats) {
+    *stats = g_screen.stats;
+}
+
+// Send frame output to sink instead of stdout; NULL goes back to stdout
+void screen_set_sink(screen_sink_t sink, void* context) {
+    g_screen.sink = sink;
+    g_screen.sink_context = context;
+}
+
+void screen_cleanup(void) {
+    free(g_screen.front);
+    free(g_screen.back);
+    free(g_screen.out);
+    memset(&g_screen, 0, sizeof(g_screen));
+}
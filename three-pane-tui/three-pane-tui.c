@@ -17,6 +17,11 @@ int main(int argc, char* argv[]) {
     char full_module_path[2048];
     snprintf(full_module_path, sizeof(full_module_path), "%s", module_path);
 
+    // Render against a virtual terminal and report frame costs instead
+    if (argc > 1 && strcmp(argv[1], "--headless") == 0) {
+        return three_pane_tui_headless(full_module_path, argc - 2, argv + 2);
+    }
+
     // Initialize three-pane-tui orchestrator
     three_pane_tui_orchestrator_t* orch = three_pane_tui_init(full_module_path);
     if (!orch) {
@@ -7,10 +7,17 @@
 #include <unistd.h>
 #include <termios.h>
 #include <sys/ioctl.h>
+#include <sys/stat.h>
 #include <signal.h>
 #include <fcntl.h>
 #include <time.h>
+#include <pthread.h>
+#include <stdint.h>
 #include "../json-utils/json-utils.h"
+#include "../inotify-watcher/inotify-protocol.h"
+#include "../inotify-watcher/inotify-shm.h"
+#include "../dirty-files/dirty-files.h"
+#include "../committed-not-pushed/committed-not-pushed.h"
 
 // View mode enumeration for file display
 typedef enum {
@@ -18,6 +25,8 @@ typedef enum {
     VIEW_TREE
 } view_mode_t;
 
+#define VIEW_MODE_COUNT 2
+
 // Animation types enumeration
 typedef enum {
     ANIM_SCROLL_LEFT_RIGHT
@@ -69,6 +78,7 @@ typedef struct {
     char* pane2_title;
     char* pane3_title;
     view_mode_t default_view;
+    int animation_fps;  // Pane 3 marquee frames per second (config.animation_fps)
     style_config_t styles;
 } three_pane_tui_config_t;
 
@@ -91,31 +101,374 @@ typedef struct {
 } scroll_animation_t;
 
 // Animation state structure
-typedef struct {
+typedef struct animation_state {
     animation_type_t type;
     char* filepath;
+    size_t path_hash;  // Key in the animation set's index
+    size_t order_index;  // Position in the animation set's draw order
     time_t start_time;
     time_t end_time;  // start_time + 30 seconds
+    struct timespec started;  // Monotonic; the scroll position follows from the time since
     int scroll_position;  // For scroll animations
     int pane_width;  // Cached pane width for calculations
+    struct animation_state* wheel_prev;  // Expiry wheel slot list
+    struct animation_state* wheel_next;
 } animation_state_t;
 
+// One-second slots in the expiry wheel; animations expiring further ahead
+// than this wrap around and are skipped until their lap comes up
+#define ANIMATION_WHEEL_SLOTS 64
+
+// Active pane 3 animations: indexed by path for the feed's updates, kept in
+// arrival order for drawing, and bucketed by expiry second so a tick only
+// looks at the animations that may have just run out
+typedef struct {
+    animation_state_t** index;  // Open addressing, power-of-two size
+    size_t index_size;
+    animation_state_t** order;  // Arrival order, drawn top to bottom
+    size_t count;
+    size_t order_capacity;
+    animation_state_t* wheel[ANIMATION_WHEEL_SLOTS];
+    time_t wheel_time;  // Every second up to this one has been expired
+    size_t hidden;  // Animations the last frame had no row for
+} animation_set_t;
+
+// Set of paths, used for the files that were already dirty at startup
+typedef struct {
+    char** slots;  // Open addressing, power-of-two size
+    size_t size;
+    size_t count;
+} path_set_t;
+
+// Live change table entry received from inotify-daemon
+typedef struct {
+    char* path;                 // Display path (repository/relative path)
+    time_t last_updated;
+    int from_initial_snapshot;  // Already changed before this session started (not animated)
+    int stale;                  // Not yet confirmed by the snapshot in progress
+} feed_entry_t;
+
+// Subscription to the inotify-daemon change stream
+typedef struct {
+    int fd;                     // Daemon socket (-1 when not connected)
+    char* buffer;               // Partial record buffer
+    size_t buffer_len;
+    feed_entry_t* entries;
+    size_t entry_count;
+    size_t entry_capacity;
+    int in_snapshot;            // Snapshot in progress
+    int initial_snapshot_done;  // First snapshot fully received
+    struct timespec last_connect_attempt;
+    inotify_shm_t shm;          // Daemon's shared-memory snapshot (preferred for pane 3)
+    inotify_shm_snapshot_t shm_snapshot;
+    int shm_snapshot_valid;
+    time_t session_start;       // Files last changed before this are not animated
+    time_t last_daemon_launch;
+    int fallback_watcher_launched;  // This session started its own file-changes-watcher
+} feed_client_t;
+
+// Structure to hold active file information
+typedef struct {
+    char* path;
+    time_t last_updated;
+} active_file_info_t;
+
+// Follows file-changes-stream.json as the fallback watcher appends to it,
+// keeping the events of the last 30 seconds in arrival order
+typedef struct {
+    int fd;              // Open stream file (-1 when it does not exist)
+    dev_t dev;           // Identity of the open file; a new one means it was rotated
+    ino_t ino;
+    off_t offset;        // Bytes consumed, always at a line boundary
+    active_file_info_t* window;  // Recent events; window[head..count) are live
+    size_t head;
+    size_t count;
+    size_t capacity;
+} stream_reader_t;
+
+typedef enum {
+    PANE_ROW_ITEM,
+    PANE_ROW_HEADER     // "Repository: <name>", centered and bold
+} pane_row_kind_t;
+
+// One pane row; everything drawing needs is worked out when the model is built
+typedef struct {
+    const char* text;       // NUL-terminated, in the pane's arena
+    uint64_t byte_mask;     // Bytes in text for the "/" filter, see pane_filter_byte_mask()
+    int display_width;
+    uint8_t kind;           // pane_row_kind_t
+    uint8_t repo_color;     // Alternating repository color index (1-8), 0 before the first header
+    uint8_t color;          // ANSI color the row is drawn in
+} pane_row_t;
+
+// Text storage for a pane's rows, allocated in large chunks and freed at once
+typedef struct {
+    char** chunks;
+    size_t chunk_count;
+    size_t used;            // Bytes used in the last chunk
+} pane_arena_t;
+
+// Persistent path trie behind the TREE view. Nodes are never changed once
+// built: a scan's changes are merged in one pass that builds each node on a
+// changed path once and shares every other subtree with the previous version,
+// so a published model can keep reading its version while the worker builds
+// the next one.
+typedef struct tree_node {
+    char* name;
+    struct tree_node** children;    // Sorted by name
+    size_t child_count;
+    size_t row_count;               // Rows this subtree draws; a node counts itself, the root does not
+    int refs;                       // Parents and holders sharing the node, updated atomically
+    uint64_t byte_mask;             // pane_filter_byte_mask() of name
+    uint8_t is_file;                // A path ends here
+} tree_node_t;
+
+// A path one scan adds to or removes from a trie
+typedef struct {
+    const char* path;
+    uint8_t insert;                 // 1 to add the path, 0 to remove it
+} tree_change_t;
+
+// Receives one row of a tree walk; a non-zero return stops the walk
+typedef int (*tree_row_sink_t)(const char* text, size_t length, uint64_t byte_mask, size_t index, void* context);
+
+// Last TREE view input of one repository, kept between scans
+typedef struct {
+    char* key;                      // Repository path
+    char** paths;                   // Sorted and unique
+    size_t path_count;
+    tree_node_t* root;              // One reference held by the cache
+    int seen;                       // Updated since the last sweep
+} repo_tree_t;
+
+// Per-repository tries of one pane, owned by whoever builds pane models
+typedef struct {
+    repo_tree_t* repos;
+    size_t count;
+    uint64_t inserts;               // Paths added and removed over all updates
+    uint64_t removes;
+} tree_cache_t;
+
+// TREE view tries for panes 1 and 2
+typedef struct {
+    tree_cache_t dirty_files;
+    tree_cache_t unpushed_commits;
+} pane_tree_cache_t;
+
+// A repository in a TREE view pane: a header row followed by the rows of its
+// trie, which are generated when they scroll into view
+typedef struct {
+    size_t first_row;               // Pane row of the header
+    const char* header;             // In the pane's arena
+    int header_width;
+    uint8_t repo_color;
+    tree_node_t* root;              // One reference held by the model
+} pane_tree_t;
+
+// An item row the filter can match, with the lowercase bytes it contains
+// folded into 64 bits so most rows are rejected without reading their text
+// (worked out with the rows, off the UI thread)
+typedef struct {
+    const char* text;               // Row text; TREE view rows' text is in the pane's arena
+    uint64_t byte_mask;             // Bit (lowercase byte & 63) for every byte of text
+    uint32_t length;                // Bytes in text
+    uint32_t row;                   // Pane row
+    uint32_t header;                // Pane row of its repository header, or UINT32_MAX
+} pane_filter_candidate_t;
+
+// Rows of one pane in one view mode; the TREE view keeps tries instead of rows
+typedef struct {
+    pane_row_t* rows;
+    size_t count;                   // Rows in the pane, including trie rows
+    size_t capacity;
+    pane_arena_t arena;
+    pane_tree_t* trees;
+    size_t tree_count;
+    pane_filter_candidate_t* candidates;    // TREE view item rows for the "/" filter
+    size_t candidate_count;
+} pane_rows_t;
+
+// Complete contents of panes 1 and 2 for both views, built off the UI thread
+typedef struct {
+    pane_rows_t dirty_files[VIEW_MODE_COUNT];       // Indexed by view_mode_t
+    pane_rows_t unpushed_commits[VIEW_MODE_COUNT];
+} pane_model_t;
+
+// Rows of a pane as drawn at one width: text truncated to fit and its display
+// width, filled in the first time each row is drawn. Kept until the pane's
+// rows change or the pane is resized.
+typedef struct {
+    const pane_rows_t* rows;        // Rows and width the layout was made for
+    int width;
+    pane_row_t* laid_out;           // One per row; text is NULL until laid out
+    size_t count;
+    pane_arena_t arena;             // Truncated and TREE view row text
+} pane_layout_t;
+
+// Longest "/" filter query, in bytes
+#define PANE_FILTER_QUERY_MAX 128
+
+// A candidate matching the query so far, and where its match ended
+typedef struct {
+    uint32_t candidate;
+    uint32_t end;                   // Offset in text just past the last matched byte
+} pane_filter_match_t;
+
+// Fuzzy (subsequence) filter over one pane's rows. Every query prefix keeps
+// its matches, so typing a byte only searches the previous prefix's matches
+// from where each one ended, and deleting one just drops the last set.
+typedef struct {
+    const pane_rows_t* rows;        // Rows the candidates were taken from
+    pane_filter_candidate_t* candidates;
+    size_t candidate_count;
+    int candidates_built;
+    char query[PANE_FILTER_QUERY_MAX];  // Lowercased; one match set per byte
+    pane_filter_match_t* levels[PANE_FILTER_QUERY_MAX];
+    size_t level_counts[PANE_FILTER_QUERY_MAX];
+    size_t depth;                   // Query bytes with a match set
+    uint32_t* shown;                // Pane rows to draw: matching items and their headers
+    size_t shown_count;
+    int active;                     // A non-empty query narrows the pane
+} pane_filter_t;
+
+// Background git collection; the newest finished model waits in published
+// until the UI thread takes it
+typedef struct {
+    pthread_t thread;
+    int running;
+    int request_fd;           // eventfd: the UI thread asks for a rebuild
+    int ready_fd;             // eventfd: a model was published
+    int stop_fd;
+    pane_model_t* published;  // Exchanged atomically between the two threads
+    const style_config_t* styles;  // Row colors; read-only once loaded
+    pane_tree_cache_t trees;  // TREE view tries, used only by the worker thread
+} refresh_worker_t;
+
 // Data for the three panes (pane3 uses animations instead of hardcoded items)
 typedef struct {
-    char** pane1_items;
+    pane_model_t* model;  // Owns the rows pane1_rows/pane2_rows point into
+    const pane_rows_t* pane1_rows;
     size_t pane1_count;
-    char** pane2_items;
+    const pane_rows_t* pane2_rows;
     size_t pane2_count;
-    animation_state_t** active_animations;  // Active file change animations for pane 3
-    size_t active_animation_count;
-    char** startup_files;  // Files that were dirty at startup (don't animate)
-    size_t startup_file_count;
+    animation_set_t animations;  // Active file change animations for pane 3
+    path_set_t startup_files;  // Files that were dirty at startup (don't animate)
     pane_scroll_state_t pane1_scroll;
     pane_scroll_state_t pane2_scroll;
+    pane_layout_t pane1_layout;
+    pane_layout_t pane2_layout;
+    pane_filter_t pane1_filter;
+    pane_filter_t pane2_filter;
+    char filter_query[PANE_FILTER_QUERY_MAX];  // "/" filter applied to panes 1 and 2
+    size_t filter_query_len;
+    int filter_editing;   // Keys go to the filter query
     // pane3_scroll removed - animations don't use scroll state
     scroll_animation_t scroll_animation;  // Scroll animation state for smooth transitions
+    feed_client_t feed;  // Live change feed from inotify-daemon (falls back to the stream file)
+    stream_reader_t stream;  // Fallback watcher's stream file
 } three_pane_data_t;
 
+// Stream file the fallback file-changes-watcher appends to
+#define FILE_CHANGES_STREAM_FILE "file-changes-stream.json"
+
+// Event sources reported by events_wait()
+#define TUI_EVENT_INPUT     0x01  // stdin readable
+#define TUI_EVENT_RESIZE    0x02  // SIGWINCH
+#define TUI_EVENT_INTERRUPT 0x04  // SIGINT
+#define TUI_EVENT_FEED      0x08  // inotify-daemon socket readable
+#define TUI_EVENT_STREAM    0x10  // Fallback stream file written
+#define TUI_EVENT_TICK      0x20  // Animation tick
+#define TUI_EVENT_REFRESH   0x40  // Refresh worker published a pane model
+
+// Descriptors the main loop sleeps on
+typedef struct {
+    int signal_fd;          // SIGWINCH and SIGINT, blocked while the loop runs
+    int timer_fd;           // Animation tick, disarmed while nothing animates
+    int stream_fd;          // inotify on the stream file's directory (-1 if unavailable)
+    int refresh_fd;         // Refresh worker's ready eventfd, not owned (-1 if none)
+    int tick_interval_ms;   // Armed tick interval, 0 when disarmed
+    sigset_t saved_mask;
+} tui_events_t;
+
+// Terminal input decoder (input module)
+#define TUI_INPUT_RING_SIZE 4096         // Bytes buffered from stdin; a power of two
+#define TUI_INPUT_MAX_EVENTS 256         // Events decoded per input_read()
+#define TUI_INPUT_PASTE_MAX 65536        // Longer bracketed pastes are truncated
+#define TUI_INPUT_ESCAPE_TIMEOUT_MS 25   // An ESC with nothing after it for this long is the Escape key
+
+typedef enum {
+    TUI_INPUT_KEY,
+    TUI_INPUT_MOUSE,
+    TUI_INPUT_WHEEL,
+    TUI_INPUT_PASTE
+} tui_input_type_t;
+
+// Keys without a code point, numbered past the end of Unicode
+enum {
+    TUI_KEY_UP = 0x110000,
+    TUI_KEY_DOWN,
+    TUI_KEY_RIGHT,
+    TUI_KEY_LEFT,
+    TUI_KEY_HOME,
+    TUI_KEY_END,
+    TUI_KEY_INSERT,
+    TUI_KEY_DELETE,
+    TUI_KEY_PAGE_UP,
+    TUI_KEY_PAGE_DOWN,
+    TUI_KEY_F1              // F1-F12 are TUI_KEY_F1 + 0..11
+};
+
+// Modifier bits, as xterm numbers them in key and mouse reports
+#define TUI_MOD_SHIFT 0x01
+#define TUI_MOD_ALT   0x02
+#define TUI_MOD_CTRL  0x04
+
+typedef struct {
+    uint8_t type;           // tui_input_type_t
+    uint8_t modifiers;      // TUI_MOD_* bits
+    uint32_t key;           // KEY: code point or TUI_KEY_*
+    int button;             // MOUSE: 0 left, 1 middle, 2 right
+    int pressed;            // MOUSE: 1 for a press, 0 for a release or drag
+    int x;                  // MOUSE and WHEEL: 1-based cell
+    int y;
+    int delta;              // WHEEL: rows, positive is down; a burst at one cell is summed
+    const char* text;       // PASTE: in the decoder, valid until the next input_read()
+    size_t text_len;
+} tui_input_event_t;
+
+// Bytes read from stdin but not yet decoded, and the events decoded from them
+typedef struct {
+    int fd;
+    unsigned char ring[TUI_INPUT_RING_SIZE];
+    size_t head;            // Free-running; bytes [head, tail) are undecoded
+    size_t tail;
+    tui_input_event_t events[TUI_INPUT_MAX_EVENTS];
+    size_t event_count;
+    char* paste;            // TUI_INPUT_PASTE_MAX bytes, allocated by the first paste
+    size_t paste_len;
+    size_t paste_start;     // Where the paste being read began in paste
+    int in_paste;           // Between ESC[200~ and ESC[201~
+    int incomplete;         // The ring ends inside a sequence that may still be completed
+    struct timespec incomplete_since;
+    uint64_t reads;         // read() calls that returned data
+    uint64_t bytes;
+    uint64_t decoded;       // Events, before wheel bursts are summed
+} tui_input_t;
+
+// Receives each frame's output instead of stdout (headless rendering)
+typedef void (*screen_sink_t)(const char* data, size_t len, void* context);
+
+// Frame output counters kept by the screen module
+typedef struct {
+    uint64_t frames;
+    uint64_t full_repaints;     // Frames that had to redraw every cell
+    uint64_t bytes;             // Written to the terminal over all frames
+    uint64_t render_ns;         // From screen_begin_frame() to the write, over all frames
+    uint64_t writes;            // write() calls for frame output
+    size_t last_frame_bytes;
+    uint64_t last_render_ns;
+} screen_stats_t;
+
 // Orchestrator for three-pane-tui module
 typedef struct {
     char* module_path;
@@ -131,6 +484,7 @@ extern volatile sig_atomic_t redraw_needed;
 void handle_sigwinch(int sig);
 void handle_sigint(int sig);
 void emergency_cleanup(int sig);
+int run_command(const char* command);
 
 // Core module functions
 void save_cursor_position();
@@ -144,14 +498,41 @@ void set_bold();
 void set_color(int color_code);
 void set_background(int color_code);
 int get_terminal_size(int* width, int* height);
+void set_terminal_size_override(int width, int height);
 char* expandvars(const char* input);
 int enable_mouse_reporting();
 void disable_mouse_reporting();
-int read_mouse_event(int* button, int* x, int* y, int* scroll_delta);
-int read_char_timeout();
-int get_string_display_width(const char* str);
+void enable_bracketed_paste();
+void disable_bracketed_paste();
 char* truncate_string_right_priority(const char* str, int max_width);
 
+// Width module functions (terminal columns of UTF-8 text)
+int codepoint_width(uint32_t cp);
+int glyph_width(uint32_t cp, int* after_joiner);
+size_t utf8_decode(const char* text, size_t len, uint32_t* cp);
+size_t utf8_encode(uint32_t cp, char* out);
+int display_width_n(const char* text, size_t len);
+int get_string_display_width(const char* str);
+
+// Screen module functions (cell-grid framebuffer; drawing goes through these)
+void screen_begin_frame(int width, int height);
+int screen_begin_update(int width, int height, int first_row, int last_row);
+size_t screen_end_frame(void);
+void screen_invalidate(void);
+void screen_clear(void);
+void screen_clear_area(int row, int col, int rows, int cols);
+void screen_move(int row, int col);
+void screen_set_color(int color_code);
+void screen_set_bold(void);
+void screen_reset_attrs(void);
+void screen_puts(const char* text);
+void screen_putc(char c);
+void screen_printf(const char* format, ...) __attribute__((format(printf, 1, 2)));
+int screen_detect_sync_output(int timeout_ms);
+void screen_get_stats(screen_stats_t* stats);
+void screen_set_sink(screen_sink_t sink, void* context);
+void screen_cleanup(void);
+
 // Styles module functions
 int get_file_color(const char* filepath, const style_config_t* styles);
 int get_repo_color(const char* repo_name);
@@ -160,24 +541,82 @@ int color_index_to_ansi(int index);
 void adjust_colors_no_touching(int* colors, size_t count);
 int load_styles(style_config_t* styles, const char* module_path);
 
-// Structure to hold active file information
-typedef struct {
-    char* path;
-    time_t last_updated;
-} active_file_info_t;
-
 // Data module functions
-int load_git_submodules_data(three_pane_tui_orchestrator_t* orch);
-int load_committed_not_pushed_data(three_pane_tui_orchestrator_t* orch, view_mode_t view_mode);
-int load_dirty_files_data(three_pane_tui_orchestrator_t* orch, view_mode_t view_mode);
-active_file_info_t* load_file_changes_data(size_t* active_count);
+int collect_pane_data(dirty_collection_t** dirty_out, unpushed_collection_t** unpushed_out,
+                      char*** submodules_out, size_t* submodule_count_out);
+pane_model_t* build_pane_model_from(const dirty_collection_t* dirty, const unpushed_collection_t* unpushed,
+                                    char** submodules, size_t submodule_count,
+                                    const style_config_t* styles, pane_tree_cache_t* trees);
+pane_model_t* build_pane_model(const style_config_t* styles, pane_tree_cache_t* trees);
+void pane_model_free(pane_model_t* model);
+const char* pane_arena_strdup(pane_arena_t* arena, const char* text);
+void pane_arena_free(pane_arena_t* arena);
+const pane_row_t* pane_row_at(const pane_rows_t* pane, size_t index, pane_row_t* scratch, char* buffer, size_t size);
+void select_pane_view(three_pane_tui_orchestrator_t* orch, view_mode_t view_mode);
+
+// Filter module functions
+uint64_t pane_filter_byte_mask(const char* text);
+int pane_filter_prepare(pane_filter_t* filter, const pane_rows_t* rows);
+size_t pane_filter_update(pane_filter_t* filter, const pane_rows_t* rows, const char* query, size_t len);
+size_t pane_filter_row(const pane_filter_t* filter, size_t index);
+void pane_filter_free(pane_filter_t* filter);
+void apply_pane_filters(three_pane_tui_orchestrator_t* orch);
+void stream_reader_init(stream_reader_t* stream);
+active_file_info_t* load_file_changes_data(stream_reader_t* stream, size_t* active_count);
+void stream_reader_close(stream_reader_t* stream);
+
+// Feed module functions
+void feed_init(feed_client_t* feed);
+int feed_connect(feed_client_t* feed);
+int feed_ensure_daemon(feed_client_t* feed);
+int feed_is_connected(const feed_client_t* feed);
+int feed_process(feed_client_t* feed);
+active_file_info_t* feed_get_active_files(feed_client_t* feed, size_t* active_count);
+void feed_close(feed_client_t* feed);
+
+// Event loop functions
+int events_init(tui_events_t* events);
+void events_set_tick(tui_events_t* events, int interval_ms);
+int events_wait(tui_events_t* events, int feed_fd, int timeout_ms);
+void events_cleanup(tui_events_t* events);
+
+// Input module functions (keys, mouse and paste decoded from stdin)
+void input_init(tui_input_t* input, int fd);
+size_t input_read(tui_input_t* input);
+int input_timeout_ms(const tui_input_t* input, const struct timespec* now);
+size_t input_expire(tui_input_t* input, const struct timespec* now);
+void input_cleanup(tui_input_t* input);
+
+// Tree module functions
+void tree_retain(tree_node_t* node);
+void tree_release(tree_node_t* node);
+void tree_apply(tree_node_t** root, tree_change_t* changes, size_t count);
+size_t tree_row_text(const tree_node_t* root, size_t index, char* buffer, size_t size);
+int tree_walk_rows(const tree_node_t* root, tree_row_sink_t sink, void* context);
+tree_node_t* tree_cache_update(tree_cache_t* cache, const char* key, char** paths, size_t count);
+void tree_cache_sweep(tree_cache_t* cache);
+void tree_cache_free(tree_cache_t* cache);
+
+// Refresh worker functions
+int refresh_worker_start(refresh_worker_t* worker, const style_config_t* styles);
+void refresh_worker_request(refresh_worker_t* worker);
+pane_model_t* refresh_worker_take(refresh_worker_t* worker);
+void refresh_worker_stop(refresh_worker_t* worker);
 
 // Animation module functions
 animation_state_t* create_animation_state(const char* filepath, animation_type_t type, int pane_width);
-void update_animation_state(animation_state_t* anim, int pane_width, time_t now);
+int update_animation_state(animation_state_t* anim, int pane_width, const struct timespec* now, int fps);
 void render_scroll_left_right(animation_state_t* anim, int row, int start_col, int width);
 int is_animation_expired(animation_state_t* anim, time_t now);
 void cleanup_animation_state(animation_state_t* anim);
+animation_state_t* animation_set_find(const animation_set_t* set, const char* filepath);
+int animation_set_add(animation_set_t* set, animation_state_t* anim);
+void animation_set_reschedule(animation_set_t* set, animation_state_t* anim, time_t end_time);
+size_t animation_set_expire(animation_set_t* set, time_t now);
+void animation_set_free(animation_set_t* set);
+int path_set_add(path_set_t* set, const char* path);
+int path_set_contains(const path_set_t* set, const char* path);
+void path_set_free(path_set_t* set);
 
 // Scroll animation functions
 void start_scroll_animation(three_pane_tui_orchestrator_t* orch, int pane_index, int target_position);
@@ -186,8 +625,10 @@ int is_scroll_animation_active(three_pane_tui_orchestrator_t* orch);
 void cancel_scroll_animation(three_pane_tui_orchestrator_t* orch);
 
 // UI module functions
-void draw_pane(int start_col, int width, int height, const char* title, char** items, size_t item_count, int title_color, const style_config_t* styles, int pane_index, const pane_scroll_state_t* scroll_state, three_pane_tui_orchestrator_t* orch);
+void draw_pane(int start_col, int width, int height, const char* title, const pane_rows_t* rows, int title_color, int pane_index, const pane_scroll_state_t* scroll_state, three_pane_tui_orchestrator_t* orch);
 void draw_tui_overlay(three_pane_tui_orchestrator_t* orch);
+void draw_animation_frame(three_pane_tui_orchestrator_t* orch);
+void pane_layout_clear(pane_layout_t* layout);
 int get_pane_at_position(int x, int y, int pane_width, int total_width, int pane_height);
 void update_pane_scroll(pane_scroll_state_t* scroll_state, int direction, int amount);
 void update_scroll_state(pane_scroll_state_t* scroll_state, int viewport_height, int total_items);
@@ -197,6 +638,7 @@ three_pane_tui_orchestrator_t* three_pane_tui_init(const char* module_path);
 void three_pane_tui_cleanup(three_pane_tui_orchestrator_t* orch);
 int three_pane_tui_execute(three_pane_tui_orchestrator_t* orch);
 int load_config(three_pane_tui_orchestrator_t* orch);
+int three_pane_tui_headless(const char* module_path, int argc, char** argv);
 int was_startup_file(three_pane_tui_orchestrator_t* orch, const char* filepath);
 
 #endif // THREE_PANE_TUI_H
@@ -0,0 +1,425 @@
+#include "../three-pane-tui.h"
+
+// TREE view model: one persistent path trie per repository and pane. A scan
+// diffs the repository's new path set against the previous one and merges
+// only the difference into the trie, building each node on a changed path
+// once and sharing every other subtree. Rows are not stored; the row at an
+// index is found by descending through the subtree row counts, so only rows
+// that are drawn get text.
+
+#define TREE_INDENT "│   "
+#define TREE_BRANCH "├── "
+#define TREE_LAST_BRANCH "└── "
+
+void tree_retain(tree_node_t* node) {
+    if (node) __atomic_add_fetch(&node->refs, 1, __ATOMIC_RELAXED);
+}
+
+// Drop one reference; the last one frees the node and releases its children
+void tree_release(tree_node_t* node) {
+    if (!node || __atomic_sub_fetch(&node->refs, 1, __ATOMIC_ACQ_REL) != 0) return;
+    for (size_t i = 0; i < node->child_count; i++) {
+        tree_release(node->children[i]);
+    }
+    free(node->children);
+    free(node->name);
+    free(node);
+}
+
+// New node with one reference, counting itself as a row
+static tree_node_t* node_new(const char* name, size_t len, int is_file) {
+    tree_node_t* node = calloc(1, sizeof(tree_node_t));
+    if (!node) return NULL;
+    node->name = strndup(name, len);
+    if (!node->name) {
+        free(node);
+        return NULL;
+    }
+    node->row_count = 1;
+    node->refs = 1;
+    node->byte_mask = pane_filter_byte_mask(node->name);
+    node->is_file = (uint8_t)is_file;
+    return node;
+}
+
+// Copy of a node sharing its children, with room for extra more
+static tree_node_t* node_copy(const tree_node_t* node, size_t extra) {
+    tree_node_t* copy = calloc(1, sizeof(tree_node_t));
+    if (!copy) return NULL;
+    copy->name = strdup(node->name);
+    copy->children = malloc((node->child_count + extra) * sizeof(tree_node_t*) + 1);
+    if (!copy->name || !copy->children) {
+        free(copy->name);
+        free(copy->children);
+        free(copy);
+        return NULL;
+    }
+    for (size_t i = 0; i < node->child_count; i++) {
+        copy->children[i] = node->children[i];
+        tree_retain(copy->children[i]);
+    }
+    copy->child_count = node->child_count;
+    copy->row_count = node->row_count;
+    copy->refs = 1;
+    copy->byte_mask = node->byte_mask;
+    copy->is_file = node->is_file;
+    return copy;
+}
+
+// Split off the first segment of a path, skipping empty ones ("a//b", "dir/")
+// Returns: segment length, 0 if there is none; *rest is NULL after the last one
+static size_t path_segment(const char** path, const char** rest) {
+    const char* start = *path;
+    while (*start == '/') start++;
+    const char* end = strchr(start, '/');
+    size_t len = end ? (size_t)(end - start) : strlen(start);
+
+    const char* next = end;
+    if (next) {
+        while (*next == '/') next++;
+        if (*next == '\0') next = NULL;
+    }
+    *path = start;
+    *rest = next;
+    return len;
+}
+
+// Compare a child name with a path segment of len bytes
+static int segment_compare(const char* name, const char* segment, size_t len) {
+    int cmp = strncmp(name, segment, len);
+    if (cmp != 0) return cmp;
+    return name[len] != '\0'; // Longer names sort after their prefix
+}
+
+// Order for a scan's changes: path by path segment, as if '/' sorted before
+// every other byte, so changes below one child are contiguous at every level
+// and in the children's order ("a" < "a/b" < "a.txt")
+static int compare_changes(const void* a, const void* b) {
+    const unsigned char* x = (const unsigned char*)((const tree_change_t*)a)->path;
+    const unsigned char* y = (const unsigned char*)((const tree_change_t*)b)->path;
+    while (*x && *x == *y) {
+        x++;
+        y++;
+    }
+    int cx = *x == '/' ? 1 : *x;
+    int cy = *y == '/' ? 1 : *y;
+    return cx - cy;
+}
+
+static tree_node_t* merge_node(const tree_node_t* old, const char* name, size_t len, int is_file,
+                               tree_change_t* changes, size_t count);
+
+// New version of one child: old (NULL if there is none) with changes, whose
+// paths continue below it, and with is_file as the leaf change left it
+// Returns: the child (one reference), or NULL if nothing is left of it
+static tree_node_t* merge_child(const tree_node_t* old, const char* name, size_t len, int is_file,
+                                tree_change_t* changes, size_t count) {
+    tree_node_t* child;
+    if (count > 0) {
+        child = merge_node(old, name, len, is_file, changes, count);
+    } else if (old && old->is_file == is_file) {
+        child = (tree_node_t*)old; // Untouched; shared with the previous version
+        tree_retain(child);
+    } else if (old) {
+        child = node_copy(old, 0);
+        if (child) child->is_file = (uint8_t)is_file;
+    } else {
+        child = is_file ? node_new(name, len, 1) : NULL;
+    }
+
+    // Directories left empty go with their last path
+    if (child && child->child_count == 0 && !child->is_file) {
+        tree_release(child);
+        return NULL;
+    }
+    return child;
+}
+
+// New version of node with a sorted run of changes applied below it. The
+// children are merged with the changes in one pass, so every node on a
+// changed path is built once per scan however many paths change under it,
+// and subtrees without changes are shared.
+// Returns: the node (one reference, counting itself as a row); old, shared,
+// if it cannot be allocated
+static tree_node_t* merge_node(const tree_node_t* old, const char* name, size_t len, int is_file,
+                               tree_change_t* changes, size_t count) {
+    size_t old_count = old ? old->child_count : 0;
+    tree_node_t* node = node_new(name, len, is_file);
+    if (node) node->children = malloc((old_count + count) * sizeof(tree_node_t*) + 1);
+    if (!node || !node->children) {
+        tree_release(node);
+        if (old) tree_retain((tree_node_t*)old);
+        return (tree_node_t*)old;
+    }
+
+    size_t i = 0, c = 0;
+    while (i < old_count || c < count) {
+        const char* segment = NULL;
+        const char* rest = NULL;
+        size_t segment_len = 0;
+        if (c < count) {
+            segment = changes[c].path;
+            segment_len = path_segment(&segment, &rest);
+            if (segment_len == 0) {
+                c++; // Empty path
+                continue;
+            }
+        }
+
+        int cmp = c == count ? -1 : i == old_count ? 1 : segment_compare(old->children[i]->name, segment, segment_len);
+        if (cmp < 0) {
+            tree_retain(old->children[i]);
+            node->children[node->child_count++] = old->children[i++];
+            continue;
+        }
+        const tree_node_t* old_child = cmp == 0 ? old->children[i++] : NULL;
+
+        // The changes under this segment: a change of the segment's own path
+        // sorts first, then those that continue below it
+        int child_is_file = old_child ? old_child->is_file : 0;
+        if (!rest) {
+            child_is_file = changes[c].insert;
+            c++;
+        }
+        size_t first = c;
+        while (c < count) {
+            const char* next = changes[c].path;
+            const char* next_rest;
+            size_t next_len = path_segment(&next, &next_rest);
+            if (next_len != segment_len || memcmp(next, segment, segment_len) != 0 || !next_rest) break;
+            changes[c].path = next_rest;
+            c++;
+        }
+
+        tree_node_t* child = merge_child(old_child, segment, segment_len, child_is_file, changes + first, c - first);
+        if (child) node->children[node->child_count++] = child;
+    }
+
+    for (size_t j = 0; j < node->child_count; j++) {
+        node->row_count += node->children[j]->row_count;
+    }
+    if (node->child_count < old_count + count) {
+        // Give back the room kept for changes that were removals
+        tree_node_t** children = realloc(node->children, node->child_count * sizeof(tree_node_t*) + 1);
+        if (children) node->children = children;
+    }
+    return node;
+}
+
+// Apply one scan's inserted and removed paths, replacing *root with the new
+// version; the change paths are consumed (reordered and advanced)
+void tree_apply(tree_node_t** root, tree_change_t* changes, size_t count) {
+    if (count == 0 && *root) return;
+    qsort(changes, count, sizeof(tree_change_t), compare_changes);
+    tree_node_t* next = merge_node(*root, "", 0, 0, changes, count);
+    if (!next || next == *root) {
+        tree_release(next);
+        return;
+    }
+    next->row_count--; // The root does not count itself
+    tree_release(*root);
+    *root = next;
+}
+
+static size_t append_text(char* buffer, size_t size, size_t pos, const char* text) {
+    size_t len = strlen(text);
+    if (pos + len >= size) len = pos + 1 < size ? size - pos - 1 : 0;
+    memcpy(buffer + pos, text, len);
+    buffer[pos + len] = '\0';
+    return pos + len;
+}
+
+// Text of a row in depth-first order: top-level entries as they are, deeper
+// ones indented with a branch, e.g. "│   ├── file.c"
+// Returns: length written, 0 past the last row
+size_t tree_row_text(const tree_node_t* root, size_t index, char* buffer, size_t size) {
+    if (size == 0) return 0;
+    buffer[0] = '\0';
+    if (!root) return 0;
+
+    const tree_node_t* node = root;
+    size_t depth = 0;
+    for (;;) {
+        // Skip whole subtrees until the one holding the row
+        size_t i = 0;
+        while (i < node->child_count && index >= node->children[i]->row_count) {
+            index -= node->children[i]->row_count;
+            i++;
+        }
+        if (i == node->child_count) return 0;
+
+        const tree_node_t* child = node->children[i];
+        if (index > 0) {
+            index--;
+            node = child;
+            depth++;
+            continue;
+        }
+
+        size_t pos = 0;
+        for (size_t d = 0; d < depth; d++) {
+            pos = append_text(buffer, size, pos, TREE_INDENT);
+        }
+        if (depth > 0) {
+            pos = append_text(buffer, size, pos, i == node->child_count - 1 ? TREE_LAST_BRANCH : TREE_BRANCH);
+        }
+        return append_text(buffer, size, pos, child->name);
+    }
+}
+
+// Byte masks of the drawing a row at some depth is prefixed with
+typedef struct {
+    uint64_t branch;                // Indentation and a branch
+    uint64_t last_branch;           // Indentation and the last branch
+} row_masks_t;
+
+static int walk_rows(const tree_node_t* node, size_t depth, char* buffer, size_t size, size_t prefix_len,
+                     const row_masks_t* masks, size_t* index, tree_row_sink_t sink, void* context) {
+    for (size_t i = 0; i < node->child_count; i++) {
+        const tree_node_t* child = node->children[i];
+        int last = i == node->child_count - 1;
+        size_t pos = prefix_len;
+        uint64_t mask = child->byte_mask;
+        if (depth > 0) {
+            pos = append_text(buffer, size, pos, last ? TREE_LAST_BRANCH : TREE_BRANCH);
+            mask |= last ? masks->last_branch : masks->branch;
+        }
+        pos = append_text(buffer, size, pos, child->name);
+        if (sink(buffer, pos, mask, (*index)++, context) != 0) return -1;
+
+        if (child->child_count > 0) {
+            size_t child_prefix = append_text(buffer, size, prefix_len, TREE_INDENT);
+            if (walk_rows(child, depth + 1, buffer, size, child_prefix, masks, index, sink, context) != 0) return -1;
+        }
+    }
+    return 0;
+}
+
+// Every row's text and byte mask in order, as tree_row_text() and
+// pane_filter_byte_mask() give them, from one depth-first walk that keeps
+// the indentation of the rows above and the masks kept in the nodes
+// Returns: 0, or -1 if the sink stopped the walk
+int tree_walk_rows(const tree_node_t* root, tree_row_sink_t sink, void* context) {
+    if (!root) return 0;
+    uint64_t indent = pane_filter_byte_mask(TREE_INDENT);
+    row_masks_t masks = {indent | pane_filter_byte_mask(TREE_BRANCH), indent | pane_filter_byte_mask(TREE_LAST_BRANCH)};
+    char buffer[1024];
+    buffer[0] = '\0';
+    size_t index = 0;
+    return walk_rows(root, 0, buffer, sizeof(buffer), 0, &masks, &index, sink, context);
+}
+
+static int compare_paths(const void* a, const void* b) {
+    return strcmp(*(char* const*)a, *(char* const*)b);
+}
+
+static repo_tree_t* find_repo_tree(tree_cache_t* cache, const char* key) {
+    for (size_t i = 0; i < cache->count; i++) {
+        if (strcmp(cache->repos[i].key, key) == 0) return &cache->repos[i];
+    }
+
+    repo_tree_t* repos = realloc(cache->repos, (cache->count + 1) * sizeof(repo_tree_t));
+    if (!repos) return NULL;
+    cache->repos = repos;
+    repo_tree_t* repo = &cache->repos[cache->count];
+    memset(repo, 0, sizeof(*repo));
+    repo->key = strdup(key);
+    if (!repo->key) return NULL;
+    cache->count++;
+    return repo;
+}
+
+// Bring a repository's trie up to date with its current path set; only paths
+// added or removed since the previous update touch the trie
+// Returns: the trie (still owned by the cache, NULL if it has never had a path)
+tree_node_t* tree_cache_update(tree_cache_t* cache, const char* key, char** paths, size_t count) {
+    repo_tree_t* repo = find_repo_tree(cache, key);
+    if (!repo) return NULL;
+    repo->seen = 1;
+
+    // Sorted, unique view of the new set
+    char** sorted = malloc((count + 1) * sizeof(char*));
+    if (!sorted) return repo->root;
+    memcpy(sorted, paths, count * sizeof(char*));
+    qsort(sorted, count, sizeof(char*), compare_paths);
+    size_t unique = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (unique == 0 || strcmp(sorted[unique - 1], sorted[i]) != 0) sorted[unique++] = sorted[i];
+    }
+
+    // Merge with the previous set; unchanged paths keep their copies and the
+    // difference goes to the trie in one pass
+    char** next = malloc((unique + 1) * sizeof(char*));
+    char** removed = malloc((repo->path_count + 1) * sizeof(char*));
+    tree_change_t* changes = malloc((repo->path_count + unique + 1) * sizeof(tree_change_t));
+    if (!next || !removed || !changes) {
+        free(next);
+        free(removed);
+        free(changes);
+        free(sorted);
+        return repo->root;
+    }
+    size_t a = 0, b = 0, n = 0, removed_count = 0, change_count = 0;
+    while (a < repo->path_count || b < unique) {
+        int cmp = a == repo->path_count ? 1 : b == unique ? -1 : strcmp(repo->paths[a], sorted[b]);
+        if (cmp == 0) {
+            next[n++] = repo->paths[a++];
+            b++;
+        } else if (cmp < 0) {
+            removed[removed_count++] = repo->paths[a];
+            changes[change_count].path = repo->paths[a++];
+            changes[change_count++].insert = 0;
+            cache->removes++;
+        } else {
+            char* copy = strdup(sorted[b++]);
+            if (!copy) continue;
+            next[n++] = copy;
+            changes[change_count].path = copy;
+            changes[change_count++].insert = 1;
+            cache->inserts++;
+        }
+    }
+    tree_apply(&repo->root, changes, change_count);
+
+    for (size_t i = 0; i < removed_count; i++) {
+        free(removed[i]);
+    }
+    free(removed);
+    free(changes);
+    free(sorted);
+    free(repo->paths);
+    repo->paths = next;
+    repo->path_count = n;
+    return repo->root;
+}
+
+static void free_repo_tree(repo_tree_t* repo) {
+    for (size_t i = 0; i < repo->path_count; i++) {
+        free(repo->paths[i]);
+    }
+    free(repo->paths);
+    free(repo->key);
+    tree_release(repo->root);
+}
+
+// Forget repositories that were not updated since the last sweep
+void tree_cache_sweep(tree_cache_t* cache) {
+    size_t kept = 0;
+    for (size_t i = 0; i < cache->count; i++) {
+        if (!cache->repos[i].seen) {
+            free_repo_tree(&cache->repos[i]);
+            continue;
+        }
+        cache->repos[i].seen = 0;
+        cache->repos[kept++] = cache->repos[i];
+    }
+    cache->count = kept;
+}
+
+void tree_cache_free(tree_cache_t* cache) {
+    for (size_t i = 0; i < cache->count; i++) {
+        free_repo_tree(&cache->repos[i]);
+    }
+    free(cache->repos);
+    memset(cache, 0, sizeof(*cache));
+}
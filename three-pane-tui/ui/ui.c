@@ -73,74 +73,95 @@ int get_pane_at_position(int x, int y, int pane_width, int total_width, int pane
     return 0; // Outside panes
 }
 
-// Extract repository name from a "Repository: reponame" header string
-static char* extract_repo_name_from_header(const char* item) {
-    if (!item) return NULL;
+void pane_layout_clear(pane_layout_t* layout) {
+    free(layout->laid_out);
+    pane_arena_free(&layout->arena);
+    memset(layout, 0, sizeof(*layout));
+}
+
+// Row as drawn at the layout's width; laid out on first use, after which
+// drawing it again measures and allocates nothing
+// Returns: the row, or NULL past the end
+static const pane_row_t* layout_row(pane_layout_t* layout, const pane_rows_t* rows, size_t index, int width) {
+    if (layout->rows != rows || layout->width != width) {
+        pane_layout_clear(layout);
+        layout->laid_out = rows && rows->count > 0 ? calloc(rows->count, sizeof(pane_row_t)) : NULL;
+        if (!layout->laid_out) return NULL;
+        layout->rows = rows;
+        layout->width = width;
+        layout->count = rows->count;
+    }
+    if (index >= layout->count) return NULL;
+
+    pane_row_t* cached = &layout->laid_out[index];
+    if (cached->text) return cached;
+
+    pane_row_t tree_row;
+    char tree_text[1024];
+    const pane_row_t* row = pane_row_at(rows, index, &tree_row, tree_text, sizeof(tree_text));
+    if (!row) return NULL;
+    *cached = *row;
+
+    // Headers are centered as they are; items wider than the pane are
+    // truncated (glyph-aware, prioritizing the filename over the directory path)
+    if (row->kind == PANE_ROW_ITEM && row->display_width > width) {
+        char* truncated = truncate_string_right_priority(row->text, width);
+        cached->text = pane_arena_strdup(&layout->arena, truncated ? truncated : "");
+        cached->display_width = get_string_display_width(cached->text ? cached->text : "");
+        free(truncated);
+    } else if (row->text == tree_text) {
+        cached->text = pane_arena_strdup(&layout->arena, tree_text);
+    }
+    return cached->text ? cached : NULL;
+}
 
-    const char* prefix = "Repository: ";
-    size_t prefix_len = strlen(prefix);
+// Pane 3 rows: one marquee per active animation, starting from row 4; when
+// there are more animations than rows the last row counts the rest instead
+static void draw_animation_rows(three_pane_tui_orchestrator_t* orch, int start_col, int width, int height) {
+    animation_set_t* animations = &orch->data.animations;
+    size_t rows = height > 0 ? (size_t)height : 0;
+    size_t shown = animations->count <= rows ? animations->count : (rows > 0 ? rows - 1 : 0);
+    animations->hidden = animations->count - shown;
 
-    if (strncmp(item, prefix, prefix_len) == 0) {
-        return strdup(item + prefix_len);
+    int current_row = 4;
+    for (size_t i = 0; i < shown; i++) {
+        render_scroll_left_right(animations->order[i], current_row, start_col, width);
+        current_row++;
     }
 
-    return NULL;
+    if (animations->hidden > 0) {
+        char more[32];
+        snprintf(more, sizeof(more), "+%zu more", animations->hidden);
+        if ((int)strlen(more) <= width - 2) {
+            screen_move(current_row, start_col + 1);
+            screen_puts(more);
+        }
+    }
 }
 
 // Draw a single pane with scroll support (pane 3 uses animations instead of items)
-void draw_pane(int start_col, int width, int height, const char* title, char** items, size_t item_count, int title_color, const style_config_t* styles, int pane_index, const pane_scroll_state_t* scroll_state, three_pane_tui_orchestrator_t* orch) {
+void draw_pane(int start_col, int width, int height, const char* title, const pane_rows_t* rows, int title_color, int pane_index, const pane_scroll_state_t* scroll_state, three_pane_tui_orchestrator_t* orch) {
     // Safety checks
-    if (!title || !styles || width <= 0 || height <= 0) {
+    if (!title || width <= 0 || height <= 0) {
         return;
     }
 
     // Handle pane 3 (right pane) - render animations instead of items
     if (pane_index == 3) {
-        // Debug: Clear the entire pane first
-        for (int row = 3; row <= 3 + height; row++) {
-            move_cursor(row, start_col);
-            for (int col = 0; col < width; col++) {
-                putchar(' ');
-            }
-        }
-
-        // Draw title
-        move_cursor(3, start_col);
-        set_color(title_color);
-        set_bold();
-        printf("%s", title);
-        reset_colors();
-
-        // Render active animations starting from row 4
-        int current_row = 4;
-        int max_row = 3 + height;
-        int last_animation_row = current_row;
-
-        for (size_t i = 0; i < orch->data.active_animation_count && current_row <= max_row; i++) {
-            animation_state_t* anim = orch->data.active_animations[i];
-            if (anim) {
-                render_scroll_left_right(anim, current_row, start_col, width);
-                last_animation_row = current_row + 1;
-                current_row++;
-            }
-        }
-
-        // Clear any remaining rows in the pane that no longer have animations
-        for (int clear_row = last_animation_row; clear_row <= max_row; clear_row++) {
-            move_cursor(clear_row, start_col);
-            // Clear the entire row by printing spaces
-            for (int col = 0; col < width; col++) {
-                putchar(' ');
-            }
-        }
-
+        // Draw title (the frame starts blank, so nothing needs clearing)
+        screen_move(3, start_col);
+        screen_set_color(title_color);
+        screen_set_bold();
+        screen_puts(title);
+        screen_reset_attrs();
+
+        draw_animation_rows(orch, start_col, width, height);
         return; // Done rendering pane 3
     }
 
-    // For panes 1 and 2, use the original items-based rendering
-    if (!items) {
-        return;
-    }
+    // For panes 1 and 2, draw rows from the pane model (no rows yet before
+    // the first refresh, but the title is still drawn)
+    size_t item_count = !rows ? 0 : pane_index == 1 ? orch->data.pane1_count : orch->data.pane2_count;
 
     // Draw title at the top of the pane (row 3, since row 1 is main title, row 2 is header separator)
     if (pane_index == 2) {
@@ -150,14 +171,14 @@ void draw_pane(int start_col, int width, int height, const char* title, char** i
         // Ensure it doesn't go beyond the pane boundaries
         if (center_col < start_col) center_col = start_col;
         if (center_col + title_len > start_col + width) center_col = start_col + width - title_len;
-        move_cursor(3, center_col);
+        screen_move(3, center_col);
     } else {
-        move_cursor(3, start_col);
+        screen_move(3, start_col);
     }
-    set_color(title_color);
-    set_bold();
-    printf("%s", title);
-    reset_colors();
+    screen_set_color(title_color);
+    screen_set_bold();
+    screen_puts(title);
+    screen_reset_attrs();
 
     // Draw items starting from row 4 (right after pane title and header separator)
     // height parameter is the available rows for content (from row 4 onwards)
@@ -169,25 +190,6 @@ void draw_pane(int start_col, int width, int height, const char* title, char** i
         return;
     }
 
-    // Phase 1: Assign alternating colors to ALL items (before calculating visible range)
-    int* item_colors = calloc(item_count, sizeof(int));
-    int current_repo_color = 0; // Will be assigned alternating colors 1, 2, 3, 4, etc.
-
-    for (size_t i = 0; i < item_count; i++) {
-        char* repo_name = extract_repo_name_from_header(items[i]);
-        if (repo_name) {
-            // Repository header - assign next alternating color
-            current_repo_color++;
-            // Wrap around to rainbow table (1-8)
-            if (current_repo_color > 8) current_repo_color = 1;
-            item_colors[i] = current_repo_color;
-            free(repo_name);
-        } else {
-            // Content item - use the current repository's color
-            item_colors[i] = current_repo_color;
-        }
-    }
-
     // Calculate which items to show based on scroll position
     size_t start_item = scroll_state ? scroll_state->scroll_position : 0;
 
@@ -201,56 +203,29 @@ void draw_pane(int start_col, int width, int height, const char* title, char** i
         end_item = item_count;
     }
 
-    // Additional safety: ensure start_item doesn't exceed end_item
-    if (start_item > end_item) {
-        start_item = (end_item > 0) ? end_item - 1 : 0;
-    }
-
-    // Draw visible items only
+    // Draw visible rows only, from the layout kept for this width; while the
+    // "/" filter is on, drawn rows map to the pane rows it kept
+    pane_layout_t* layout = pane_index == 1 ? &orch->data.pane1_layout : &orch->data.pane2_layout;
+    const pane_filter_t* filter = pane_index == 1 ? &orch->data.pane1_filter : &orch->data.pane2_filter;
     for (size_t i = start_item; i < end_item && current_row <= max_row; i++) {
-        // CRITICAL FIX: Validate array access
-        if (i >= item_count || !items[i]) {
-            break; // Safety: stop if out of bounds
-        }
-        move_cursor(current_row, start_col);
+        const pane_row_t* row = layout_row(layout, rows, pane_filter_row(filter, i), width);
+        if (!row) break;
 
-        // Check if this is a repository header
-        char* repo_name = extract_repo_name_from_header(items[i]);
-        if (repo_name) {
-            // This is a repository header - center it and use adjusted repo color
-            int repo_ansi_color = color_index_to_ansi(item_colors[i]);
-
-            // Center the header text within the pane width
-            int text_len = strlen(items[i]);
-            int center_col = start_col + (width - text_len) / 2;
+        if (row->kind == PANE_ROW_HEADER) {
+            // Repository header - centered in its repository color
+            int center_col = start_col + (width - row->display_width) / 2;
             if (center_col < start_col) center_col = start_col;
-            if (center_col + text_len > start_col + width) center_col = start_col + width - text_len;
-
-            move_cursor(current_row, center_col);
-            set_color(repo_ansi_color);
-            set_bold();
-            printf("%s", items[i]);
-            reset_colors();
 
-            free(repo_name);
+            screen_move(current_row, center_col);
+            screen_set_color(row->color);
+            screen_set_bold();
+            screen_puts(row->text);
+            screen_reset_attrs();
         } else {
-            // This is a content item - use adjusted repo color or file color
-            int item_color = item_colors[i] ? color_index_to_ansi(item_colors[i]) : get_file_color(items[i], styles);
-            set_color(item_color);
-
-            // Smart truncation prioritizing filename over directory path
-            const char* text = items[i];
-            int max_text_width = width; // Fill the pane completely
-
-            // Use glyph-aware right-priority truncation for all content
-            char* display_text = truncate_string_right_priority(text, max_text_width);
-            if (display_text) {
-                printf("%s", display_text);
-                free(display_text);
-            } else {
-                printf("(null)");
-            }
-            reset_colors();
+            screen_move(current_row, start_col);
+            screen_set_color(row->color);
+            screen_puts(row->text);
+            screen_reset_attrs();
         }
 
         current_row++;
@@ -260,21 +235,18 @@ void draw_pane(int start_col, int width, int height, const char* title, char** i
     if (scroll_state && scroll_state->max_scroll > 0) {
         // Draw up arrow if not at top
         if (scroll_state->scroll_position > 0) {
-            move_cursor(4, start_col + width - 1);
-            set_color(32); // Green
-            printf("↑");
+            screen_move(4, start_col + width - 1);
+            screen_set_color(32); // Green
+            screen_puts("↑");
         }
 
         // Draw down arrow if not at bottom
         if (scroll_state->scroll_position < scroll_state->max_scroll) {
-            move_cursor(3 + height, start_col + width - 1);
-            set_color(32); // Green
-            printf("↓");
+            screen_move(3 + height, start_col + width - 1);
+            screen_set_color(32); // Green
+            screen_puts("↓");
         }
     }
-
-    // Cleanup color array
-    free(item_colors);
 }
 
 // Draw the three-pane TUI overlay
@@ -284,32 +256,32 @@ void draw_tui_overlay(three_pane_tui_orchestrator_t* orch) {
     int width, height;
     get_terminal_size(&width, &height);
 
+    // Everything below draws into the back buffer; screen_end_frame() writes the difference
+    screen_begin_frame(width, height);
+
     // Safety checks for minimum terminal size
     if (width < 20 || height < 10) {
-        clear_screen();
-        move_cursor(1, 1);
-        printf("Terminal too small. Minimum size: 20x10");
-        fflush(stdout);
+        screen_move(1, 1);
+        screen_puts("Terminal too small. Minimum size: 20x10");
+        screen_end_frame();
         return;
     }
 
-    clear_screen();
-
     // Main title at the very top
-    move_cursor(1, 1);
-    set_color(orch->config.styles.ui.title_color);
-    set_bold();
+    screen_move(1, 1);
+    screen_set_color(orch->config.styles.ui.title_color);
+    screen_set_bold();
     const char* view_name = (orch->current_view == VIEW_FLAT) ? "FLAT" : "TREE";
-    printf("%s (%s)", orch->config.title, view_name);
-    reset_colors();
+    screen_printf("%s (%s)", orch->config.title, view_name);
+    screen_reset_attrs();
 
     // Horizontal line under the header
-    move_cursor(2, 1);
-    set_color(orch->config.styles.ui.header_separator_color);
+    screen_move(2, 1);
+    screen_set_color(orch->config.styles.ui.header_separator_color);
     for (int i = 0; i < width; i++) {
-        printf("─");
+        screen_puts("─");
     }
-    reset_colors();
+    screen_reset_attrs();
 
     // Calculate pane dimensions to maximize screen real estate
     int pane_width = width / 3;
@@ -317,37 +289,37 @@ void draw_tui_overlay(three_pane_tui_orchestrator_t* orch) {
     int pane_height = height - 5; // Available rows: total height minus main title, header separator, pane titles, footer separator, and footer text
 
     // Draw vertical border lines between panes
-    set_color(orch->config.styles.ui.borders.vertical);
+    screen_set_color(orch->config.styles.ui.borders.vertical);
     for (int row = 3; row <= height - 2; row++) { // From row 3 to row before footer separator
         // Border between pane 1 and 2
-        move_cursor(row, pane_width);
-        printf("│");
+        screen_move(row, pane_width);
+        screen_puts("│");
 
         // Border between pane 2 and 3
-        move_cursor(row, pane_width * 2);
-        printf("│");
+        screen_move(row, pane_width * 2);
+        screen_puts("│");
     }
-    reset_colors();
+    screen_reset_attrs();
 
     // Horizontal line above the footer
-    move_cursor(height - 1, 1);
-    set_color(32); // Green for footer separator
+    screen_move(height - 1, 1);
+    screen_set_color(32); // Green for footer separator
     for (int i = 0; i < width; i++) {
-        printf("─");
+        screen_puts("─");
     }
-    reset_colors();
+    screen_reset_attrs();
 
     // Draw three panes side by side, maximizing screen space
     // Each pane starts at row 2 (below the main title)
     draw_pane(1, pane_width - 1, pane_height, orch->config.pane1_title,
-              orch->data.pane1_items, orch->data.pane1_count, orch->config.styles.ui.pane_titles.left, &orch->config.styles, 1, &orch->data.pane1_scroll, orch);
+              orch->data.pane1_rows, orch->config.styles.ui.pane_titles.left, 1, &orch->data.pane1_scroll, orch);
 
     draw_pane(pane_width + 1, pane_width - 1, pane_height, orch->config.pane2_title,
-              orch->data.pane2_items, orch->data.pane2_count, orch->config.styles.ui.pane_titles.center, &orch->config.styles, 2, &orch->data.pane2_scroll, orch);
+              orch->data.pane2_rows, orch->config.styles.ui.pane_titles.center, 2, &orch->data.pane2_scroll, orch);
 
     // Rightmost pane gets any remaining width minus the border (uses animations, not items)
     draw_pane(pane_width * 2 + 1, pane_width + remaining_width - 1, pane_height, orch->config.pane3_title,
-              NULL, 0, orch->config.styles.ui.pane_titles.right, &orch->config.styles, 3, NULL, orch);
+              NULL, orch->config.styles.ui.pane_titles.right, 3, NULL, orch);
 
     // Show fast scroll progress bar in pane 1 if active (overlay on content)
     if (is_scroll_animation_active(orch)) {
@@ -363,27 +335,57 @@ void draw_tui_overlay(three_pane_tui_orchestrator_t* orch) {
         int progress_row = 3 + pane_height - 1; // Bottom row of pane 1
         int progress_col = 1; // Start of pane 1
 
-        move_cursor(progress_row, progress_col);
-        set_color(32); // Green for progress bar
-        set_bold();
-        printf("FAST SCROLL [");
+        screen_move(progress_row, progress_col);
+        screen_set_color(32); // Green for progress bar
+        screen_set_bold();
+        screen_puts("FAST SCROLL [");
         int bar_width = pane_width - 15; // Leave space for text
         if (bar_width > 20) bar_width = 20; // Cap at reasonable width
         int filled = (int)(progress * bar_width);
         for (int i = 0; i < bar_width; i++) {
-            if (i < filled) printf("█");
-            else printf("░");
+            if (i < filled) screen_puts("█");
+            else screen_puts("░");
         }
-        printf("] %.0f%%", progress * 100.0);
-        reset_colors();
+        screen_printf("] %.0f%%", progress * 100.0);
+        screen_reset_attrs();
     }
 
     // Footer at bottom (after the horizontal separator)
-    move_cursor(height, 1);
-    set_color(32); // Green for footer text
+    screen_move(height, 1);
+    screen_set_color(32); // Green for footer text
     const char* current_view = (orch->current_view == VIEW_FLAT) ? "FLAT" : "TREE";
-    printf("Ctrl+C to escape | [%s] click to toggle view", current_view);
-    reset_colors();
+    screen_printf("Ctrl+C to escape | [%s] click to toggle view", current_view);
+    if (orch->data.filter_editing) {
+        screen_printf(" | Filter: /%.*s_  Enter to keep", (int)orch->data.filter_query_len, orch->data.filter_query);
+    } else if (orch->data.filter_query_len > 0) {
+        screen_printf(" | Filter: /%.*s  / to change", (int)orch->data.filter_query_len, orch->data.filter_query);
+    } else {
+        screen_puts(" | / to filter");
+    }
+    screen_reset_attrs();
+
+    screen_end_frame();
+}
+
+// Animation frame: redraw only pane 3's rows on top of the last frame, so a
+// marquee step costs neither the other panes' drawing nor their diff
+void draw_animation_frame(three_pane_tui_orchestrator_t* orch) {
+    if (!orch) return;
+
+    int width, height;
+    get_terminal_size(&width, &height);
+    int pane_width = width / 3;
+    int pane_height = height - 5;
+    if (width < 20 || height < 10 || is_scroll_animation_active(orch) ||
+        screen_begin_update(width, height, 4, 3 + pane_height) != 0) {
+        draw_tui_overlay(orch);
+        return;
+    }
 
-    fflush(stdout);
+    // Same geometry as draw_tui_overlay()
+    int start_col = pane_width * 2 + 1;
+    int pane3_width = pane_width + width % 3 - 1;
+    screen_clear_area(4, start_col, pane_height, pane3_width);
+    draw_animation_rows(orch, start_col, pane3_width, pane_height);
+    screen_end_frame();
 }
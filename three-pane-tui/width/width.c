@@ -0,0 +1,425 @@
+#ifdef WIDTH_BENCHMARK
+#define _XOPEN_SOURCE 700 // wcswidth() for comparison
+#endif
+#include "../three-pane-tui.h"
+
+// Display width of UTF-8 text in terminal columns, shared by measurement,
+// truncation, centering, the scroll animation and the screen's cell grid so
+// they all agree. Printable ASCII, almost all of every path, is counted
+// eight bytes at a time; everything else is looked up per code point.
+//
+// Per code point: East Asian Wide and Fullwidth characters (which include
+// emoji with emoji presentation) take two columns; combining marks, format
+// characters and Hangul medial and final jamo take none; the rest take one.
+// A glyph after a zero width joiner belongs to the same emoji sequence and
+// takes no columns of its own.
+
+#define WIDTH_ZWJ 0x200D
+
+typedef struct {
+    uint32_t first;
+    uint32_t last;
+} width_range_t;
+
+// Generated from the Unicode 14.0 character database: categories Mn, Me and
+// Cf except U+00AD, plus U+1160-11FF, U+D7B0-D7FF and U+200B; assigned code
+// points only
+static const width_range_t zero_width_ranges[] = {
+    { 0x0300, 0x036F }, { 0x0483, 0x0489 }, { 0x0591, 0x05BD }, { 0x05BF, 0x05BF },
+    { 0x05C1, 0x05C2 }, { 0x05C4, 0x05C5 }, { 0x05C7, 0x05C7 }, { 0x0600, 0x0605 },
+    { 0x0610, 0x061A }, { 0x061C, 0x061C }, { 0x064B, 0x065F }, { 0x0670, 0x0670 },
+    { 0x06D6, 0x06DD }, { 0x06DF, 0x06E4 }, { 0x06E7, 0x06E8 }, { 0x06EA, 0x06ED },
+    { 0x070F, 0x070F }, { 0x0711, 0x0711 }, { 0x0730, 0x074A }, { 0x07A6, 0x07B0 },
+    { 0x07EB, 0x07F3 }, { 0x07FD, 0x07FD }, { 0x0816, 0x0819 }, { 0x081B, 0x0823 },
+    { 0x0825, 0x0827 }, { 0x0829, 0x082D }, { 0x0859, 0x085B }, { 0x0890, 0x0891 },
+    { 0x0898, 0x089F }, { 0x08CA, 0x0902 }, { 0x093A, 0x093A }, { 0x093C, 0x093C },
+    { 0x0941, 0x0948 }, { 0x094D, 0x094D }, { 0x0951, 0x0957 }, { 0x0962, 0x0963 },
+    { 0x0981, 0x0981 }, { 0x09BC, 0x09BC }, { 0x09C1, 0x09C4 }, { 0x09CD, 0x09CD },
+    { 0x09E2, 0x09E3 }, { 0x09FE, 0x09FE }, { 0x0A01, 0x0A02 }, { 0x0A3C, 0x0A3C },
+    { 0x0A41, 0x0A42 }, { 0x0A47, 0x0A48 }, { 0x0A4B, 0x0A4D }, { 0x0A51, 0x0A51 },
+    { 0x0A70, 0x0A71 }, { 0x0A75, 0x0A75 }, { 0x0A81, 0x0A82 }, { 0x0ABC, 0x0ABC },
+    { 0x0AC1, 0x0AC5 }, { 0x0AC7, 0x0AC8 }, { 0x0ACD, 0x0ACD }, { 0x0AE2, 0x0AE3 },
+    { 0x0AFA, 0x0AFF }, { 0x0B01, 0x0B01 }, { 0x0B3C, 0x0B3C }, { 0x0B3F, 0x0B3F },
+    { 0x0B41, 0x0B44 }, { 0x0B4D, 0x0B4D }, { 0x0B55, 0x0B56 }, { 0x0B62, 0x0B63 },
+    { 0x0B82, 0x0B82 }, { 0x0BC0, 0x0BC0 }, { 0x0BCD, 0x0BCD }, { 0x0C00, 0x0C00 },
+    { 0x0C04, 0x0C04 }, { 0x0C3C, 0x0C3C }, { 0x0C3E, 0x0C40 }, { 0x0C46, 0x0C48 },
+    { 0x0C4A, 0x0C4D }, { 0x0C55, 0x0C56 }, { 0x0C62, 0x0C63 }, { 0x0C81, 0x0C81 },
+    { 0x0CBC, 0x0CBC }, { 0x0CBF, 0x0CBF }, { 0x0CC6, 0x0CC6 }, { 0x0CCC, 0x0CCD },
+    { 0x0CE2, 0x0CE3 }, { 0x0D00, 0x0D01 }, { 0x0D3B, 0x0D3C }, { 0x0D41, 0x0D44 },
+    { 0x0D4D, 0x0D4D }, { 0x0D62, 0x0D63 }, { 0x0D81, 0x0D81 }, { 0x0DCA, 0x0DCA },
+    { 0x0DD2, 0x0DD4 }, { 0x0DD6, 0x0DD6 }, { 0x0E31, 0x0E31 }, { 0x0E34, 0x0E3A },
+    { 0x0E47, 0x0E4E }, { 0x0EB1, 0x0EB1 }, { 0x0EB4, 0x0EBC }, { 0x0EC8, 0x0ECD },
+    { 0x0F18, 0x0F19 }, { 0x0F35, 0x0F35 }, { 0x0F37, 0x0F37 }, { 0x0F39, 0x0F39 },
+    { 0x0F71, 0x0F7E }, { 0x0F80, 0x0F84 }, { 0x0F86, 0x0F87 }, { 0x0F8D, 0x0F97 },
+    { 0x0F99, 0x0FBC }, { 0x0FC6, 0x0FC6 }, { 0x102D, 0x1030 }, { 0x1032, 0x1037 },
+    { 0x1039, 0x103A }, { 0x103D, 0x103E }, { 0x1058, 0x1059 }, { 0x105E, 0x1060 },
+    { 0x1071, 0x1074 }, { 0x1082, 0x1082 }, { 0x1085, 0x1086 }, { 0x108D, 0x108D },
+    { 0x109D, 0x109D }, { 0x1160, 0x11FF }, { 0x135D, 0x135F }, { 0x1712, 0x1714 },
+    { 0x1732, 0x1733 }, { 0x1752, 0x1753 }, { 0x1772, 0x1773 }, { 0x17B4, 0x17B5 },
+    { 0x17B7, 0x17BD }, { 0x17C6, 0x17C6 }, { 0x17C9, 0x17D3 }, { 0x17DD, 0x17DD },
+    { 0x180B, 0x180F }, { 0x1885, 0x1886 }, { 0x18A9, 0x18A9 }, { 0x1920, 0x1922 },
+    { 0x1927, 0x1928 }, { 0x1932, 0x1932 }, { 0x1939, 0x193B }, { 0x1A17, 0x1A18 },
+    { 0x1A1B, 0x1A1B }, { 0x1A56, 0x1A56 }, { 0x1A58, 0x1A5E }, { 0x1A60, 0x1A60 },
+    { 0x1A62, 0x1A62 }, { 0x1A65, 0x1A6C }, { 0x1A73, 0x1A7C }, { 0x1A7F, 0x1A7F },
+    { 0x1AB0, 0x1ACE }, { 0x1B00, 0x1B03 }, { 0x1B34, 0x1B34 }, { 0x1B36, 0x1B3A },
+    { 0x1B3C, 0x1B3C }, { 0x1B42, 0x1B42 }, { 0x1B6B, 0x1B73 }, { 0x1B80, 0x1B81 },
+    { 0x1BA2, 0x1BA5 }, { 0x1BA8, 0x1BA9 }, { 0x1BAB, 0x1BAD }, { 0x1BE6, 0x1BE6 },
+    { 0x1BE8, 0x1BE9 }, { 0x1BED, 0x1BED }, { 0x1BEF, 0x1BF1 }, { 0x1C2C, 0x1C33 },
+    { 0x1C36, 0x1C37 }, { 0x1CD0, 0x1CD2 }, { 0x1CD4, 0x1CE0 }, { 0x1CE2, 0x1CE8 },
+    { 0x1CED, 0x1CED }, { 0x1CF4, 0x1CF4 }, { 0x1CF8, 0x1CF9 }, { 0x1DC0, 0x1DFF },
+    { 0x200B, 0x200F }, { 0x202A, 0x202E }, { 0x2060, 0x2064 }, { 0x2066, 0x206F },
+    { 0x20D0, 0x20F0 }, { 0x2CEF, 0x2CF1 }, { 0x2D7F, 0x2D7F }, { 0x2DE0, 0x2DFF },
+    { 0x302A, 0x302D }, { 0x3099, 0x309A }, { 0xA66F, 0xA672 }, { 0xA674, 0xA67D },
+    { 0xA69E, 0xA69F }, { 0xA6F0, 0xA6F1 }, { 0xA802, 0xA802 }, { 0xA806, 0xA806 },
+    { 0xA80B, 0xA80B }, { 0xA825, 0xA826 }, { 0xA82C, 0xA82C }, { 0xA8C4, 0xA8C5 },
+    { 0xA8E0, 0xA8F1 }, { 0xA8FF, 0xA8FF }, { 0xA926, 0xA92D }, { 0xA947, 0xA951 },
+    { 0xA980, 0xA982 }, { 0xA9B3, 0xA9B3 }, { 0xA9B6, 0xA9B9 }, { 0xA9BC, 0xA9BD },
+    { 0xA9E5, 0xA9E5 }, { 0xAA29, 0xAA2E }, { 0xAA31, 0xAA32 }, { 0xAA35, 0xAA36 },
+    { 0xAA43, 0xAA43 }, { 0xAA4C, 0xAA4C }, { 0xAA7C, 0xAA7C }, { 0xAAB0, 0xAAB0 },
+    { 0xAAB2, 0xAAB4 }, { 0xAAB7, 0xAAB8 }, { 0xAABE, 0xAABF }, { 0xAAC1, 0xAAC1 },
+    { 0xAAEC, 0xAAED }, { 0xAAF6, 0xAAF6 }, { 0xABE5, 0xABE5 }, { 0xABE8, 0xABE8 },
+    { 0xABED, 0xABED }, { 0xD7B0, 0xD7FF }, { 0xFB1E, 0xFB1E }, { 0xFE00, 0xFE0F },
+    { 0xFE20, 0xFE2F }, { 0xFEFF, 0xFEFF }, { 0xFFF9, 0xFFFB }, { 0x101FD, 0x101FD },
+    { 0x102E0, 0x102E0 }, { 0x10376, 0x1037A }, { 0x10A01, 0x10A03 }, { 0x10A05, 0x10A06 },
+    { 0x10A0C, 0x10A0F }, { 0x10A38, 0x10A3A }, { 0x10A3F, 0x10A3F }, { 0x10AE5, 0x10AE6 },
+    { 0x10D24, 0x10D27 }, { 0x10EAB, 0x10EAC }, { 0x10F46, 0x10F50 }, { 0x10F82, 0x10F85 },
+    { 0x11001, 0x11001 }, { 0x11038, 0x11046 }, { 0x11070, 0x11070 }, { 0x11073, 0x11074 },
+    { 0x1107F, 0x11081 }, { 0x110B3, 0x110B6 }, { 0x110B9, 0x110BA }, { 0x110BD, 0x110BD },
+    { 0x110C2, 0x110C2 }, { 0x110CD, 0x110CD }, { 0x11100, 0x11102 }, { 0x11127, 0x1112B },
+    { 0x1112D, 0x11134 }, { 0x11173, 0x11173 }, { 0x11180, 0x11181 }, { 0x111B6, 0x111BE },
+    { 0x111C9, 0x111CC }, { 0x111CF, 0x111CF }, { 0x1122F, 0x11231 }, { 0x11234, 0x11234 },
+    { 0x11236, 0x11237 }, { 0x1123E, 0x1123E }, { 0x112DF, 0x112DF }, { 0x112E3, 0x112EA },
+    { 0x11300, 0x11301 }, { 0x1133B, 0x1133C }, { 0x11340, 0x11340 }, { 0x11366, 0x1136C },
+    { 0x11370, 0x11374 }, { 0x11438, 0x1143F }, { 0x11442, 0x11444 }, { 0x11446, 0x11446 },
+    { 0x1145E, 0x1145E }, { 0x114B3, 0x114B8 }, { 0x114BA, 0x114BA }, { 0x114BF, 0x114C0 },
+    { 0x114C2, 0x114C3 }, { 0x115B2, 0x115B5 }, { 0x115BC, 0x115BD }, { 0x115BF, 0x115C0 },
+    { 0x115DC, 0x115DD }, { 0x11633, 0x1163A }, { 0x1163D, 0x1163D }, { 0x1163F, 0x11640 },
+    { 0x116AB, 0x116AB }, { 0x116AD, 0x116AD }, { 0x116B0, 0x116B5 }, { 0x116B7, 0x116B7 },
+    { 0x1171D, 0x1171F }, { 0x11722, 0x11725 }, { 0x11727, 0x1172B }, { 0x1182F, 0x11837 },
+    { 0x11839, 0x1183A }, { 0x1193B, 0x1193C }, { 0x1193E, 0x1193E }, { 0x11943, 0x11943 },
+    { 0x119D4, 0x119D7 }, { 0x119DA, 0x119DB }, { 0x119E0, 0x119E0 }, { 0x11A01, 0x11A0A },
+    { 0x11A33, 0x11A38 }, { 0x11A3B, 0x11A3E }, { 0x11A47, 0x11A47 }, { 0x11A51, 0x11A56 },
+    { 0x11A59, 0x11A5B }, { 0x11A8A, 0x11A96 }, { 0x11A98, 0x11A99 }, { 0x11C30, 0x11C36 },
+    { 0x11C38, 0x11C3D }, { 0x11C3F, 0x11C3F }, { 0x11C92, 0x11CA7 }, { 0x11CAA, 0x11CB0 },
+    { 0x11CB2, 0x11CB3 }, { 0x11CB5, 0x11CB6 }, { 0x11D31, 0x11D36 }, { 0x11D3A, 0x11D3A },
+    { 0x11D3C, 0x11D3D }, { 0x11D3F, 0x11D45 }, { 0x11D47, 0x11D47 }, { 0x11D90, 0x11D91 },
+    { 0x11D95, 0x11D95 }, { 0x11D97, 0x11D97 }, { 0x11EF3, 0x11EF4 }, { 0x13430, 0x13438 },
+    { 0x16AF0, 0x16AF4 }, { 0x16B30, 0x16B36 }, { 0x16F4F, 0x16F4F }, { 0x16F8F, 0x16F92 },
+    { 0x16FE4, 0x16FE4 }, { 0x1BC9D, 0x1BC9E }, { 0x1BCA0, 0x1BCA3 }, { 0x1CF00, 0x1CF2D },
+    { 0x1CF30, 0x1CF46 }, { 0x1D167, 0x1D169 }, { 0x1D173, 0x1D182 }, { 0x1D185, 0x1D18B },
+    { 0x1D1AA, 0x1D1AD }, { 0x1D242, 0x1D244 }, { 0x1DA00, 0x1DA36 }, { 0x1DA3B, 0x1DA6C },
+    { 0x1DA75, 0x1DA75 }, { 0x1DA84, 0x1DA84 }, { 0x1DA9B, 0x1DA9F }, { 0x1DAA1, 0x1DAAF },
+    { 0x1E000, 0x1E006 }, { 0x1E008, 0x1E018 }, { 0x1E01B, 0x1E021 }, { 0x1E023, 0x1E024 },
+    { 0x1E026, 0x1E02A }, { 0x1E130, 0x1E136 }, { 0x1E2AE, 0x1E2AE }, { 0x1E2EC, 0x1E2EF },
+    { 0x1E8D0, 0x1E8D6 }, { 0x1E944, 0x1E94A }, { 0xE0001, 0xE0001 }, { 0xE0020, 0xE007F },
+    { 0xE0100, 0xE01EF },
+};
+
+// Generated from the Unicode 14.0 character database: assigned code points
+// with East_Asian_Width W or F, plus planes 2 and 3; a run of unassigned code
+// points is merged in only between two wide ranges. Other unassigned code
+// points, which later versions may fill with narrow characters, take one.
+static const width_range_t wide_ranges[] = {
+    { 0x1100, 0x115F }, { 0x231A, 0x231B }, { 0x2329, 0x232A }, { 0x23E9, 0x23EC },
+    { 0x23F0, 0x23F0 }, { 0x23F3, 0x23F3 }, { 0x25FD, 0x25FE }, { 0x2614, 0x2615 },
+    { 0x2648, 0x2653 }, { 0x267F, 0x267F }, { 0x2693, 0x2693 }, { 0x26A1, 0x26A1 },
+    { 0x26AA, 0x26AB }, { 0x26BD, 0x26BE }, { 0x26C4, 0x26C5 }, { 0x26CE, 0x26CE },
+    { 0x26D4, 0x26D4 }, { 0x26EA, 0x26EA }, { 0x26F2, 0x26F3 }, { 0x26F5, 0x26F5 },
+    { 0x26FA, 0x26FA }, { 0x26FD, 0x26FD }, { 0x2705, 0x2705 }, { 0x270A, 0x270B },
+    { 0x2728, 0x2728 }, { 0x274C, 0x274C }, { 0x274E, 0x274E }, { 0x2753, 0x2755 },
+    { 0x2757, 0x2757 }, { 0x2795, 0x2797 }, { 0x27B0, 0x27B0 }, { 0x27BF, 0x27BF },
+    { 0x2B1B, 0x2B1C }, { 0x2B50, 0x2B50 }, { 0x2B55, 0x2B55 }, { 0x2E80, 0x303E },
+    { 0x3041, 0x3247 }, { 0x3250, 0x4DBF }, { 0x4E00, 0xA4C6 }, { 0xA960, 0xA97C },
+    { 0xAC00, 0xD7A3 }, { 0xF900, 0xFAD9 }, { 0xFE10, 0xFE19 }, { 0xFE30, 0xFE6B },
+    { 0xFF01, 0xFF60 }, { 0xFFE0, 0xFFE6 }, { 0x16FE0, 0x1B2FB }, { 0x1F004, 0x1F004 },
+    { 0x1F0CF, 0x1F0CF }, { 0x1F18E, 0x1F18E }, { 0x1F191, 0x1F19A }, { 0x1F200, 0x1F320 },
+    { 0x1F32D, 0x1F335 }, { 0x1F337, 0x1F37C }, { 0x1F37E, 0x1F393 }, { 0x1F3A0, 0x1F3CA },
+    { 0x1F3CF, 0x1F3D3 }, { 0x1F3E0, 0x1F3F0 }, { 0x1F3F4, 0x1F3F4 }, { 0x1F3F8, 0x1F43E },
+    { 0x1F440, 0x1F440 }, { 0x1F442, 0x1F4FC }, { 0x1F4FF, 0x1F53D }, { 0x1F54B, 0x1F54E },
+    { 0x1F550, 0x1F567 }, { 0x1F57A, 0x1F57A }, { 0x1F595, 0x1F596 }, { 0x1F5A4, 0x1F5A4 },
+    { 0x1F5FB, 0x1F64F }, { 0x1F680, 0x1F6C5 }, { 0x1F6CC, 0x1F6CC }, { 0x1F6D0, 0x1F6D2 },
+    { 0x1F6D5, 0x1F6DF }, { 0x1F6EB, 0x1F6EC }, { 0x1F6F4, 0x1F6FC }, { 0x1F7E0, 0x1F7F0 },
+    { 0x1F90C, 0x1F93A }, { 0x1F93C, 0x1F945 }, { 0x1F947, 0x1F9FF }, { 0x1FA70, 0x1FAF6 },
+    { 0x20000, 0x3FFFD },
+};
+
+static int in_ranges(const width_range_t* ranges, size_t count, uint32_t cp) {
+    if (cp < ranges[0].first || cp > ranges[count - 1].last) return 0;
+    size_t lo = 0, hi = count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (cp > ranges[mid].last) lo = mid + 1;
+        else if (cp < ranges[mid].first) hi = mid;
+        else return 1;
+    }
+    return 0;
+}
+
+// Width of a code point from the range tables
+static int lookup_width(uint32_t cp) {
+    if (cp >= 0x20 && cp < 0x7F) return 1;
+    if (cp == '\t') return 1; // The screen draws tabs as a space
+    if (cp < 0x20 || (cp >= 0x7F && cp < 0xA0)) return 0;
+    if (cp < 0x300) return 1; // Latin ranges, including the soft hyphen
+    if (in_ranges(zero_width_ranges, sizeof(zero_width_ranges) / sizeof(zero_width_ranges[0]), cp)) return 0;
+    if (in_ranges(wide_ranges, sizeof(wide_ranges) / sizeof(wide_ranges[0]), cp)) return 2;
+    return 1;
+}
+
+// The Basic Multilingual Plane, where nearly all text lives, is expanded
+// into a flat table of 2-bit widths (16 KiB) on first use
+static uint8_t bmp_widths[0x10000 / 4];
+static pthread_once_t bmp_widths_once = PTHREAD_ONCE_INIT;
+static int bmp_widths_ready;
+
+static void build_bmp_widths(void) {
+    for (uint32_t cp = 0; cp < 0x10000; cp++) {
+        bmp_widths[cp >> 2] |= (uint8_t)(lookup_width(cp) << ((cp & 3) * 2));
+    }
+    __atomic_store_n(&bmp_widths_ready, 1, __ATOMIC_RELEASE);
+}
+
+// Columns a single code point takes: 0, 1 or 2
+int codepoint_width(uint32_t cp) {
+    if (cp >= 0x20 && cp < 0x7F) return 1;
+    if (cp >= 0x10000) return lookup_width(cp);
+    if (!__atomic_load_n(&bmp_widths_ready, __ATOMIC_ACQUIRE)) pthread_once(&bmp_widths_once, build_bmp_widths);
+    return (bmp_widths[cp >> 2] >> ((cp & 3) * 2)) & 3;
+}
+
+// Columns the next glyph of a sequence takes; *after_joiner carries the
+// joiner state from one code point to the next (start it at 0)
+int glyph_width(uint32_t cp, int* after_joiner) {
+    if (cp == WIDTH_ZWJ) {
+        *after_joiner = 1;
+        return 0;
+    }
+    int width = codepoint_width(cp);
+    if (*after_joiner && width > 0) {
+        *after_joiner = 0;
+        return 0;
+    }
+    return width;
+}
+
+// Decode one code point; invalid, overlong or truncated sequences decode
+// as U+FFFD and consume one byte
+// Returns: bytes consumed (0 only when len is 0)
+size_t utf8_decode(const char* text, size_t len, uint32_t* cp) {
+    const unsigned char* s = (const unsigned char*)text;
+    if (len == 0) return 0;
+    if (s[0] < 0x80) {
+        *cp = s[0];
+        return 1;
+    }
+
+    size_t need;
+    uint32_t code, min;
+    if ((s[0] & 0xE0) == 0xC0) {
+        need = 1, code = s[0] & 0x1F, min = 0x80;
+    } else if ((s[0] & 0xF0) == 0xE0) {
+        need = 2, code = s[0] & 0x0F, min = 0x800;
+    } else if ((s[0] & 0xF8) == 0xF0) {
+        need = 3, code = s[0] & 0x07, min = 0x10000;
+    } else {
+        *cp = 0xFFFD;
+        return 1;
+    }
+    if (need >= len) {
+        *cp = 0xFFFD;
+        return 1;
+    }
+    for (size_t i = 1; i <= need; i++) {
+        if ((s[i] & 0xC0) != 0x80) {
+            *cp = 0xFFFD;
+            return 1;
+        }
+        code = (code << 6) | (s[i] & 0x3F);
+    }
+    if (code < min || code > 0x10FFFF || (code >= 0xD800 && code <= 0xDFFF)) {
+        *cp = 0xFFFD;
+        return 1;
+    }
+    *cp = code;
+    return need + 1;
+}
+
+// Encode one code point; anything outside Unicode encodes as U+FFFD
+// Returns: bytes written to out (1-4)
+size_t utf8_encode(uint32_t cp, char* out) {
+    if (cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF)) cp = 0xFFFD;
+    if (cp < 0x80) {
+        out[0] = (char)cp;
+        return 1;
+    }
+    if (cp < 0x800) {
+        out[0] = (char)(0xC0 | (cp >> 6));
+        out[1] = (char)(0x80 | (cp & 0x3F));
+        return 2;
+    }
+    if (cp < 0x10000) {
+        out[0] = (char)(0xE0 | (cp >> 12));
+        out[1] = (char)(0x80 | ((cp >> 6) & 0x3F));
+        out[2] = (char)(0x80 | (cp & 0x3F));
+        return 3;
+    }
+    out[0] = (char)(0xF0 | (cp >> 18));
+    out[1] = (char)(0x80 | ((cp >> 12) & 0x3F));
+    out[2] = (char)(0x80 | ((cp >> 6) & 0x3F));
+    out[3] = (char)(0x80 | (cp & 0x3F));
+    return 4;
+}
+
+// Eight bytes of printable ASCII (0x20-0x7E), one column each
+static int word_is_printable_ascii(uint64_t word) {
+    const uint64_t ones = 0x0101010101010101ULL;
+    const uint64_t high = 0x8080808080808080ULL;
+    if (word & high) return 0;
+    // With no high bits set, a byte below 0x20 borrows into its own high bit
+    // and so does a 0x7F byte once XORed to zero and decremented
+    uint64_t del = word ^ (0x7F * ones);
+    return ((word - 0x20 * ones) & high) == 0 && ((del - ones) & high) == 0;
+}
+
+// Display width of len bytes of UTF-8
+int display_width_n(const char* text, size_t len) {
+    const char* p = text;
+    const char* end = text + len;
+    int width = 0;
+    int after_joiner = 0;
+
+    while (p < end) {
+        while (end - p >= 8) {
+            uint64_t word;
+            memcpy(&word, p, sizeof(word));
+            if (!word_is_printable_ascii(word)) break;
+            width += 8;
+            p += 8;
+            after_joiner = 0;
+        }
+        if (p == end) break;
+
+        uint32_t cp;
+        p += utf8_decode(p, (size_t)(end - p), &cp);
+        width += glyph_width(cp, &after_joiner);
+    }
+    return width;
+}
+
+// Display width of a NUL-terminated UTF-8 string
+int get_string_display_width(const char* str) {
+    if (!str) return 0;
+    return display_width_n(str, strlen(str));
+}
+
+#ifdef WIDTH_BENCHMARK
+
+// width-bench - time display width measurement on path-like strings
+//
+// Usage: width-bench [ITERATIONS]
+// Compares the engine with a plain per-code-point loop over the same tables
+// and with the C library's wcswidth().
+
+#include <locale.h>
+#include <wchar.h>
+
+#define BENCH_STRINGS 4096
+
+static double elapsed_ns(const struct timespec* start, const struct timespec* end) {
+    return (double)(end->tv_sec - start->tv_sec) * 1e9 + (double)(end->tv_nsec - start->tv_nsec);
+}
+
+// Reference: every code point decoded and looked up, no ASCII fast path
+static int per_codepoint_width(const char* str) {
+    size_t len = strlen(str);
+    int width = 0, after_joiner = 0;
+    for (size_t i = 0; i < len; ) {
+        uint32_t cp;
+        i += utf8_decode(str + i, len - i, &cp);
+        width += glyph_width(cp, &after_joiner);
+    }
+    return width;
+}
+
+static int libc_width(const char* str) {
+    wchar_t wide[512];
+    size_t n = mbstowcs(wide, str, sizeof(wide) / sizeof(wide[0]) - 1);
+    if (n == (size_t)-1) return -1;
+    wide[n] = L'\0';
+    return wcswidth(wide, n);
+}
+
+// Path-like strings from a few directory and file name pools
+static char** make_paths(const char* const* dirs, size_t dir_count, const char* const* files, size_t file_count) {
+    char** paths = calloc(BENCH_STRINGS, sizeof(char*));
+    if (!paths) return NULL;
+    uint32_t seed = 12345;
+    for (size_t i = 0; i < BENCH_STRINGS; i++) {
+        char buffer[512];
+        size_t pos = 0;
+        seed = seed * 1103515245u + 12345u;
+        int depth = 1 + (int)((seed >> 16) % 5);
+        for (int d = 0; d < depth; d++) {
+            seed = seed * 1103515245u + 12345u;
+            pos += (size_t)snprintf(buffer + pos, sizeof(buffer) - pos, "%s/", dirs[(seed >> 16) % dir_count]);
+        }
+        seed = seed * 1103515245u + 12345u;
+        snprintf(buffer + pos, sizeof(buffer) - pos, "%s", files[(seed >> 16) % file_count]);
+        paths[i] = strdup(buffer);
+    }
+    return paths;
+}
+
+static void run_case(const char* name, char** paths, long iterations) {
+    int (*functions[])(const char*) = { get_string_display_width, per_codepoint_width, libc_width };
+    const char* labels[] = { "engine", "per code point", "libc wcswidth" };
+
+    size_t bytes = 0;
+    for (size_t i = 0; i < BENCH_STRINGS; i++) bytes += strlen(paths[i]);
+
+    printf("%s (%zu strings, %.1f bytes average)\n", name, (size_t)BENCH_STRINGS, (double)bytes / BENCH_STRINGS);
+    for (size_t f = 0; f < sizeof(functions) / sizeof(functions[0]); f++) {
+        volatile long total = 0;
+        struct timespec start, end;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (long it = 0; it < iterations; it++) {
+            for (size_t i = 0; i < BENCH_STRINGS; i++) total += functions[f](paths[i]);
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        double ns = elapsed_ns(&start, &end);
+        double count = (double)iterations * BENCH_STRINGS;
+        printf("  %-16s %8.1f ns/string %8.1f MB/s  (columns %ld)\n", labels[f], ns / count,
+               (double)bytes * (double)iterations / (ns / 1e9) / 1e6, (long)(total / iterations));
+    }
+}
+
+int main(int argc, char* argv[]) {
+    long iterations = argc > 1 ? atol(argv[1]) : 200;
+    if (iterations <= 0) iterations = 1;
+    setlocale(LC_ALL, "C.UTF-8");
+
+    static const char* const ascii_dirs[] = { "src", "include", "three-pane-tui", "inotify-watcher", "docs", "build", "lib" };
+    static const char* const ascii_files[] = { "main.c", "README.md", "inotify-daemon-lib.o", "index.json", "Makefile" };
+    static const char* const cjk_dirs[] = { "src", "文档", "プロジェクト", "데이터", "assets" };
+    static const char* const cjk_files[] = { "说明.md", "設定ファイル.json", "테스트.c", "main.c" };
+    static const char* const emoji_dirs[] = { "notes", "🚀launch", "team👩‍💻", "café" };
+    static const char* const emoji_files[] = { "todo✅.md", "🇯🇵.txt", "résumé.pdf", "plan.md" };
+
+    struct {
+        const char* name;
+        char** paths;
+    } cases[] = {
+        { "ASCII paths", make_paths(ascii_dirs, 7, ascii_files, 5) },
+        { "CJK paths", make_paths(cjk_dirs, 5, cjk_files, 4) },
+        { "Emoji and accented paths", make_paths(emoji_dirs, 4, emoji_files, 4) },
+    };
+    for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+        if (!cases[c].paths) return 1;
+        run_case(cases[c].name, cases[c].paths, iterations);
+        for (size_t i = 0; i < BENCH_STRINGS; i++) free(cases[c].paths[i]);
+        free(cases[c].paths);
+    }
+    return 0;
+}
+
+#endif // WIDTH_BENCHMARK